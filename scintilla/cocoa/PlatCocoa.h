@@ -118,6 +118,7 @@ public:
 	void SetUnicodeMode(bool unicodeMode_) override;
 	void SetDBCSMode(int codePage_) override;
 	void SetBidiR2L(bool bidiR2L_) override;
+	bool ThreadSafeMeasureWidths() override;
 }; // SurfaceImpl class
 
 } // Scintilla namespace
@@ -1256,6 +1256,11 @@ void SurfaceImpl::SetDBCSMode(int codePage_) {
 void SurfaceImpl::SetBidiR2L(bool) {
 }
 
+bool SurfaceImpl::ThreadSafeMeasureWidths() {
+	// Each surface has its own text layout and Core Text is thread safe.
+	return true;
+}
+
 Surface *Surface::Allocate(int) {
 	return new SurfaceImpl();
 }
@@ -12,6 +12,7 @@
 #include <string>
 #include <string_view>
 #include <vector>
+#include <array>
 #include <map>
 #include <algorithm>
 #include <memory>
@@ -70,11 +71,30 @@ GtkWidget *PWidget(WindowID wid) noexcept {
 
 enum encodingType { singleByte, UTF8, dbcs };
 
+// Advances of the printable ASCII characters measured by Pango.
+// When placing these characters next to each other is found to be the same as adding
+// their advances, so the font has no kerning or ligatures for them, runs of only these
+// characters can be measured without shaping.
+// Measurements depend on the resolution and font options of the Pango context so are
+// remade when these change.
+struct GlyphAdvances {
+	enum class State { unknown, simple, complex };
+	State state = State::unknown;
+	double resolution = 0.0;
+	unsigned long optionsHash = 0;
+	std::array<int, 0x80> advances {};	// In Pango units
+};
+
+constexpr bool IsPrintableASCII(unsigned char ch) noexcept {
+	return (ch >= 0x20) && (ch < 0x7F);
+}
+
 // Holds a PangoFontDescription*.
 class FontHandle {
 public:
 	PangoFontDescription *pfd;
 	int characterSet;
+	GlyphAdvances ascii;
 	FontHandle() noexcept : pfd(nullptr), characterSet(-1) {
 	}
 	FontHandle(PangoFontDescription *pfd_, int characterSet_) noexcept {
@@ -144,6 +164,7 @@ class SurfaceImpl : public Surface {
 	Converter conv;
 	int characterSet;
 	void SetConverter(int characterSet_);
+	bool SimpleASCII(FontHandle *pfh, std::string_view text);
 public:
 	SurfaceImpl() noexcept;
 	~SurfaceImpl() override;
@@ -192,6 +213,7 @@ public:
 	void SetUnicodeMode(bool unicodeMode_) override;
 	void SetDBCSMode(int codePage) override;
 	void SetBidiR2L(bool bidiR2L_) override;
+	bool ThreadSafeMeasureWidths() override;
 };
 }
 
@@ -774,9 +796,82 @@ public:
 	}
 };
 
+// Can text be measured by adding up glyph advances instead of shaping with Pango.
+// Fills the advances the first time they are needed for a font and context.
+bool SurfaceImpl::SimpleASCII(FontHandle *pfh, std::string_view text) {
+	if ((et == dbcs) || !pcontext) {
+		return false;
+	}
+	for (const char ch : text) {
+		if (!IsPrintableASCII(ch)) {
+			return false;
+		}
+	}
+	// A scaled or rotated context, as may be used for printing, is always shaped.
+	const PangoMatrix *matrix = pango_context_get_matrix(pcontext);
+	if (matrix && ((matrix->xx != 1.0) || (matrix->yy != 1.0) || (matrix->xy != 0.0) || (matrix->yx != 0.0))) {
+		return false;
+	}
+	const double resolution = pango_cairo_context_get_resolution(pcontext);
+	const cairo_font_options_t *options = pango_cairo_context_get_font_options(pcontext);
+	const unsigned long optionsHash = options ? cairo_font_options_hash(options) : 0;
+	GlyphAdvances &ascii = pfh->ascii;
+	if ((ascii.state == GlyphAdvances::State::unknown) ||
+		(ascii.resolution != resolution) || (ascii.optionsHash != optionsHash)) {
+		ascii.resolution = resolution;
+		ascii.optionsHash = optionsHash;
+		pango_layout_set_font_description(layout, pfh->pfd);
+		for (int ch = 0x20; ch < 0x7F; ch++) {
+			const char character = static_cast<char>(ch);
+			pango_layout_set_text(layout, &character, 1);
+			PangoRectangle pos;
+			pango_layout_line_get_extents(pango_layout_get_line_readonly(layout, 0), nullptr, &pos);
+			ascii.advances[ch] = pos.width;
+		}
+		// Lay out every pair of characters and check each cluster is a single character
+		// placed at the sum of the advances before it.
+		std::string pairs;
+		for (int first = 0x20; first < 0x7F; first++) {
+			for (int second = 0x20; second < 0x7F; second++) {
+				pairs.push_back(static_cast<char>(first));
+				pairs.push_back(static_cast<char>(second));
+			}
+		}
+		pango_layout_set_text(layout, pairs.c_str(), static_cast<int>(pairs.length()));
+		PangoLayoutIter *iter = pango_layout_get_iter(layout);
+		bool simple = true;
+		size_t index = 0;
+		int x = 0;
+		do {
+			PangoRectangle pos;
+			pango_layout_iter_get_cluster_extents(iter, nullptr, &pos);
+			const int advance = ascii.advances[static_cast<unsigned char>(pairs[index])];
+			if ((pango_layout_iter_get_index(iter) != static_cast<int>(index)) ||
+				(pos.x != x) || (pos.width != advance)) {
+				simple = false;
+			}
+			x += advance;
+			index++;
+		} while (simple && (index < pairs.length()) && pango_layout_iter_next_cluster(iter));
+		pango_layout_iter_free(iter);
+		ascii.state = (simple && (index == pairs.length())) ?
+			GlyphAdvances::State::simple : GlyphAdvances::State::complex;
+	}
+	return ascii.state == GlyphAdvances::State::simple;
+}
+
 void SurfaceImpl::MeasureWidths(Font &font_, std::string_view text, XYPOSITION *positions) {
 	if (font_.GetID()) {
 		if (PFont(font_)->pfd) {
+			if (SimpleASCII(PFont(font_), text)) {
+				const std::array<int, 0x80> &advances = PFont(font_)->ascii.advances;
+				int x = 0;
+				for (size_t i = 0; i < text.length(); i++) {
+					x += advances[static_cast<unsigned char>(text[i])];
+					positions[i] = floatFromPangoUnits(x);
+				}
+				return;
+			}
 			pango_layout_set_font_description(layout, PFont(font_)->pfd);
 			if (et == UTF8) {
 				// Simple and direct as UTF-8 is native Pango encoding
@@ -883,6 +978,14 @@ void SurfaceImpl::MeasureWidths(Font &font_, std::string_view text, XYPOSITION *
 XYPOSITION SurfaceImpl::WidthText(Font &font_, std::string_view text) {
 	if (font_.GetID()) {
 		if (PFont(font_)->pfd) {
+			if (SimpleASCII(PFont(font_), text)) {
+				const std::array<int, 0x80> &advances = PFont(font_)->ascii.advances;
+				int x = 0;
+				for (const char ch : text) {
+					x += advances[static_cast<unsigned char>(ch)];
+				}
+				return floatFromPangoUnits(x);
+			}
 			std::string utfForm;
 			pango_layout_set_font_description(layout, PFont(font_)->pfd);
 			PangoRectangle pos;
@@ -972,6 +1075,11 @@ void SurfaceImpl::SetDBCSMode(int codePage) {
 void SurfaceImpl::SetBidiR2L(bool) {
 }
 
+bool SurfaceImpl::ThreadSafeMeasureWidths() {
+	// Pango font maps and shapers are shared between contexts and are not locked.
+	return false;
+}
+
 Surface *Surface::Allocate(int) {
 	return new SurfaceImpl();
 }
@@ -1099,6 +1099,17 @@ void ScintillaGTK::NotifyParent(SCNotification scn) {
 		      GetCtrlID(), &scn);
 }
 
+void ScintillaGTK::NotifyModified(Document *document, DocModification mh, void *userData) {
+	// Update the accessible before SCN_MODIFIED is sent, whatever the modification event mask
+	if (accessible && (mh.modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT))) {
+		ScintillaGTKAccessible *sciAccessible = ScintillaGTKAccessible::FromAccessible(accessible);
+		if (sciAccessible) {
+			sciAccessible->TextModified(mh.position, mh.linesAdded);
+		}
+	}
+	Editor::NotifyModified(document, mh, userData);
+}
+
 void ScintillaGTK::NotifyKey(int key, int modifiers) {
 	SCNotification scn = {};
 	scn.nmhdr.code = SCN_KEY;
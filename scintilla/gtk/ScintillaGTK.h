@@ -118,6 +118,7 @@ private:
 	void NotifyChange() override;
 	void NotifyFocus(bool focus) override;
 	void NotifyParent(SCNotification scn) override;
+	void NotifyModified(Document *document, DocModification mh, void *userData) override;
 	void NotifyKey(int key, int modifiers);
 	void NotifyURIDropped(const char *list);
 	const char *CharacterSetID() const;
@@ -828,6 +828,8 @@ void ScintillaGTKAccessible::UpdateCursor() {
 }
 
 void ScintillaGTKAccessible::ChangeDocument(Document *oldDoc, Document *newDoc) {
+	characterCache.Clear();
+
 	if (!Enabled()) {
 		return;
 	}
@@ -868,12 +870,19 @@ void ScintillaGTKAccessible::NotifyReadOnly() {
 
 void ScintillaGTKAccessible::SetAccessibility(bool enabled) {
 	// Called by ScintillaGTK when application has enabled or disabled accessibility
+	characterCache.Clear();
 	if (enabled)
 		sci->pdoc->AllocateLineCharacterIndex(SC_LINECHARACTERINDEX_UTF32);
 	else
 		sci->pdoc->ReleaseLineCharacterIndex(SC_LINECHARACTERINDEX_UTF32);
 }
 
+void ScintillaGTKAccessible::TextModified(Sci::Position position, Sci::Line linesAdded) {
+	// Called by ScintillaGTK for every insertion and deletion, even when disabled as
+	// accessibility may be enabled later, and before SCN_MODIFIED which may be masked
+	characterCache.Modified(sci->pdoc->SciLineFromPosition(position), linesAdded);
+}
+
 void ScintillaGTKAccessible::Notify(GtkWidget *, gint, SCNotification *nt) {
 	if (!Enabled())
 		return;
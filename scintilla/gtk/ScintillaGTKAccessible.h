@@ -31,30 +31,24 @@ private:
 		} catch (...) {}
 	}
 
+	LineCharacterCache characterCache;
+
 	Sci::Position ByteOffsetFromCharacterOffset(Sci::Position startByte, int characterOffset) {
 		if (!(sci->pdoc->LineCharacterIndex() & SC_LINECHARACTERINDEX_UTF32)) {
 			return startByte + characterOffset;
 		}
-		if (characterOffset > 0) {
-			// Try and reduce the range by reverse-looking into the character offset cache
-			Sci::Line lineStart = sci->pdoc->LineFromPosition(startByte);
-			Sci::Position posStart = sci->pdoc->IndexLineStart(lineStart, SC_LINECHARACTERINDEX_UTF32);
-			Sci::Line line = sci->pdoc->LineFromPositionIndex(posStart + characterOffset, SC_LINECHARACTERINDEX_UTF32);
-			if (line != lineStart) {
-				startByte += sci->pdoc->LineStart(line) - sci->pdoc->LineStart(lineStart);
-				characterOffset -= sci->pdoc->IndexLineStart(line, SC_LINECHARACTERINDEX_UTF32) - posStart;
-			}
+		const Sci::Position character = CharacterOffsetFromByteOffset(startByte) + characterOffset;
+		// clamp invalid positions inside the document
+		if (character <= 0) {
+			return 0;
 		}
-		Sci::Position pos = sci->pdoc->GetRelativePosition(startByte, characterOffset);
-		if (pos == INVALID_POSITION) {
-			// clamp invalid positions inside the document
-			if (characterOffset > 0) {
-				return sci->pdoc->Length();
-			} else {
-				return 0;
-			}
+		const Sci::Line lines = sci->pdoc->LinesTotal();
+		if (character >= sci->pdoc->IndexLineStart(lines, SC_LINECHARACTERINDEX_UTF32)) {
+			return sci->pdoc->Length();
 		}
-		return pos;
+		const Sci::Line line = sci->pdoc->LineFromPositionIndex(character, SC_LINECHARACTERINDEX_UTF32);
+		const Sci::Position characterInLine = character - sci->pdoc->IndexLineStart(line, SC_LINECHARACTERINDEX_UTF32);
+		return characterCache.PositionOfCharacter(sci->pdoc, line, characterInLine);
 	}
 
 	Sci::Position ByteOffsetFromCharacterOffset(Sci::Position characterOffset) {
@@ -66,8 +60,8 @@ private:
 			return byteOffset;
 		}
 		const Sci::Line line = sci->pdoc->LineFromPosition(byteOffset);
-		const Sci::Position lineStart = sci->pdoc->LineStart(line);
-		return sci->pdoc->IndexLineStart(line, SC_LINECHARACTERINDEX_UTF32) + sci->pdoc->CountCharacters(lineStart, byteOffset);
+		return sci->pdoc->IndexLineStart(line, SC_LINECHARACTERINDEX_UTF32) +
+			characterCache.CharactersBefore(sci->pdoc, line, byteOffset);
 	}
 
 	void CharacterRangeFromByteRange(Sci::Position startByte, Sci::Position endByte, int *startChar, int *endChar) {
@@ -138,6 +132,7 @@ public:
 	void ChangeDocument(Document *oldDoc, Document *newDoc);
 	void NotifyReadOnly();
 	void SetAccessibility(bool enabled);
+	void TextModified(Sci::Position position, Sci::Line linesAdded);
 
 	// Helper GtkWidget methods
 	static AtkObject *WidgetGetAccessibleImpl(GtkWidget *widget, AtkObject **cache, gpointer widget_parent_class);
@@ -12,7 +12,7 @@
 
 namespace Scintilla {
 
-enum { dvRelease4=2 };
+enum { dvRelease4=2, dvRangePointer=3 };
 
 class IDocument {
 public:
@@ -42,7 +42,15 @@ public:
 	virtual int SCI_METHOD GetCharacterAndWidth(Sci_Position position, Sci_Position *pWidth) const = 0;
 };
 
-enum { lvRelease4=2 };
+// Documents with a Version of dvRangePointer or later can lend a pointer to a range of their text
+// instead of copying it. The pointer is valid until the text is modified or RangePointer is called again.
+// Returns NULL if the range is not available.
+class IDocumentRangePointer : public IDocument {
+public:
+	virtual const char * SCI_METHOD RangePointer(Sci_Position position, Sci_Position rangeLength) = 0;
+};
+
+enum { lvRelease4=2, lvCheckpoints=3 };
 
 class ILexer4 {
 public:
@@ -73,6 +81,20 @@ public:
 	virtual const char * SCI_METHOD DescriptionOfStyle(int style) = 0;
 };
 
+// Lexers with a Version of lvCheckpoints or later can lex separate ranges of a document at once.
+// Lexing from the start of a line must depend only on the style before the line, the line state of the
+// previous line and the lexer's private checkpoint for the line, such as preprocessor state.
+// Folding is not split as fold levels accumulate from the start of the document.
+// Fork returns a copy of the lexer that can run on another thread or NULL if the lexer can not be copied.
+// SameCheckpoint compares the checkpoints of two lexers at the start of line.
+// Join takes over the checkpoints that fork produced by lexing from lineStart up to lineEnd.
+class ILexerCheckpoints : public ILexer4 {
+public:
+	virtual ILexerCheckpoints * SCI_METHOD Fork() = 0;
+	virtual bool SCI_METHOD SameCheckpoint(ILexerCheckpoints *other, Sci_Position line) = 0;
+	virtual void SCI_METHOD Join(ILexerCheckpoints *fork, Sci_Position lineStart, Sci_Position lineEnd) = 0;
+};
+
 }
 
 #endif
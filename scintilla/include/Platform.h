@@ -417,6 +417,8 @@ public:
 	virtual void SetUnicodeMode(bool unicodeMode_)=0;
 	virtual void SetDBCSMode(int codePage)=0;
 	virtual void SetBidiR2L(bool bidiR2L_)=0;
+	// Can MeasureWidths be called on different surfaces from multiple threads at once.
+	virtual bool ThreadSafeMeasureWidths()=0;
 };
 
 /**
@@ -64,6 +64,8 @@ typedef sptr_t (*SciFnDirect)(sptr_t ptr, unsigned int iMessage, uptr_t wParam,
 #define SCI_MARKERLINEFROMHANDLE 2017
 #define SCI_MARKERDELETEHANDLE 2018
 #define SCI_GETUNDOCOLLECTION 2019
+#define SCI_SETUNDOMEMORYLIMIT 2729
+#define SCI_GETUNDOMEMORYLIMIT 2730
 #define SCWS_INVISIBLE 0
 #define SCWS_VISIBLEALWAYS 1
 #define SCWS_VISIBLEAFTERINDENT 2
@@ -457,6 +459,7 @@ typedef sptr_t (*SciFnDirect)(sptr_t ptr, unsigned int iMessage, uptr_t wParam,
 #define SCI_REPLACETARGET 2194
 #define SCI_REPLACETARGETRE 2195
 #define SCI_SEARCHINTARGET 2197
+#define SCI_REPLACEALLINTARGET 2731
 #define SCI_SETSEARCHFLAGS 2198
 #define SCI_GETSEARCHFLAGS 2199
 #define SCI_CALLTIPSHOW 2200
@@ -533,6 +536,10 @@ typedef sptr_t (*SciFnDirect)(sptr_t ptr, unsigned int iMessage, uptr_t wParam,
 #define SC_IDLESTYLING_ALL 3
 #define SCI_SETIDLESTYLING 2692
 #define SCI_GETIDLESTYLING 2693
+#define SCI_SETIDLESTYLINGTHREADED 2724
+#define SCI_GETIDLESTYLINGTHREADED 2725
+#define SCI_SETSTYLINGTHREADS 2737
+#define SCI_GETSTYLINGTHREADS 2738
 #define SC_WRAP_NONE 0
 #define SC_WRAP_WORD 1
 #define SC_WRAP_CHAR 2
@@ -564,6 +571,8 @@ typedef sptr_t (*SciFnDirect)(sptr_t ptr, unsigned int iMessage, uptr_t wParam,
 #define SC_CACHE_DOCUMENT 3
 #define SCI_SETLAYOUTCACHE 2272
 #define SCI_GETLAYOUTCACHE 2273
+#define SCI_SETLAYOUTTHREADS 2726
+#define SCI_GETLAYOUTTHREADS 2727
 #define SCI_SETSCROLLWIDTH 2274
 #define SCI_GETSCROLLWIDTH 2275
 #define SCI_SETSCROLLWIDTHTRACKING 2516
@@ -698,6 +707,7 @@ typedef sptr_t (*SciFnDirect)(sptr_t ptr, unsigned int iMessage, uptr_t wParam,
 #define SC_DOCUMENTOPTION_DEFAULT 0
 #define SC_DOCUMENTOPTION_STYLES_NONE 0x1
 #define SC_DOCUMENTOPTION_TEXT_LARGE 0x100
+#define SC_DOCUMENTOPTION_TEXT_CHUNKED 0x200
 #define SCI_CREATEDOCUMENT 2375
 #define SCI_ADDREFDOCUMENT 2376
 #define SCI_RELEASEDOCUMENT 2377
@@ -811,6 +821,10 @@ typedef sptr_t (*SciFnDirect)(sptr_t ptr, unsigned int iMessage, uptr_t wParam,
 #define SC_ORDER_CUSTOM 2
 #define SCI_AUTOCSETORDER 2660
 #define SCI_AUTOCGETORDER 2661
+#define SC_AUTOCMATCH_PREFIX 0
+#define SC_AUTOCMATCH_SUBSEQUENCE 1
+#define SCI_AUTOCSETMATCH 2739
+#define SCI_AUTOCGETMATCH 2740
 #define SCI_ALLOCATE 2446
 #define SCI_TARGETASUTF8 2447
 #define SCI_SETLENGTHFORENCODE 2448
@@ -848,8 +862,17 @@ typedef sptr_t (*SciFnDirect)(sptr_t ptr, unsigned int iMessage, uptr_t wParam,
 #define SCI_INDICATORVALUEAT 2507
 #define SCI_INDICATORSTART 2508
 #define SCI_INDICATOREND 2509
+#define SCI_HIGHLIGHTMATCHES 2732
+#define SCI_HIGHLIGHTMATCHESCLEAR 2733
+#define SCI_SETHIGHLIGHTMATCHESSTYLE 2734
+#define SCI_GETHIGHLIGHTMATCHESSTYLE 2735
+#define SCI_GETHIGHLIGHTMATCHESCOMPLETE 2736
 #define SCI_SETPOSITIONCACHE 2514
 #define SCI_GETPOSITIONCACHE 2515
+#define SC_POSITIONCACHE_HITS 0
+#define SC_POSITIONCACHE_MISSES 1
+#define SC_POSITIONCACHE_EVICTIONS 2
+#define SCI_GETPOSITIONCACHESTATISTIC 2728
 #define SCI_COPYALLOWLINE 2519
 #define SCI_GETCHARACTERPOINTER 2520
 #define SCI_GETRANGEPOINTER 2643
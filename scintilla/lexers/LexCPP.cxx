@@ -17,6 +17,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <algorithm>
 #include <iterator>
 
@@ -274,6 +275,9 @@ class LinePPState {
 public:
 	LinePPState() noexcept {
 	}
+	bool operator==(const LinePPState &other) const noexcept {
+		return (state == other.state) && (ifTaken == other.ifTaken) && (level == other.level);
+	}
 	bool IsActive() const noexcept {
 		return state == 0;
 	}
@@ -501,7 +505,7 @@ const int sizeLexicalClasses = static_cast<int>(std::size(lexicalClasses));
 
 }
 
-class LexerCPP : public ILexer4 {
+class LexerCPP : public ILexerCheckpoints {
 	bool caseSensitive;
 	CharacterSet setWord;
 	CharacterSet setNegationOp;
@@ -532,9 +536,14 @@ class LexerCPP : public ILexer4 {
 		bool IsMacro() const noexcept {
 			return !arguments.empty();
 		}
+		bool operator==(const SymbolValue &other) const noexcept {
+			return value == other.value && arguments == other.arguments;
+		}
 	};
 	typedef std::map<std::string, SymbolValue> SymbolTable;
 	SymbolTable preprocessorDefinitionsStart;
+	// Names looked up in the definitions by the last Lex so a fork can be checked against them
+	std::set<std::string> symbolsQueried;
 	OptionsCPP options;
 	OptionSetCPP osCPP;
 	EscapeSequence escapeSeq;
@@ -564,7 +573,7 @@ public:
 		delete this;
 	}
 	int SCI_METHOD Version() const noexcept override {
-		return lvRelease4;
+		return lvCheckpoints;
 	}
 	const char * SCI_METHOD PropertyNames() override {
 		return osCPP.PropertyNames();
@@ -674,6 +683,10 @@ public:
 		return "";
 	}
 
+	ILexerCheckpoints * SCI_METHOD Fork() override;
+	bool SCI_METHOD SameCheckpoint(ILexerCheckpoints *other, Sci_Position line) override;
+	void SCI_METHOD Join(ILexerCheckpoints *fork, Sci_Position lineStart, Sci_Position lineEnd) override;
+
 	static ILexer4 *LexerFactoryCPP() {
 		return new LexerCPP(true);
 	}
@@ -686,6 +699,8 @@ public:
 	void EvaluateTokens(std::vector<std::string> &tokens, const SymbolTable &preprocessorDefinitions);
 	std::vector<std::string> Tokenize(const std::string &expr) const;
 	bool EvaluateExpression(const std::string &expr, const SymbolTable &preprocessorDefinitions);
+	SymbolTable DefinitionsBefore(Sci_Position line) const;
+	SymbolTable::const_iterator FindSymbol(const SymbolTable &preprocessorDefinitions, const std::string &name);
 };
 
 Sci_Position SCI_METHOD LexerCPP::PropertySet(const char *key, const char *val) {
@@ -761,6 +776,63 @@ Sci_Position SCI_METHOD LexerCPP::WordListSet(int n, const char *wl) {
 	return firstModification;
 }
 
+ILexerCheckpoints * SCI_METHOD LexerCPP::Fork() {
+	LexerCPP *fork = new LexerCPP(caseSensitive);
+	fork->setWord = CharacterSet(setWord);
+	fork->vlls = vlls;
+	fork->ppDefineHistory = ppDefineHistory;
+	fork->keywords = keywords;
+	fork->keywords2 = keywords2;
+	fork->keywords3 = keywords3;
+	fork->keywords4 = keywords4;
+	fork->ppDefinitions = ppDefinitions;
+	fork->markerList = markerList;
+	fork->preprocessorDefinitionsStart = preprocessorDefinitionsStart;
+	fork->options = options;
+	fork->rawStringTerminators = rawStringTerminators;
+	fork->subStyles = subStyles;
+	return fork;
+}
+
+// The checkpoint for a line is the preprocessor state, the raw string terminator
+// and the definitions made before the line of the symbols that the other lexer looked up.
+// Definitions that were never looked up can not have changed the other lexer's styling.
+bool SCI_METHOD LexerCPP::SameCheckpoint(ILexerCheckpoints *other, Sci_Position line) {
+	LexerCPP *otherCPP = static_cast<LexerCPP *>(other);
+	if (!(vlls.ForLine(line) == otherCPP->vlls.ForLine(line)))
+		return false;
+	if (rawStringTerminators.ValueAt(line - 1) != otherCPP->rawStringTerminators.ValueAt(line - 1))
+		return false;
+	if (otherCPP->symbolsQueried.empty())
+		return true;
+	const SymbolTable definitions = DefinitionsBefore(line);
+	const SymbolTable definitionsOther = otherCPP->DefinitionsBefore(line);
+	for (const std::string &name : otherCPP->symbolsQueried) {
+		const SymbolTable::const_iterator it = definitions.find(name);
+		const SymbolTable::const_iterator itOther = definitionsOther.find(name);
+		if ((it == definitions.end()) != (itOther == definitionsOther.end()))
+			return false;
+		if ((it != definitions.end()) && !(it->second == itOther->second))
+			return false;
+	}
+	return true;
+}
+
+void SCI_METHOD LexerCPP::Join(ILexerCheckpoints *fork, Sci_Position lineStart, Sci_Position lineEnd) {
+	LexerCPP *forkCPP = static_cast<LexerCPP *>(fork);
+	for (Sci_Position line = lineStart + 1; line <= lineEnd; line++) {
+		vlls.Add(line, forkCPP->vlls.ForLine(line));
+	}
+	rawStringTerminators.Delete(lineStart);
+	for (Sci_Position line = lineStart; line < lineEnd; line++) {
+		rawStringTerminators.Set(line, forkCPP->rawStringTerminators.ValueAt(line));
+	}
+	ppDefineHistory.erase(std::find_if(ppDefineHistory.begin(), ppDefineHistory.end(),
+		[lineStart](const PPDefinition &p) { return p.line >= lineStart; }), ppDefineHistory.end());
+	std::copy_if(forkCPP->ppDefineHistory.begin(), forkCPP->ppDefineHistory.end(), std::back_inserter(ppDefineHistory),
+		[lineStart, lineEnd](const PPDefinition &p) { return (p.line >= lineStart) && (p.line < lineEnd); });
+}
+
 void SCI_METHOD LexerCPP::Lex(Sci_PositionU startPos, Sci_Position length, int initStyle, IDocument *pAccess) {
 	LexAccessor styler(pAccess);
 
@@ -828,13 +900,8 @@ void SCI_METHOD LexerCPP::Lex(Sci_PositionU startPos, Sci_Position length, int i
 		definitionsChanged = true;
 	}
 
-	SymbolTable preprocessorDefinitions = preprocessorDefinitionsStart;
-	for (const PPDefinition &ppDef : ppDefineHistory) {
-		if (ppDef.isUndef)
-			preprocessorDefinitions.erase(ppDef.key);
-		else
-			preprocessorDefinitions[ppDef.key] = SymbolValue(ppDef.value, ppDef.arguments);
-	}
+	SymbolTable preprocessorDefinitions = DefinitionsBefore(lineCurrent);
+	symbolsQueried.clear();
 
 	std::string rawStringTerminator = rawStringTerminators.ValueAt(lineCurrent-1);
 	SparseState<std::string> rawSTNew(lineCurrent);
@@ -1297,7 +1364,7 @@ void SCI_METHOD LexerCPP::Lex(Sci_PositionU startPos, Sci_Position length, int i
 							const bool isIfDef = sc.Match("ifdef");
 							const int startRest = isIfDef ? 5 : 6;
 							std::string restOfLine = GetRestOfLine(styler, sc.currentPos + startRest + 1, false);
-							bool foundDef = preprocessorDefinitions.find(restOfLine) != preprocessorDefinitions.end();
+							bool foundDef = FindSymbol(preprocessorDefinitions, restOfLine) != preprocessorDefinitions.end();
 							preproc.StartSection(isIfDef == foundDef);
 						} else if (sc.Match("if")) {
 							std::string restOfLine = GetRestOfLine(styler, sc.currentPos + 2, true);
@@ -1538,6 +1605,24 @@ void SCI_METHOD LexerCPP::Fold(Sci_PositionU startPos, Sci_Position length, int
 	}
 }
 
+LexerCPP::SymbolTable LexerCPP::DefinitionsBefore(Sci_Position line) const {
+	SymbolTable preprocessorDefinitions = preprocessorDefinitionsStart;
+	for (const PPDefinition &ppDef : ppDefineHistory) {
+		if (ppDef.line >= line)
+			break;
+		if (ppDef.isUndef)
+			preprocessorDefinitions.erase(ppDef.key);
+		else
+			preprocessorDefinitions[ppDef.key] = SymbolValue(ppDef.value, ppDef.arguments);
+	}
+	return preprocessorDefinitions;
+}
+
+LexerCPP::SymbolTable::const_iterator LexerCPP::FindSymbol(const SymbolTable &preprocessorDefinitions, const std::string &name) {
+	symbolsQueried.insert(name);
+	return preprocessorDefinitions.find(name);
+}
+
 void LexerCPP::EvaluateTokens(std::vector<std::string> &tokens, const SymbolTable &preprocessorDefinitions) {
 
 	// Remove whitespace tokens
@@ -1553,7 +1638,7 @@ void LexerCPP::EvaluateTokens(std::vector<std::string> &tokens, const SymbolTabl
 					tokens.erase(tokens.begin() + i + 1, tokens.begin() + i + 3);
 				} else if (((i+3)<tokens.size()) && (tokens[i+3] == ")")) {
 					// defined(<identifier>)
-					SymbolTable::const_iterator it = preprocessorDefinitions.find(tokens[i+2]);
+					SymbolTable::const_iterator it = FindSymbol(preprocessorDefinitions, tokens[i+2]);
 					if (it != preprocessorDefinitions.end()) {
 						val = "1";
 					}
@@ -1564,7 +1649,7 @@ void LexerCPP::EvaluateTokens(std::vector<std::string> &tokens, const SymbolTabl
 				}
 			} else {
 				// defined <identifier>
-				SymbolTable::const_iterator it = preprocessorDefinitions.find(tokens[i+1]);
+				SymbolTable::const_iterator it = FindSymbol(preprocessorDefinitions, tokens[i+1]);
 				if (it != preprocessorDefinitions.end()) {
 					val = "1";
 				}
@@ -1582,7 +1667,7 @@ void LexerCPP::EvaluateTokens(std::vector<std::string> &tokens, const SymbolTabl
 	for (size_t i = 0; (i<tokens.size()) && (iterations < maxIterations);) {
 		iterations++;
 		if (setWordStart.Contains(tokens[i][0])) {
-			SymbolTable::const_iterator it = preprocessorDefinitions.find(tokens[i]);
+			SymbolTable::const_iterator it = FindSymbol(preprocessorDefinitions, tokens[i]);
 			if (it != preprocessorDefinitions.end()) {
 				// Tokenize value
 				std::vector<std::string> macroTokens = Tokenize(it->second.value);
@@ -353,7 +353,7 @@ public:
 		delete this;
 	}
 	int SCI_METHOD Version() const override {
-		return lvRelease4;
+		return lvCheckpoints;
 	}
 	const char *SCI_METHOD PropertyNames() override {
 		return osPython.PropertyNames();
@@ -409,6 +409,10 @@ public:
 		return styleSubable;
 	}
 
+	ILexerCheckpoints *SCI_METHOD Fork() override;
+	bool SCI_METHOD SameCheckpoint(ILexerCheckpoints *other, Sci_Position line) override;
+	void SCI_METHOD Join(ILexerCheckpoints *fork, Sci_Position lineStart, Sci_Position lineEnd) override;
+
 	static ILexer4 *LexerFactoryPython() {
 		return new LexerPython();
 	}
@@ -446,6 +450,39 @@ Sci_Position SCI_METHOD LexerPython::WordListSet(int n, const char *wl) {
 	return firstModification;
 }
 
+ILexerCheckpoints *SCI_METHOD LexerPython::Fork() {
+	LexerPython *fork = new LexerPython();
+	fork->keywords = keywords;
+	fork->keywords2 = keywords2;
+	fork->options = options;
+	fork->subStyles = subStyles;
+	fork->ftripleStateAtEol = ftripleStateAtEol;
+	return fork;
+}
+
+// The checkpoint for a line is the stack of f-string states at the end of the previous line.
+bool SCI_METHOD LexerPython::SameCheckpoint(ILexerCheckpoints *other, Sci_Position line) {
+	const std::map<Sci_Position, std::vector<SingleFStringExpState> > &otherStates =
+		static_cast<LexerPython *>(other)->ftripleStateAtEol;
+	const std::map<Sci_Position, std::vector<SingleFStringExpState> >::const_iterator it = ftripleStateAtEol.find(line - 1);
+	const std::map<Sci_Position, std::vector<SingleFStringExpState> >::const_iterator itOther = otherStates.find(line - 1);
+	const bool empty = (it == ftripleStateAtEol.end()) || it->second.empty();
+	const bool emptyOther = (itOther == otherStates.end()) || itOther->second.empty();
+	if (empty || emptyOther)
+		return empty == emptyOther;
+	return std::equal(it->second.begin(), it->second.end(), itOther->second.begin(), itOther->second.end(),
+		[](const SingleFStringExpState &a, const SingleFStringExpState &b) {
+			return (a.state == b.state) && (a.nestingCount == b.nestingCount);
+		});
+}
+
+void SCI_METHOD LexerPython::Join(ILexerCheckpoints *fork, Sci_Position lineStart, Sci_Position lineEnd) {
+	const std::map<Sci_Position, std::vector<SingleFStringExpState> > &forkStates =
+		static_cast<LexerPython *>(fork)->ftripleStateAtEol;
+	ftripleStateAtEol.erase(ftripleStateAtEol.lower_bound(lineStart), ftripleStateAtEol.lower_bound(lineEnd));
+	ftripleStateAtEol.insert(forkStates.lower_bound(lineStart), forkStates.lower_bound(lineEnd));
+}
+
 void LexerPython::ProcessLineEnd(StyleContext &sc, std::vector<SingleFStringExpState> &fstringStateStack, SingleFStringExpState *&currentFStringExp, bool &inContinuedString) {
 	long deepestSingleStateIndex = -1;
 	unsigned long i;
@@ -123,3 +123,14 @@ const char * SCI_METHOD DefaultLexer::TagsOfStyle(int style) {
 const char * SCI_METHOD DefaultLexer::DescriptionOfStyle(int style) {
 	return (style < NamedStyles()) ? lexClasses[style].description : "";
 }
+
+ILexerCheckpoints * SCI_METHOD DefaultLexer::Fork() {
+	return nullptr;
+}
+
+bool SCI_METHOD DefaultLexer::SameCheckpoint(ILexerCheckpoints *, Sci_Position) {
+	return false;
+}
+
+void SCI_METHOD DefaultLexer::Join(ILexerCheckpoints *, Sci_Position, Sci_Position) {
+}
@@ -13,7 +13,7 @@
 namespace Scintilla {
 
 // A simple lexer with no state
-class DefaultLexer : public ILexer4 {
+class DefaultLexer : public ILexerCheckpoints {
 	const LexicalClass *lexClasses;
 	size_t nClasses;
 public:
@@ -44,6 +44,9 @@ public:
 	const char * SCI_METHOD NameOfStyle(int style) override;
 	const char * SCI_METHOD TagsOfStyle(int style) override;
 	const char * SCI_METHOD DescriptionOfStyle(int style) override;
+	ILexerCheckpoints * SCI_METHOD Fork() override;
+	bool SCI_METHOD SameCheckpoint(ILexerCheckpoints *other, Sci_Position line) override;
+	void SCI_METHOD Join(ILexerCheckpoints *fork, Sci_Position lineStart, Sci_Position lineEnd) override;
 };
 
 }
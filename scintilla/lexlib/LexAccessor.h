@@ -15,13 +15,19 @@ enum EncodingType { enc8bit, encUnicode, encDBCS };
 class LexAccessor {
 private:
 	IDocument *pAccess;
+	IDocumentRangePointer *pRangeAccess;
 	enum {extremePosition=0x7FFFFFFF};
 	/** @a bufferSize is a trade off between time taken to copy the characters
 	 * and retrieval overhead.
 	 * @a slopSize positions the buffer before the desired position
 	 * in case there is some backtracking. */
 	enum {bufferSize=4000, slopSize=bufferSize/8};
+	/** Text borrowed from the document is not copied so a larger window
+	 * reduces the number of fills for lexers that look far back or ahead. */
+	enum {borrowSize=0x10000, borrowSlopSize=borrowSize/8};
 	char buf[bufferSize+1];
+	/// Characters from startPos to endPos: either buf or borrowed from the document
+	const char *text;
 	Sci_Position startPos;
 	Sci_Position endPos;
 	int codePage;
@@ -33,23 +39,43 @@ private:
 	Sci_Position startPosStyling;
 	int documentVersion;
 
-	void Fill(Sci_Position position) {
-		startPos = position - slopSize;
-		if (startPos + bufferSize > lenDoc)
-			startPos = lenDoc - bufferSize;
+	void Window(Sci_Position position, Sci_Position size, Sci_Position slop) {
+		startPos = position - slop;
+		if (startPos + size > lenDoc)
+			startPos = lenDoc - size;
 		if (startPos < 0)
 			startPos = 0;
-		endPos = startPos + bufferSize;
+		endPos = startPos + size;
 		if (endPos > lenDoc)
 			endPos = lenDoc;
+	}
 
+	void Fill(Sci_Position position) {
+		if (pRangeAccess) {
+			Window(position, borrowSize, borrowSlopSize);
+			text = pRangeAccess->RangePointer(startPos, endPos-startPos);
+			if (text)
+				return;
+		}
+		Window(position, bufferSize, slopSize);
 		pAccess->GetCharRange(buf, startPos, endPos-startPos);
 		buf[endPos-startPos] = '\0';
+		text = buf;
+	}
+
+	// Changing the document notifies the application which may then move the text, such as
+	// by asking for a pointer to it, so text borrowed from the document must be fetched again.
+	void ReleaseBorrowed() noexcept {
+		if (text != buf) {
+			text = buf;
+			startPos = extremePosition;
+			endPos = 0;
+		}
 	}
 
 public:
 	explicit LexAccessor(IDocument *pAccess_) :
-		pAccess(pAccess_), startPos(extremePosition), endPos(0),
+		pAccess(pAccess_), pRangeAccess(nullptr), text(buf), startPos(extremePosition), endPos(0),
 		codePage(pAccess->CodePage()),
 		encodingType(enc8bit),
 		lenDoc(pAccess->Length()),
@@ -59,6 +85,9 @@ public:
 		// Prevent warnings by static analyzers about uninitialized buf and styleBuf.
 		buf[0] = 0;
 		styleBuf[0] = 0;
+		if (documentVersion >= dvRangePointer) {
+			pRangeAccess = static_cast<IDocumentRangePointer *>(pAccess);
+		}
 		switch (codePage) {
 		case 65001:
 			encodingType = encUnicode;
@@ -75,7 +104,7 @@ public:
 		if (position < startPos || position >= endPos) {
 			Fill(position);
 		}
-		return buf[position - startPos];
+		return text[position - startPos];
 	}
 	IDocument *MultiByteAccess() const {
 		return pAccess;
@@ -89,7 +118,7 @@ public:
 				return chDefault;
 			}
 		}
-		return buf[position - startPos];
+		return text[position - startPos];
 	}
 	bool IsLeadByte(char ch) const {
 		return pAccess->IsDBCSLeadByte(ch);
@@ -126,6 +155,7 @@ public:
 	void Flush() {
 		if (validLen > 0) {
 			pAccess->SetStyles(validLen, styleBuf);
+			ReleaseBorrowed();
 			startPosStyling += validLen;
 			validLen = 0;
 		}
@@ -134,7 +164,9 @@ public:
 		return pAccess->GetLineState(line);
 	}
 	int SetLineState(Sci_Position line, int state) {
-		return pAccess->SetLineState(line, state);
+		const int statePrevious = pAccess->SetLineState(line, state);
+		ReleaseBorrowed();
+		return statePrevious;
 	}
 	// Style setting
 	void StartAt(Sci_PositionU start) {
@@ -161,25 +193,33 @@ public:
 			if (validLen + (pos - startSeg + 1) >= bufferSize) {
 				// Too big for buffer so send directly
 				pAccess->SetStyleFor(pos - startSeg + 1, attr);
+				ReleaseBorrowed();
 			} else {
-				for (Sci_PositionU i = startSeg; i <= pos; i++) {
-					assert((startPosStyling + validLen) < Length());
-					styleBuf[validLen++] = attr;
+				const Sci_Position lengthRun = pos - startSeg + 1;
+				assert((startPosStyling + validLen + lengthRun) <= Length());
+				// Simple loop without checks so compilers can turn it into a fill
+				char *styleRun = styleBuf + validLen;
+				for (Sci_Position i = 0; i < lengthRun; i++) {
+					styleRun[i] = attr;
 				}
+				validLen += lengthRun;
 			}
 		}
 		startSeg = pos+1;
 	}
 	void SetLevel(Sci_Position line, int level) {
 		pAccess->SetLevel(line, level);
+		ReleaseBorrowed();
 	}
 	void IndicatorFill(Sci_Position start, Sci_Position end, int indicator, int value) {
 		pAccess->DecorationSetCurrentIndicator(indicator);
 		pAccess->DecorationFillRange(start, value, end - start);
+		ReleaseBorrowed();
 	}
 
 	void ChangeLexerState(Sci_Position start, Sci_Position end) {
 		pAccess->ChangeLexerState(start, end);
+		ReleaseBorrowed();
 	}
 };
 
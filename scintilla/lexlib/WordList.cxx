@@ -6,6 +6,7 @@
 // The License.txt file describes the conditions under which this software may be distributed.
 
 #include <cstdlib>
+#include <cstdint>
 #include <cassert>
 #include <cstring>
 
@@ -61,16 +62,77 @@ static char **ArrayFromWordList(char *wordlist, int *len, bool onlyLineEnds = fa
 	return keywords;
 }
 
+/**
+ * Hash a NUL terminated word from its length and its first and last 8 bytes so
+ * the cost hardly depends on the length. Words that only differ in their middle
+ * share a hash and are separated by comparing them.
+ * Also returns the length so it can be compared before the characters.
+ */
+static unsigned int HashWord(const char *s, int *length) noexcept {
+	std::uint64_t head = 0;
+	std::uint64_t tail = 0;
+	size_t len = 0;
+	while ((len < 8) && s[len]) {
+		head |= static_cast<std::uint64_t>(static_cast<unsigned char>(s[len])) << (len * 8);
+		len++;
+	}
+	if ((len == 8) && s[len]) {
+		len += strlen(s + len);
+		for (size_t i = len - 8; i < len; i++) {
+			tail = (tail << 8) | static_cast<unsigned char>(s[i]);
+		}
+	}
+	*length = static_cast<int>(len);
+	const std::uint64_t hash = ((head * 0x9E3779B97F4A7C15ULL) ^ tail ^ len) * 0xC2B2AE3D27D4EB4FULL;
+	return static_cast<unsigned int>(hash >> 32);
+}
+
 WordList::WordList(bool onlyLineEnds_) :
-	words(0), list(0), len(0), onlyLineEnds(onlyLineEnds_) {
+	words(0), list(0), len(0), onlyLineEnds(onlyLineEnds_), table(0), tableMask(0) {
 	// Prevent warnings by static analyzers about uninitialized starts.
 	starts[0] = -1;
+	std::fill(inWords, std::end(inWords), false);
+}
+
+WordList::WordList(const WordList &other) :
+	words(0), list(0), len(0), onlyLineEnds(other.onlyLineEnds), table(0), tableMask(0) {
+	starts[0] = -1;
+	std::fill(inWords, std::end(inWords), false);
+	*this = other;
 }
 
 WordList::~WordList() {
 	Clear();
 }
 
+/** Copies are independent so a lexer can be copied to run on another thread.
+ */
+WordList &WordList::operator=(const WordList &other) {
+	if (this != &other) {
+		Clear();
+		onlyLineEnds = other.onlyLineEnds;
+		if (other.words) {
+			// The sentinel word is the terminating NUL of list
+			const size_t lenList = other.words[other.len] - other.list + 1;
+			list = new char[lenList];
+			memcpy(list, other.list, lenList);
+			words = new char *[other.len + 1];
+			for (int i = 0; i <= other.len; i++) {
+				words[i] = list + (other.words[i] - other.list);
+			}
+			len = other.len;
+		}
+		std::copy(other.starts, std::end(other.starts), starts);
+		if (other.table) {
+			table = new HashSlot[other.tableMask + 1];
+			std::copy(other.table, other.table + other.tableMask + 1, table);
+			tableMask = other.tableMask;
+		}
+		std::copy(other.inWords, std::end(other.inWords), inWords);
+	}
+	return *this;
+}
+
 WordList::operator bool() const {
 	return len ? true : false;
 }
@@ -94,9 +156,13 @@ void WordList::Clear() {
 		delete []list;
 		delete []words;
 	}
+	delete []table;
 	words = 0;
 	list = 0;
 	len = 0;
+	table = 0;
+	tableMask = 0;
+	std::fill(inWords, std::end(inWords), false);
 }
 
 #ifdef _MSC_VER
@@ -133,34 +199,42 @@ void WordList::Set(const char *s) {
 		unsigned char indexChar = words[l][0];
 		starts[indexChar] = l;
 	}
+	// Table is at most half full so probe sequences stay short
+	unsigned int slots = 4;
+	while (slots < static_cast<unsigned int>(len) * 2)
+		slots *= 2;
+	table = new HashSlot[slots];
+	tableMask = slots - 1;
+	std::fill(table, table + slots, HashSlot{ 0, 0, -1 });
+	for (int l = 0; l < len; l++) {
+		int length = 0;
+		const unsigned int hash = HashWord(words[l], &length);
+		unsigned int slot = hash & tableMask;
+		while (table[slot].word >= 0)
+			slot = (slot + 1) & tableMask;
+		table[slot] = HashSlot{ hash, length, l };
+		for (int i = 0; i < length; i++)
+			inWords[static_cast<unsigned char>(words[l][i])] = true;
+	}
 }
 
-/** Check whether a string is in the list.
- * List elements are either exact matches or prefixes.
- * Prefix elements start with '^' and match all strings that start with the rest of the element
- * so '^GTK_' matches 'GTK_X', 'GTK_MAJOR_VERSION', and 'GTK_'.
+/** Check whether a string is exactly equal to a word in the list.
  */
-bool WordList::InList(const char *s) const {
-	if (0 == words)
-		return false;
-	const unsigned char firstChar = s[0];
-	int j = starts[firstChar];
-	if (j >= 0) {
-		while (words[j][0] == firstChar) {
-			if (s[1] == words[j][1]) {
-				const char *a = words[j] + 1;
-				const char *b = s + 1;
-				while (*a && *a == *b) {
-					a++;
-					b++;
-				}
-				if (!*a && !*b)
-					return true;
-			}
-			j++;
-		}
+bool WordList::FindExact(const char *s) const noexcept {
+	int length = 0;
+	const unsigned int hash = HashWord(s, &length);
+	for (unsigned int slot = hash & tableMask; table[slot].word >= 0; slot = (slot + 1) & tableMask) {
+		if ((table[slot].hash == hash) && (table[slot].length == length) &&
+			(memcmp(words[table[slot].word], s, length) == 0))
+			return true;
 	}
-	j = starts[static_cast<unsigned int>('^')];
+	return false;
+}
+
+/** Check whether a string starts with any of the prefix elements that start with '^'.
+ */
+bool WordList::InListPrefix(const char *s) const noexcept {
+	int j = starts[static_cast<unsigned int>('^')];
 	if (j >= 0) {
 		while (words[j][0] == '^') {
 			const char *a = words[j] + 1;
@@ -177,6 +251,17 @@ bool WordList::InList(const char *s) const {
 	return false;
 }
 
+/** Check whether a string is in the list.
+ * List elements are either exact matches or prefixes.
+ * Prefix elements start with '^' and match all strings that start with the rest of the element
+ * so '^GTK_' matches 'GTK_X', 'GTK_MAJOR_VERSION', and 'GTK_'.
+ */
+bool WordList::InList(const char *s) const {
+	if (0 == words)
+		return false;
+	return FindExact(s) || InListPrefix(s);
+}
+
 /** similar to InList, but word s can be a substring of keyword.
  * eg. the keyword define is defined as def~ine. This means the word must start
  * with def to be a keyword, but also defi, defin and define are valid.
@@ -185,6 +270,9 @@ bool WordList::InList(const char *s) const {
 bool WordList::InListAbbreviated(const char *s, const char marker) const {
 	if (0 == words)
 		return false;
+	// Without any markers in the list, only exact and prefix matches are possible
+	if (!inWords[static_cast<unsigned char>(marker)])
+		return FindExact(s) || InListPrefix(s);
 	const unsigned char firstChar = s[0];
 	int j = starts[firstChar];
 	if (j >= 0) {
@@ -212,21 +300,7 @@ bool WordList::InListAbbreviated(const char *s, const char marker) const {
 			j++;
 		}
 	}
-	j = starts[static_cast<unsigned int>('^')];
-	if (j >= 0) {
-		while (words[j][0] == '^') {
-			const char *a = words[j] + 1;
-			const char *b = s;
-			while (*a && *a == *b) {
-				a++;
-				b++;
-			}
-			if (!*a)
-				return true;
-			j++;
-		}
-	}
-	return false;
+	return InListPrefix(s);
 }
 
 /** similar to InListAbbreviated, but word s can be a abridged version of a keyword.
@@ -239,6 +313,9 @@ bool WordList::InListAbbreviated(const char *s, const char marker) const {
 bool WordList::InListAbridged(const char *s, const char marker) const {
 	if (0 == words)
 		return false;
+	// Without any markers in the list, only exact matches are possible
+	if (!inWords[static_cast<unsigned char>(marker)])
+		return FindExact(s);
 	const unsigned char firstChar = s[0];
 	int j = starts[firstChar];
 	if (j >= 0) {
@@ -19,9 +19,23 @@ class WordList {
 	int len;
 	bool onlyLineEnds;	///< Delimited by any white space or only line ends
 	int starts[256];
+	// Open addressed hash of the words for exact matches. Each slot holds the
+	// full hash and length of its word so most mismatches need no comparison.
+	struct HashSlot {
+		unsigned int hash;
+		int length;
+		int word;	///< Index into words or -1 for an empty slot
+	};
+	HashSlot *table;
+	unsigned int tableMask;
+	bool inWords[256];	///< Which bytes occur in any word so markers can be detected
+	bool FindExact(const char *s) const noexcept;
+	bool InListPrefix(const char *s) const noexcept;
 public:
 	explicit WordList(bool onlyLineEnds_ = false);
+	WordList(const WordList &other);
 	~WordList();
+	WordList &operator=(const WordList &other);
 	operator bool() const;
 	bool operator!=(const WordList &other) const;
 	int Length() const;
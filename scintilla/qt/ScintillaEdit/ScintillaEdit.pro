@@ -49,6 +49,7 @@ SOURCES += \
     ../../src/CaseFolder.cxx \
     ../../src/CaseConvert.cxx \
     ../../src/CallTip.cxx \
+    ../../src/BackgroundStyler.cxx \
     ../../src/AutoComplete.cxx \
     ../../lexlib/WordList.cxx \
     ../../lexlib/StyleContext.cxx \
@@ -575,6 +575,12 @@ void SurfaceImpl::SetBidiR2L(bool)
 {
 }
 
+bool SurfaceImpl::ThreadSafeMeasureWidths()
+{
+	// QFontMetricsF may only be used from the GUI thread.
+	return false;
+}
+
 QPaintDevice *SurfaceImpl::GetPaintDevice()
 {
 	return device;
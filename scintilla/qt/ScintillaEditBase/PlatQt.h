@@ -129,6 +129,7 @@ public:
 	void SetUnicodeMode(bool unicodeMode_) override;
 	void SetDBCSMode(int codePage_) override;
 	void SetBidiR2L(bool bidiR2L_) override;
+	bool ThreadSafeMeasureWidths() override;
 
 	void BrushColour(ColourDesired back);
 	void SetCodec(Font &font);
@@ -47,6 +47,7 @@ SOURCES += \
     ../../src/CaseFolder.cxx \
     ../../src/CaseConvert.cxx \
     ../../src/CallTip.cxx \
+    ../../src/BackgroundStyler.cxx \
     ../../src/AutoComplete.cxx \
     ../../lexlib/WordList.cxx \
     ../../lexlib/StyleContext.cxx \
@@ -77,6 +78,7 @@ HEADERS  += \
     ../../src/PositionCache.h \
     ../../src/PerLine.h \
     ../../src/Partitioning.h \
+    ../../src/ChunkVector.h \
     ../../src/LineMarker.h \
     ../../src/KeyMap.h \
     ../../src/Indicator.h \
@@ -92,6 +94,7 @@ HEADERS  += \
     ../../src/CaseFolder.h \
     ../../src/CaseConvert.h \
     ../../src/CallTip.h \
+    ../../src/BackgroundStyler.h \
     ../../src/AutoComplete.h \
     ../../include/Scintilla.h \
     ../../include/SciLexer.h \
@@ -3,10 +3,19 @@
 # Requires Python 3.3 or later
 # Should not be run with old versions of Python.
 
+# The categories are stored in a two level table.
+# Unicode is divided into blocks of 128 characters and blocks with identical
+# categories are stored once in catBlocks. catIndex holds the block number for
+# each 128 character range so a category is found with two array lookups.
+
 import codecs, os, platform, sys, unicodedata
 
 from FileGenerator import Regenerate
 
+blockShift = 7
+blockSize = 1 << blockShift
+valuesPerLine = 32
+
 def findCategories(filename):
     with codecs.open(filename, "r", "UTF-8") as infile:
         lines = [x.strip() for x in infile.readlines() if "\tcc" in x]
@@ -14,32 +23,30 @@ def findCategories(filename):
     print(values)
     return [v[2:] for v in values]
 
+def valueLines(table):
+    return ["".join("%d," % v for v in table[i:i+valuesPerLine])
+        for i in range(0, len(table), valuesPerLine)]
+
+def categoryTables(categoryOf):
+    blocks = {}
+    index = []
+    for start in range(0, sys.maxunicode + 1, blockSize):
+        block = tuple(categories.index(categoryOf(ch))
+            for ch in range(start, start + blockSize))
+        index.append(blocks.setdefault(block, len(blocks)))
+    # The index is an unsigned char array
+    assert len(blocks) <= 256
+    blockValues = []
+    for block in sorted(blocks, key=blocks.get):
+        blockValues.extend(block)
+    return index, blockValues
+
 def updateCharacterCategory(filename):
-    values = ["// Created with Python %s,  Unicode %s" % (
+    index, blockValues = categoryTables(lambda ch: unicodedata.category(chr(ch)))
+    indexLines = ["// Created with Python %s,  Unicode %s" % (
         platform.python_version(), unicodedata.unidata_version)]
-
-    startRange = 0
-    category = unicodedata.category(chr(startRange))
-    table = []
-    for ch in range(sys.maxunicode):
-        uch = chr(ch)
-        current = unicodedata.category(uch)
-        if current != category:
-            value = startRange * 32 + categories.index(category)
-            table.append(value)
-            category = current
-            startRange = ch
-    value = startRange * 32 + categories.index(category)
-    table.append(value)
-
-    # the sentinel value is used to simplify CharacterCategoryMap::Optimize()
-    category = 'Cn'
-    value = (sys.maxunicode + 1)*32 + categories.index(category)
-    table.append(value)
-
-    values.extend(["%d," % value for value in table])
-
-    Regenerate(filename, "//", values)
+    indexLines.extend(valueLines(index))
+    Regenerate(filename, "//", indexLines, valueLines(blockValues))
 
 categories = findCategories("../lexlib/CharacterCategory.h")
 
@@ -6,6 +6,7 @@
 // The License.txt file describes the conditions under which this software may be distributed.
 
 #include <cstddef>
+#include <climits>
 #include <cstdlib>
 #include <cassert>
 #include <cstring>
@@ -31,6 +32,8 @@ AutoComplete::AutoComplete() :
 	active(false),
 	separator(' '),
 	typesep('?'),
+	occurrencesIgnoreCase(false),
+	filtered(false),
 	ignoreCase(false),
 	chooseSingle(false),
 	posStart(0),
@@ -41,7 +44,8 @@ AutoComplete::AutoComplete() :
 	ignoreCaseBehaviour(SC_CASEINSENSITIVEBEHAVIOUR_RESPECTCASE),
 	widthLBDefault(100),
 	heightLBDefault(100),
-	autoSort(SC_ORDER_PRESORTED) {
+	autoSort(SC_ORDER_PRESORTED),
+	match(SC_AUTOCMATCH_PREFIX) {
 	lb.reset(ListBox::Allocate());
 }
 
@@ -100,93 +104,181 @@ char AutoComplete::GetTypesep() const noexcept {
 	return typesep;
 }
 
-struct Sorter {
-	AutoComplete *ac;
-	const char *list;
-	std::vector<int> indices;
-
-	Sorter(AutoComplete *ac_, const char *list_) : ac(ac_), list(list_) {
-		int i = 0;
-		while (list[i]) {
-			indices.push_back(i); // word start
-			while (list[i] != ac->GetTypesep() && list[i] != ac->GetSeparator() && list[i])
-				++i;
-			indices.push_back(i); // word end
-			if (list[i] == ac->GetTypesep()) {
-				while (list[i] != ac->GetSeparator() && list[i])
-					++i;
-			}
-			if (list[i] == ac->GetSeparator()) {
-				++i;
-				// preserve trailing separator as blank entry
-				if (!list[i]) {
-					indices.push_back(i);
-					indices.push_back(i);
-				}
-			}
-		}
-		indices.push_back(i); // index of last position
-	}
+namespace {
 
-	bool operator()(int a, int b) {
-		const int lenA = indices[a * 2 + 1] - indices[a * 2];
-		const int lenB = indices[b * 2 + 1] - indices[b * 2];
-		const int len  = std::min(lenA, lenB);
-		int cmp;
-		if (ac->ignoreCase)
-			cmp = CompareNCaseInsensitive(list + indices[a * 2], list + indices[b * 2], len);
-		else
-			cmp = strncmp(list + indices[a * 2], list + indices[b * 2], len);
-		if (cmp == 0)
-			cmp = lenA - lenB;
-		return cmp < 0;
-	}
-};
+// Places each letter, in each case unless ignoring case, and digit on its own bit so a set of
+// the characters in a word can be checked against the set of characters in an item with a
+// single operation.
+unsigned long long CharacterBit(unsigned char ch, bool ignoreCase) noexcept {
+	if (ignoreCase)
+		ch = MakeLowerCase(ch);
+	if (ch >= 'a' && ch <= 'z')
+		return 1ULL << (ch - 'a');
+	if (ch >= 'A' && ch <= 'Z')
+		return 1ULL << (26 + ch - 'A');
+	if (IsADigit(ch))
+		return 1ULL << (52 + ch - '0');
+	return 1ULL << (62 + ch % 2);
+}
 
-void AutoComplete::SetList(const char *list) {
-	if (autoSort == SC_ORDER_PRESORTED) {
-		lb->SetList(list, separator, typesep);
-		sortMatrix.clear();
-		for (int i = 0; i < lb->Length(); ++i)
-			sortMatrix.push_back(i);
-		return;
-	}
+unsigned long long CharacterBits(std::string_view text, bool ignoreCase) noexcept {
+	unsigned long long bits = 0;
+	for (const char ch : text)
+		bits |= CharacterBit(ch, ignoreCase);
+	return bits;
+}
 
-	Sorter IndexSort(this, list);
-	sortMatrix.clear();
-	for (int i = 0; i < static_cast<int>(IndexSort.indices.size()) / 2; ++i)
-		sortMatrix.push_back(i);
-	std::sort(sortMatrix.begin(), sortMatrix.end(), IndexSort);
-	if (autoSort == SC_ORDER_CUSTOM || sortMatrix.size() < 2) {
-		lb->SetList(list, separator, typesep);
-		PLATFORM_ASSERT(lb->Length() == static_cast<int>(sortMatrix.size()));
-		return;
+// Is position at the start of the text or of a part of an identifier like "Value" in
+// "GetValue", "value" in "get_value", or "2" in "utf2"?
+bool IsPartStart(std::string_view text, size_t position) noexcept {
+	if (position == 0)
+		return true;
+	const unsigned char ch = text[position];
+	const unsigned char chPrevious = text[position - 1];
+	if (!IsAlphaNumeric(chPrevious))
+		return true;
+	return (IsUpperCase(ch) && IsLowerCase(chPrevious)) || (IsADigit(ch) && !IsADigit(chPrevious));
+}
+
+// Scores for matching a character of a word at the start of the text, at the start of a part,
+// following the previous character, and with the same case.
+constexpr int scoreStart = 8;
+constexpr int scorePart = 6;
+constexpr int scoreRun = 4;
+constexpr int scoreCase = 1;
+constexpr int scoreCharacterMost = scoreStart + scoreCase;
+
+// Score a character of a word matched at position matched in text without any case bonus.
+// Only a match at start, where the search for the character began, follows the previous one.
+int PositionScore(std::string_view text, size_t matched, size_t start) noexcept {
+	if (matched == 0)
+		return scoreStart;
+	else if (IsPartStart(text, matched))
+		return scorePart;
+	else if (matched == start)
+		return scoreRun;
+	return 0;
+}
+
+// Match the next character of a word as a subsequence of text by finding it at or after
+// position in textSearched, which is text or its lower case form when ignoring case.
+// On success, position moves after the character and score increases, with a bonus for
+// the same case.
+bool MatchNext(std::string_view text, std::string_view textSearched, char ch, char chSearched,
+	int &score, int &position) noexcept {
+	const size_t start = position;
+	if (start >= textSearched.length())
+		return false;
+	const void *found = memchr(textSearched.data() + start, chSearched, textSearched.length() - start);
+	if (!found)
+		return false;
+	const size_t matched = static_cast<const char *>(found) - textSearched.data();
+	score += PositionScore(text, matched, start) + ((text[matched] == ch) ? scoreCase : 0);
+	position = static_cast<int>(matched + 1);
+	return true;
+}
+
+// The first occurrences of a character are divided by whether they are at the start of the
+// text, at the start of a part, or elsewhere and by whether they differ in case from the
+// searched character so all in a class score the same as the first character of a word.
+constexpr size_t occurrenceClasses = 6;
+
+size_t OccurrenceClass(std::string_view text, size_t position, char chSearched) noexcept {
+	const int score = PositionScore(text, position, 0);
+	const size_t where = (score == scoreStart) ? 0 : ((score == scorePart) ? 1 : 2);
+	return where * 2 + ((text[position] == chSearched) ? 0 : 1);
+}
+
+}
+
+std::string_view AutoComplete::Word(int item) const noexcept {
+	const ItemExtent &extent = items[item];
+	return std::string_view(listText.data() + extent.start, extent.lengthWord);
+}
+
+// Compare word with the start of an item's word like strncmp or CompareNCaseInsensitive.
+int AutoComplete::CompareWord(const char *word, size_t lenWord, int item, bool caseSensitive) const noexcept {
+	const std::string_view itemWord = Word(item);
+	const size_t len = std::min(lenWord, itemWord.length());
+	const int cmp = caseSensitive ?
+		strncmp(word, itemWord.data(), len) :
+		CompareNCaseInsensitive(word, itemWord.data(), len);
+	if (cmp)
+		return cmp;
+	return (itemWord.length() < lenWord) ? 1 : 0;
+}
+
+// Find the extent of each item in the same way as ListBox::SetList.
+void AutoComplete::SplitItems() {
+	items.clear();
+	size_t start = 0;
+	size_t endWord = std::string::npos;
+	for (size_t i = 0; i <= listText.length(); i++) {
+		if ((i == listText.length()) || (listText[i] == separator)) {
+			const size_t lengthItem = i - start;
+			const size_t lengthWord = (endWord == std::string::npos) ? lengthItem : endWord - start;
+			items.push_back({start, lengthWord, lengthItem});
+			start = i + 1;
+			endWord = std::string::npos;
+		} else if (listText[i] == typesep) {
+			endWord = i;
+		}
 	}
+}
+
+void AutoComplete::SetList(const char *list) {
+	listText = list;
+	SplitItems();
+	sortMatrix.resize(items.size());
+	for (size_t i = 0; i < sortMatrix.size(); ++i)
+		sortMatrix[i] = static_cast<int>(i);
+	itemsRanked.clear();
+	itemCharacters.clear();
+	listLowered.clear();
+	occurrences.clear();
+	occurrenceStarts.clear();
+	scoreFollowingMost.clear();
+	wordFiltered.clear();
+	candidates.clear();
+	occurrencesWaiting.clear();
+	itemsShown.clear();
+	filtered = false;
 
-	std::string sortedList;
-	char item[maxItemLen];
-	for (size_t i = 0; i < sortMatrix.size(); ++i) {
-		int wordLen = IndexSort.indices[sortMatrix[i] * 2 + 2] - IndexSort.indices[sortMatrix[i] * 2];
-		if (wordLen > maxItemLen-2)
-			wordLen = maxItemLen - 2;
-		memcpy(item, list + IndexSort.indices[sortMatrix[i] * 2], wordLen);
-		if ((i+1) == sortMatrix.size()) {
-			// Last item so remove separator if present
-			if ((wordLen > 0) && (item[wordLen-1] == separator))
-				wordLen--;
-		} else {
-			// Item before last needs a separator
-			if ((wordLen == 0) || (item[wordLen-1] != separator)) {
-				item[wordLen] = separator;
-				wordLen++;
+	if ((autoSort != SC_ORDER_PRESORTED) && (sortMatrix.size() >= 2)) {
+		const bool caseSensitive = !ignoreCase;
+		std::sort(sortMatrix.begin(), sortMatrix.end(), [this, caseSensitive](int a, int b) noexcept {
+			const std::string_view wordA = Word(a);
+			const std::string_view wordB = Word(b);
+			const size_t len = std::min(wordA.length(), wordB.length());
+			const int cmp = caseSensitive ?
+				strncmp(wordA.data(), wordB.data(), len) :
+				CompareNCaseInsensitive(wordA.data(), wordB.data(), len);
+			if (cmp == 0)
+				return wordA.length() < wordB.length();
+			return cmp < 0;
+		});
+		if (autoSort == SC_ORDER_PERFORMSORT) {
+			// Rearrange the text so the list box shows the sorted list
+			std::string sortedText;
+			sortedText.reserve(listText.length());
+			std::vector<ItemExtent> sortedItems;
+			sortedItems.reserve(items.size());
+			for (const int item : sortMatrix) {
+				if (!sortedItems.empty())
+					sortedText.push_back(separator);
+				const ItemExtent &extent = items[item];
+				sortedItems.push_back({sortedText.length(), extent.lengthWord, extent.lengthItem});
+				sortedText.append(listText, extent.start, extent.lengthItem);
 			}
+			listText = std::move(sortedText);
+			items = std::move(sortedItems);
+			for (size_t i = 0; i < sortMatrix.size(); ++i)
+				sortMatrix[i] = static_cast<int>(i);
 		}
-		item[wordLen] = '\0';
-		sortedList += item;
 	}
-	for (int i = 0; i < static_cast<int>(sortMatrix.size()); ++i)
-		sortMatrix[i] = i;
-	lb->SetList(sortedList.c_str(), separator, typesep);
+	if (match == SC_AUTOCMATCH_SUBSEQUENCE)
+		IndexSubsequence();
+	lb->SetList(listText.c_str(), separator, typesep);
 }
 
 int AutoComplete::GetSelection() const {
@@ -226,49 +318,36 @@ void AutoComplete::Move(int delta) {
 }
 
 void AutoComplete::Select(const char *word) {
+	if (match == SC_AUTOCMATCH_SUBSEQUENCE) {
+		SelectSubsequence(word);
+		return;
+	}
+	if (filtered) {
+		lb->SetList(listText.c_str(), separator, typesep);
+		itemsShown.clear();
+		filtered = false;
+	}
 	const size_t lenWord = strlen(word);
+	const int count = static_cast<int>(sortMatrix.size());
+	// Items that start with word are together in the sorted order so find the first
+	const auto first = std::lower_bound(sortMatrix.begin(), sortMatrix.end(), word,
+		[this, lenWord](int item, const char *w) noexcept {
+		return CompareWord(w, lenWord, item, !ignoreCase) > 0;
+	});
 	int location = -1;
-	int start = 0; // lower bound of the api array block to search
-	int end = lb->Length() - 1; // upper bound of the api array block to search
-	while ((start <= end) && (location == -1)) { // Binary searching loop
-		int pivot = (start + end) / 2;
-		char item[maxItemLen];
-		lb->GetValue(sortMatrix[pivot], item, maxItemLen);
-		int cond;
-		if (ignoreCase)
-			cond = CompareNCaseInsensitive(word, item, lenWord);
-		else
-			cond = strncmp(word, item, lenWord);
-		if (!cond) {
-			// Find first match
-			while (pivot > start) {
-				lb->GetValue(sortMatrix[pivot-1], item, maxItemLen);
-				if (ignoreCase)
-					cond = CompareNCaseInsensitive(word, item, lenWord);
-				else
-					cond = strncmp(word, item, lenWord);
-				if (0 != cond)
+	if ((first != sortMatrix.end()) && !CompareWord(word, lenWord, *first, !ignoreCase)) {
+		location = static_cast<int>(first - sortMatrix.begin());
+		if (ignoreCase
+			&& ignoreCaseBehaviour == SC_CASEINSENSITIVEBEHAVIOUR_RESPECTCASE) {
+			// Check for exact-case match
+			for (int pivot = location; pivot < count; pivot++) {
+				if (!CompareWord(word, lenWord, sortMatrix[pivot], true)) {
+					location = pivot;
 					break;
-				--pivot;
-			}
-			location = pivot;
-			if (ignoreCase
-				&& ignoreCaseBehaviour == SC_CASEINSENSITIVEBEHAVIOUR_RESPECTCASE) {
-				// Check for exact-case match
-				for (; pivot <= end; pivot++) {
-					lb->GetValue(sortMatrix[pivot], item, maxItemLen);
-					if (!strncmp(word, item, lenWord)) {
-						location = pivot;
-						break;
-					}
-					if (CompareNCaseInsensitive(word, item, lenWord))
-						break;
 				}
+				if (CompareWord(word, lenWord, sortMatrix[pivot], false))
+					break;
 			}
-		} else if (cond < 0) {
-			end = pivot - 1;
-		} else if (cond > 0) {
-			start = pivot + 1;
 		}
 	}
 	if (location == -1) {
@@ -279,12 +358,10 @@ void AutoComplete::Select(const char *word) {
 	} else {
 		if (autoSort == SC_ORDER_CUSTOM) {
 			// Check for a logically earlier match
-			char item[maxItemLen];
-			for (int i = location + 1; i <= end; ++i) {
-				lb->GetValue(sortMatrix[i], item, maxItemLen);
-				if (CompareNCaseInsensitive(word, item, lenWord))
+			for (int i = location + 1; i < count; ++i) {
+				if (CompareWord(word, lenWord, sortMatrix[i], false))
 					break;
-				if (sortMatrix[i] < sortMatrix[location] && !strncmp(word, item, lenWord))
+				if (sortMatrix[i] < sortMatrix[location] && !CompareWord(word, lenWord, sortMatrix[i], true))
 					location = i;
 			}
 		}
@@ -292,3 +369,351 @@ void AutoComplete::Select(const char *word) {
 	}
 }
 
+void AutoComplete::IndexSubsequence() {
+	// Rank the items by length, keeping list order for each length
+	std::vector<size_t> lengthStarts;
+	for (const ItemExtent &extent : items) {
+		if (extent.lengthWord + 1 >= lengthStarts.size())
+			lengthStarts.resize(extent.lengthWord + 2);
+		lengthStarts[extent.lengthWord + 1]++;
+	}
+	for (size_t length = 1; length < lengthStarts.size(); length++)
+		lengthStarts[length] += lengthStarts[length - 1];
+	itemsRanked.resize(items.size());
+	for (size_t item = 0; item < items.size(); item++)
+		itemsRanked[lengthStarts[items[item].lengthWord]++] = static_cast<int>(item);
+
+	itemCharacters.resize(items.size());
+	for (size_t rank = 0; rank < items.size(); rank++)
+		itemCharacters[rank] = CharacterBits(Word(itemsRanked[rank]), ignoreCase);
+	if (ignoreCase) {
+		listLowered = listText;
+		std::transform(listLowered.begin(), listLowered.end(), listLowered.begin(), MakeLowerCase<char>);
+	} else {
+		listLowered.clear();
+	}
+	const std::string &listSearched = ignoreCase ? listLowered : listText;
+
+	// Count the items containing each character in each class then place the first occurrence
+	// of each character in each item so each character's group is divided into its classes
+	// in rank order. Only characters that start a part after the start of an item can score
+	// as much as scorePart when following the first character of a word.
+	constexpr size_t characters = 0x100;
+	std::vector<int> rankLast(characters, -1);
+	occurrenceStarts.assign(characters * occurrenceClasses + 1, 0);
+	scoreFollowingMost.assign(characters, scoreRun + scoreCase);
+	for (size_t rank = 0; rank < items.size(); rank++) {
+		const ItemExtent &extent = items[itemsRanked[rank]];
+		const std::string_view text(listText.data() + extent.start, extent.lengthWord);
+		const std::string_view searched(listSearched.data() + extent.start, extent.lengthWord);
+		for (size_t i = 0; i < text.length(); i++) {
+			const unsigned char ch = searched[i];
+			if ((i > 0) && IsPartStart(text, i))
+				scoreFollowingMost[ch] = scorePart + scoreCase;
+			if (rankLast[ch] != static_cast<int>(rank)) {
+				rankLast[ch] = static_cast<int>(rank);
+				occurrenceStarts[ch * occurrenceClasses + OccurrenceClass(text, i, ch) + 1]++;
+			}
+		}
+	}
+	for (size_t group = 0; group < characters * occurrenceClasses; group++)
+		occurrenceStarts[group + 1] += occurrenceStarts[group];
+	occurrences.resize(occurrenceStarts.back());
+	std::vector<size_t> placed(occurrenceStarts.begin(), occurrenceStarts.end() - 1);
+	std::fill(rankLast.begin(), rankLast.end(), -1);
+	for (size_t rank = 0; rank < items.size(); rank++) {
+		const ItemExtent &extent = items[itemsRanked[rank]];
+		const std::string_view text(listText.data() + extent.start, extent.lengthWord);
+		const std::string_view searched(listSearched.data() + extent.start, extent.lengthWord);
+		for (size_t i = 0; i < text.length(); i++) {
+			const unsigned char ch = searched[i];
+			if (rankLast[ch] != static_cast<int>(rank)) {
+				rankLast[ch] = static_cast<int>(rank);
+				occurrences[placed[ch * occurrenceClasses + OccurrenceClass(text, i, ch)]++] = {
+					static_cast<int>(rank), static_cast<int>(i),
+					static_cast<short>(PositionScore(text, i, 0)), text[i],
+					(i + 1 < searched.length()) ? searched[i + 1] : '\0'};
+			}
+		}
+	}
+	occurrencesIgnoreCase = ignoreCase;
+}
+
+void AutoComplete::SelectSubsequence(const char *word) {
+	const std::string_view wordView(word);
+	if (wordView.empty()) {
+		if (filtered) {
+			lb->SetList(listText.c_str(), separator, typesep);
+			itemsShown.clear();
+			filtered = false;
+		}
+		wordFiltered.clear();
+		candidates.clear();
+		occurrencesWaiting.clear();
+		lb->Select(0);
+		return;
+	}
+
+	if ((itemCharacters.size() != items.size()) || (occurrencesIgnoreCase != ignoreCase)) {
+		IndexSubsequence();
+		wordFiltered.clear();
+	}
+	const std::string &listSearched = ignoreCase ? listLowered : listText;
+	std::string wordSearched(wordView);
+	if (ignoreCase)
+		std::transform(wordSearched.begin(), wordSearched.end(), wordSearched.begin(), MakeLowerCase<char>);
+
+	// Items that match a word also match every prefix of that word so, as characters are
+	// typed, only the items that matched the previous word need to be examined and each
+	// continues from where the previous word matched.
+	const bool narrowing = !wordFiltered.empty() &&
+		(wordView.substr(0, wordFiltered.length()) == wordFiltered);
+	wordFiltered = wordView;
+	const size_t lengthWord = wordView.length();
+	// The most the first characters of the word can score for each number of characters
+	std::vector<int> scoreMost(lengthWord + 1, 0);
+	scoreMost[1] = scoreCharacterMost;
+	for (size_t i = 1; i < lengthWord; i++)
+		scoreMost[i + 1] = scoreMost[i] + scoreFollowingMost[static_cast<unsigned char>(wordSearched[i])];
+	const size_t shortfallMost = scoreMost[lengthWord];
+	if (!narrowing) {
+		for (std::vector<Candidate> &group : candidates)
+			group.clear();
+		// Only the items containing the first character are examined, starting from its
+		// first occurrence, and each class of occurrences waits until candidates scoring
+		// that much are needed.
+		occurrencesWaiting.clear();
+		const size_t groupFirst = static_cast<unsigned char>(wordSearched[0]) * occurrenceClasses;
+		for (size_t group = groupFirst; group < groupFirst + occurrenceClasses; group++) {
+			const size_t start = occurrenceStarts[group];
+			const size_t end = occurrenceStarts[group + 1];
+			if (start < end) {
+				const Occurrence &occurrence = occurrences[start];
+				const int score = occurrence.scorePosition + ((occurrence.ch == wordView[0]) ? scoreCase : 0);
+				occurrencesWaiting.push_back({start, end, score, static_cast<size_t>(scoreCharacterMost - score), false, '\0'});
+			}
+		}
+	}
+	if (candidates.size() <= shortfallMost)
+		candidates.resize(shortfallMost + 1);
+	// A word with a character that no item contains can't match
+	const bool absent = std::any_of(wordSearched.begin(), wordSearched.end(), [this](char ch) noexcept {
+		const size_t groupCharacter = static_cast<unsigned char>(ch) * occurrenceClasses;
+		return occurrenceStarts[groupCharacter] == occurrenceStarts[groupCharacter + occurrenceClasses];
+	});
+	if (absent) {
+		for (std::vector<Candidate> &group : candidates)
+			group.clear();
+		occurrencesWaiting.clear();
+	}
+
+	const unsigned long long wordCharacters = CharacterBits(wordView, ignoreCase);
+	// Items without every character of the word can't match it or any word it narrows to
+	auto contains = [&](int rank) noexcept {
+		return (itemCharacters[rank] & wordCharacters) == wordCharacters;
+	};
+	// Match the rest of the word after the candidate's matched characters
+	auto matchRest = [&](Candidate &candidate) noexcept {
+		if (!contains(candidate.rank))
+			return false;
+		const ItemExtent &extent = items[itemsRanked[candidate.rank]];
+		const std::string_view text(listText.data() + extent.start, extent.lengthWord);
+		const std::string_view searched(listSearched.data() + extent.start, extent.lengthWord);
+		for (size_t i = candidate.matched; i < lengthWord; i++) {
+			if (!MatchNext(text, searched, wordView[i], wordSearched[i], candidate.score, candidate.position))
+				return false;
+		}
+		candidate.matched = static_cast<short>(lengthWord);
+		candidate.chNext = (static_cast<size_t>(candidate.position) < searched.length()) ?
+			searched[candidate.position] : '\0';
+		return true;
+	};
+
+	// Only the best matches are shown as long lists are slow to fill and to look through.
+	// Matching more characters never reduces how far a candidate falls short so groups are
+	// completed in order, matching the rest of the word for candidates that have not, until
+	// the completed groups hold enough to show. Candidates in later groups cannot score
+	// better so they wait until more characters are typed or all are needed.
+	// A candidate's next character can only score as a run when it follows the last match
+	// so, when it doesn't and can't start a part, the candidate waits in the group for the
+	// lower score it may reach. As that depends only on the characters already typed, the
+	// candidate stays there as more are typed.
+	// So that typing stays responsive with long lists, no more than maxExaminedSubsequence
+	// are examined for each word and the best of those matched are shown with the rest
+	// examined as further characters are typed.
+	size_t shortfallLowest = 0;
+	size_t countExamined = 0;
+	// Examine a candidate, returning whether it matches the word falling short by shortfallLowest
+	// and moving it to a later group if it may match falling short by more.
+	auto examine = [&](Candidate &candidate) {
+		countExamined++;
+		if (candidate.matched < static_cast<int>(lengthWord)) {
+			const char chNext = wordSearched[candidate.matched];
+			if ((candidate.chNext != chNext) &&
+				(scoreFollowingMost[static_cast<unsigned char>(chNext)] < scorePart + scoreCase)) {
+				const size_t shortfallLeast = scoreMost[candidate.matched + 1] - candidate.score - scoreCase;
+				if (shortfallLeast != shortfallLowest) {
+					candidates[shortfallLeast].push_back(candidate);
+					return false;
+				}
+			}
+			if (!matchRest(candidate))
+				return false;
+			const size_t shortfall = shortfallMost - candidate.score;
+			if (shortfall != shortfallLowest) {
+				candidates[shortfall].push_back(candidate);
+				return false;
+			}
+		}
+		return true;
+	};
+	auto exhausted = [&]() noexcept {
+		return countExamined >= maxExaminedSubsequence;
+	};
+	auto byRank = [](const Candidate &a, const Candidate &b) noexcept {
+		return a.rank < b.rank;
+	};
+
+	// Occurrences of the first character stay in their ranges, which are in rank order, until
+	// examined. When the following character can only score as a run, the occurrences it
+	// follows become candidates and the rest of the range waits for the lower score it may reach.
+	const char chSecond = (lengthWord > 1) ? wordSearched[1] : '\0';
+	const bool splitting = (lengthWord > 1) &&
+		(scoreFollowingMost[static_cast<unsigned char>(chSecond)] < scorePart + scoreCase);
+	size_t countShown = 0;
+	for (; (shortfallLowest <= shortfallMost) && (countShown < maxShownSubsequence); shortfallLowest++) {
+		std::vector<Candidate> &group = candidates[shortfallLowest];
+		size_t countWaiting = 0;
+		for (OccurrenceRange &range : occurrencesWaiting) {
+			if (range.shortfall == shortfallLowest) {
+				if (splitting && !range.split) {
+					for (size_t o = range.start; o < range.end; o++) {
+						const Occurrence &occurrence = occurrences[o];
+						if ((occurrence.chNext == chSecond) && contains(occurrence.rank))
+							group.push_back({occurrence.rank, range.score, occurrence.position + 1, 1, occurrence.chNext});
+					}
+					range.shortfall += scoreFollowingMost[static_cast<unsigned char>(chSecond)] - scoreCase;
+					range.split = true;
+					range.chSplit = chSecond;
+				} else {
+					countWaiting += range.end - range.start;
+				}
+			}
+		}
+
+		size_t kept = 0;
+		size_t examined = 0;
+		for (; (examined < group.size()) && !exhausted(); examined++) {
+			Candidate candidate = group[examined];
+			if (examine(candidate))
+				group[kept++] = candidate;
+		}
+		const bool stopped = examined < group.size();
+		group.erase(group.begin() + kept, group.begin() + examined);
+		if (stopped)
+			break;
+
+		if (countWaiting == 0) {
+			// When more match than can be shown, those shown are the earliest ranked
+			if (countShown + kept > maxShownSubsequence) {
+				std::nth_element(group.begin(), group.begin() + (maxShownSubsequence - countShown),
+					group.end(), byRank);
+			}
+			countShown += std::min(kept, maxShownSubsequence - countShown);
+			continue;
+		}
+
+		// The occurrences waiting for this group are examined in rank order, merged with the
+		// candidates kept, so examining stops once the list is full, leaving the rest, which
+		// would be shown after, waiting.
+		if ((countShown + kept + countWaiting >= maxShownSubsequence) &&
+			!std::is_sorted(group.begin(), group.end(), byRank)) {
+			std::sort(group.begin(), group.end(), byRank);
+		}
+		candidatesKept.clear();
+		size_t taken = 0;
+		while ((countShown + candidatesKept.size() < maxShownSubsequence) && !exhausted()) {
+			OccurrenceRange *rangeLeast = nullptr;
+			int rankLeast = (taken < group.size()) ? group[taken].rank : INT_MAX;
+			for (OccurrenceRange &range : occurrencesWaiting) {
+				if (range.shortfall == shortfallLowest) {
+					while ((range.start < range.end) &&
+						((range.split && (occurrences[range.start].chNext == range.chSplit)) ||
+						!contains(occurrences[range.start].rank))) {
+						range.start++;
+					}
+					if ((range.start < range.end) && (occurrences[range.start].rank < rankLeast)) {
+						rangeLeast = &range;
+						rankLeast = occurrences[range.start].rank;
+					}
+				}
+			}
+			if (rangeLeast) {
+				const Occurrence &occurrence = occurrences[rangeLeast->start++];
+				Candidate candidate {occurrence.rank, rangeLeast->score, occurrence.position + 1, 1, occurrence.chNext};
+				if (examine(candidate))
+					candidatesKept.push_back(candidate);
+			} else if (taken < group.size()) {
+				candidatesKept.push_back(group[taken++]);
+			} else {
+				break;
+			}
+		}
+		countShown += candidatesKept.size();
+		candidatesKept.insert(candidatesKept.end(), group.begin() + taken, group.end());
+		group.swap(candidatesKept);
+		if (exhausted() && (countShown < maxShownSubsequence))
+			break;
+	}
+	occurrencesWaiting.erase(std::remove_if(occurrencesWaiting.begin(), occurrencesWaiting.end(),
+		[](const OccurrenceRange &range) noexcept {
+		return range.start >= range.end;
+	}), occurrencesWaiting.end());
+
+	// The candidates shown are those matching from each group in turn, where only the first
+	// of the last group completed are shown.
+	candidatesBest.clear();
+	for (size_t shortfall = 0; (shortfall <= shortfallMost) && (candidatesBest.size() < maxShownSubsequence); shortfall++) {
+		for (const Candidate &candidate : candidates[shortfall]) {
+			if (candidatesBest.size() >= maxShownSubsequence)
+				break;
+			if (candidate.matched == static_cast<int>(lengthWord))
+				candidatesBest.push_back(candidate);
+		}
+	}
+	if (candidatesBest.empty()) {
+		// Hide only when no candidate is left that may match
+		if (autoHide && (shortfallLowest > shortfallMost))
+			Cancel();
+		else
+			lb->Select(-1);
+		return;
+	}
+	std::sort(candidatesBest.begin(), candidatesBest.end(), [](const Candidate &a, const Candidate &b) noexcept {
+		if (a.score != b.score)
+			return a.score > b.score;
+		return a.rank < b.rank;
+	});
+
+	// Filling the list box is slow so only do it when the items shown change
+	const bool same = filtered && (candidatesBest.size() == itemsShown.size()) &&
+		std::equal(candidatesBest.begin(), candidatesBest.end(), itemsShown.begin(),
+		[this](const Candidate &candidate, int item) noexcept {
+		return itemsRanked[candidate.rank] == item;
+	});
+	if (!same) {
+		itemsShown.clear();
+		std::string shown;
+		for (const Candidate &candidate : candidatesBest) {
+			if (!itemsShown.empty())
+				shown.push_back(separator);
+			const int item = itemsRanked[candidate.rank];
+			const ItemExtent &extent = items[item];
+			shown.append(listText, extent.start, extent.lengthItem);
+			itemsShown.push_back(item);
+		}
+		lb->SetList(shown.c_str(), separator, typesep);
+		filtered = true;
+	}
+	lb->Select(0);
+}
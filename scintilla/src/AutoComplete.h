@@ -18,9 +18,70 @@ class AutoComplete {
 	std::string fillUpChars;
 	char separator;
 	char typesep; // Type seperator
-	enum { maxItemLen=1000 };
+	enum { maxItemLen=1000, maxShownSubsequence=1000, maxExaminedSubsequence=3000 };
 	std::vector<int> sortMatrix;
 
+	// The list as shown when nothing has been filtered out along with the extent of each item
+	// and its word within listText so items can be compared without asking the list box.
+	struct ItemExtent {
+		size_t start;
+		size_t lengthWord;
+		size_t lengthItem;	// Includes any type
+	};
+	std::string listText;
+	std::vector<ItemExtent> items;
+	std::string_view Word(int item) const noexcept;
+	int CompareWord(const char *word, size_t lenWord, int item, bool caseSensitive) const noexcept;
+	void SplitItems();
+
+	// For SC_AUTOCMATCH_SUBSEQUENCE, the items ranked in the order those scoring the same are
+	// shown, shortest first then in list order, with a set of the characters, as searched, in each
+	// ranked item so most items can be rejected before scanning, the list in lower case for
+	// ignoring case, where each character first occurs in each item grouped by character and
+	// by how it scores so the first character of a word only visits items containing it, the
+	// most each character can score after the first, the items that may match the most recent
+	// word grouped by how far their score falls short of the most possible for the characters
+	// they have matched, the occurrences of its first character not yet examined, those shown,
+	// and the items shown.
+	std::vector<int> itemsRanked;
+	std::vector<unsigned long long> itemCharacters;
+	std::string listLowered;
+	struct Occurrence {
+		int rank;
+		int position;
+		short scorePosition;	// Score for the first character of a word matching here, less any case bonus
+		char ch;
+		char chNext;	// Searched character following or NUL at the end
+	};
+	std::vector<Occurrence> occurrences;
+	std::vector<size_t> occurrenceStarts;	// Start of each class in each character's group
+	std::vector<int> scoreFollowingMost;
+	bool occurrencesIgnoreCase;
+	std::string wordFiltered;
+	struct Candidate {
+		int rank;
+		int score;
+		int position;	// Just after the last character matched
+		short matched;	// Characters of the word matched
+		char chNext;	// Searched character at position or NUL at the end
+	};
+	std::vector<std::vector<Candidate>> candidates;
+	struct OccurrenceRange {
+		size_t start;
+		size_t end;
+		int score;
+		size_t shortfall;
+		bool split;	// Occurrences followed by chSplit became candidates
+		char chSplit;
+	};
+	std::vector<OccurrenceRange> occurrencesWaiting;
+	std::vector<Candidate> candidatesKept;
+	std::vector<Candidate> candidatesBest;
+	std::vector<int> itemsShown;
+	bool filtered;
+	void IndexSubsequence();
+	void SelectSubsequence(const char *word);
+
 public:
 
 	bool ignoreCase;
@@ -40,6 +101,10 @@ public:
 	 *  SC_ORDER_CUSTOM:      Handle non-alphabetical entries; start up performance cost for generating a sorted lookup table
 	 */
 	int autoSort;
+	/** SC_AUTOCMATCH_PREFIX:      Select the first item that starts with the entered text<br />
+	 *  SC_AUTOCMATCH_SUBSEQUENCE: Show only items containing the entered characters in order, best first
+	 */
+	int match;
 
 	AutoComplete();
 	~AutoComplete();
@@ -0,0 +1,560 @@
+// Scintilla source code edit control
+/** @file BackgroundStyler.cxx
+ ** Run lexers on worker threads against snapshots of parts of a document.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <forward_list>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <future>
+
+#include "Platform.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include "CharacterCategory.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "BackgroundStyler.h"
+#include "UniConversion.h"
+#include "ElapsedPeriod.h"
+
+using namespace Scintilla;
+
+StyleSnapshot::StyleSnapshot(Document *pdoc, Sci::Position start, Sci::Position end, Sci::Position lookAround) :
+	codePage(pdoc->dbcsCodePage), tabInChars(pdoc->tabInChars),
+	length(pdoc->Length()), linesTotal(pdoc->LinesTotal()),
+	startStyling(start), endStyled(start), styledEnd(start), outside(false), currentIndicator(0) {
+	for (int ch = 0; ch < 256; ch++) {
+		leadByte[ch] = pdoc->IsDBCSLeadByteNoExcept(static_cast<char>(ch));
+	}
+	lineFirst = pdoc->SciLineFromPosition(std::max<Sci::Position>(start - lookAround, 0));
+	const Sci::Line lineLast = pdoc->SciLineFromPosition(std::min(end + lookAround, length)) + 1;
+	windowStart = pdoc->LineStart(lineFirst);
+	windowEnd = pdoc->LineStart(lineLast);
+	text.resize(windowEnd - windowStart);
+	pdoc->GetCharRange(&text[0], windowStart, windowEnd - windowStart);
+	styles.resize(windowEnd - windowStart);
+	pdoc->GetStyleRange(reinterpret_cast<unsigned char *>(styles.data()), windowStart, windowEnd - windowStart);
+	for (Sci::Line line = lineFirst; line <= lineLast; line++) {
+		lineStarts.push_back(pdoc->LineStart(line));
+		lineStates.push_back(pdoc->GetLineState(line));
+		levels.push_back(pdoc->GetLevel(line));
+	}
+	lineStatesChanged.resize(lineStates.size());
+	levelsChanged.resize(levels.size());
+}
+
+StyleSnapshot::~StyleSnapshot() {
+}
+
+// Whether lexing from position, which is a line start, would start from the same style and
+// line state in the document as it did in the snapshot.
+bool StyleSnapshot::SameStateAt(const Document *pdoc, Sci::Position position) const {
+	const Sci::Line line = pdoc->SciLineFromPosition(position);
+	return (StyleAt(position - 1) == pdoc->StyleAt(position - 1)) &&
+		(GetLineState(line - 1) == pdoc->GetLineState(line - 1));
+}
+
+void StyleSnapshot::CommitStyles(Document *pdoc, Sci::Position start, Sci::Position end, Sci::Position lengthChunk) {
+	// Publish styles in chunks so each chunk is a separate change notification.
+	const Sci::Position endCommit = std::min(end, styledEnd);
+	pdoc->StartStyling(start);
+	for (Sci::Position pos = start; pos < endCommit;) {
+		const Sci::Position lengthSegment = std::min(lengthChunk, endCommit - pos);
+		pdoc->SetStyles(lengthSegment, styles.data() + pos - windowStart);
+		pos += lengthSegment;
+	}
+}
+
+void StyleSnapshot::CommitLines(Document *pdoc, Sci::Line lineFrom, Sci::Line lineTo) {
+	const size_t first = std::clamp<Sci::Line>(lineFrom - lineFirst, 0, lineStates.size());
+	const size_t last = std::clamp<Sci::Line>(lineTo - lineFirst, 0, lineStates.size());
+	for (size_t i = first; i < last; i++) {
+		if (lineStatesChanged[i]) {
+			pdoc->SetLineState(lineFirst + i, lineStates[i]);
+		}
+		if (levelsChanged[i]) {
+			pdoc->SetLevel(lineFirst + i, levels[i]);
+		}
+	}
+}
+
+void StyleSnapshot::CommitCalls(Document *pdoc) {
+	for (const DecorationFill &fill : decorationFills) {
+		pdoc->DecorationSetCurrentIndicator(fill.indicator);
+		pdoc->DecorationFillRange(fill.position, fill.value, fill.fillLength);
+	}
+	for (const LexerStateChange &change : lexerStateChanges) {
+		pdoc->ChangeLexerState(change.start, change.end);
+	}
+	for (const int status : errorStatuses) {
+		pdoc->SetErrorStatus(status);
+	}
+}
+
+void StyleSnapshot::Commit(Document *pdoc, Sci::Position start, Sci::Position lengthChunk) {
+	CommitStyles(pdoc, start, styledEnd, lengthChunk);
+	CommitLines(pdoc, lineFirst, lineFirst + lineStates.size());
+	CommitCalls(pdoc);
+}
+
+int SCI_METHOD StyleSnapshot::Version() const {
+	return dvRangePointer;
+}
+
+void SCI_METHOD StyleSnapshot::SetErrorStatus(int status) {
+	errorStatuses.push_back(status);
+}
+
+Sci_Position SCI_METHOD StyleSnapshot::Length() const {
+	return length;
+}
+
+void SCI_METHOD StyleSnapshot::GetCharRange(char *buffer, Sci_Position position, Sci_Position lengthRetrieve) const {
+	for (Sci_Position i = 0; i < lengthRetrieve; i++) {
+		buffer[i] = UCharAt(position + i);
+	}
+}
+
+char SCI_METHOD StyleSnapshot::StyleAt(Sci_Position position) const {
+	if (!PositionInWindow(position))
+		return 0;
+	return styles[position - windowStart];
+}
+
+Sci_Position SCI_METHOD StyleSnapshot::LineFromPosition(Sci_Position position) const {
+	if (position >= length)
+		return linesTotal - 1;
+	PositionInWindow(position);
+	const std::vector<Sci::Position>::const_iterator it =
+		std::upper_bound(lineStarts.begin(), lineStarts.end(), position);
+	if (it == lineStarts.begin())
+		return lineFirst;
+	return lineFirst + (it - lineStarts.begin()) - 1;
+}
+
+Sci_Position SCI_METHOD StyleSnapshot::LineStart(Sci_Position line) const {
+	if (line <= 0)
+		return 0;
+	if (line >= linesTotal)
+		return length;
+	if (!LineInWindow(line))
+		return (line < lineFirst) ? windowStart : windowEnd;
+	return lineStarts[line - lineFirst];
+}
+
+int SCI_METHOD StyleSnapshot::GetLevel(Sci_Position line) const {
+	if (!LineInWindow(line))
+		return SC_FOLDLEVELBASE;
+	return levels[line - lineFirst];
+}
+
+int SCI_METHOD StyleSnapshot::SetLevel(Sci_Position line, int level) {
+	if (!LineInWindow(line))
+		return SC_FOLDLEVELBASE;
+	const int prev = levels[line - lineFirst];
+	if (prev != level) {
+		levels[line - lineFirst] = level;
+		levelsChanged[line - lineFirst] = true;
+	}
+	return prev;
+}
+
+int SCI_METHOD StyleSnapshot::GetLineState(Sci_Position line) const {
+	if (!LineInWindow(line))
+		return 0;
+	return lineStates[line - lineFirst];
+}
+
+int SCI_METHOD StyleSnapshot::SetLineState(Sci_Position line, int state) {
+	if (!LineInWindow(line))
+		return 0;
+	const int statePrevious = lineStates[line - lineFirst];
+	if (state != statePrevious) {
+		lineStates[line - lineFirst] = state;
+		lineStatesChanged[line - lineFirst] = true;
+	}
+	return statePrevious;
+}
+
+void SCI_METHOD StyleSnapshot::StartStyling(Sci_Position position) {
+	endStyled = position;
+}
+
+bool SCI_METHOD StyleSnapshot::SetStyleFor(Sci_Position lengthStyle, char style) {
+	NoteStyled(endStyled, endStyled + lengthStyle);
+	const Sci::Position first = std::max(endStyled, windowStart);
+	const Sci::Position last = std::min(endStyled + lengthStyle, windowEnd);
+	if (first < last) {
+		std::fill(styles.begin() + (first - windowStart), styles.begin() + (last - windowStart), style);
+	}
+	endStyled += lengthStyle;
+	styledEnd = std::clamp(endStyled, styledEnd, windowEnd);
+	return true;
+}
+
+bool SCI_METHOD StyleSnapshot::SetStyles(Sci_Position lengthStyles, const char *stylesSet) {
+	NoteStyled(endStyled, endStyled + lengthStyles);
+	for (Sci_Position iPos = 0; iPos < lengthStyles; iPos++, endStyled++) {
+		if ((endStyled >= windowStart) && (endStyled < windowEnd)) {
+			styles[endStyled - windowStart] = stylesSet[iPos];
+		}
+	}
+	styledEnd = std::clamp(endStyled, styledEnd, windowEnd);
+	return true;
+}
+
+void SCI_METHOD StyleSnapshot::DecorationSetCurrentIndicator(int indicator) {
+	currentIndicator = indicator;
+}
+
+void SCI_METHOD StyleSnapshot::DecorationFillRange(Sci_Position position, int value, Sci_Position fillLength) {
+	decorationFills.push_back({currentIndicator, position, value, fillLength});
+}
+
+void SCI_METHOD StyleSnapshot::ChangeLexerState(Sci_Position start, Sci_Position end) {
+	lexerStateChanges.push_back({start, end});
+}
+
+int SCI_METHOD StyleSnapshot::CodePage() const {
+	return codePage;
+}
+
+bool SCI_METHOD StyleSnapshot::IsDBCSLeadByte(char ch) const {
+	return leadByte[static_cast<unsigned char>(ch)];
+}
+
+const char * SCI_METHOD StyleSnapshot::BufferPointer() {
+	// Only a window of the document is available so there is no pointer to the whole text.
+	return nullptr;
+}
+
+int SCI_METHOD StyleSnapshot::GetLineIndentation(Sci_Position line) {
+	int indent = 0;
+	if ((line >= 0) && (line < linesTotal)) {
+		for (Sci::Position i = LineStart(line); i < windowEnd; i++) {
+			const char ch = UCharAt(i);
+			if (ch == ' ')
+				indent++;
+			else if (ch == '\t')
+				indent = ((indent / tabInChars) + 1) * tabInChars;
+			else
+				return indent;
+		}
+	}
+	return indent;
+}
+
+Sci_Position SCI_METHOD StyleSnapshot::LineEnd(Sci_Position line) const {
+	if (line >= linesTotal - 1) {
+		return LineStart(line + 1);
+	} else {
+		Sci::Position position = LineStart(line + 1);
+		if (SC_CP_UTF8 == codePage) {
+			const unsigned char bytes[] = {
+				UCharAt(position-3),
+				UCharAt(position-2),
+				UCharAt(position-1),
+			};
+			if (UTF8IsSeparator(bytes)) {
+				return position - UTF8SeparatorLength;
+			}
+			if (UTF8IsNEL(bytes+1)) {
+				return position - UTF8NELLength;
+			}
+		}
+		position--; // Back over CR or LF
+		// When line terminator is CR+LF, may need to go back one more
+		if ((position > LineStart(line)) && (UCharAt(position - 1) == '\r')) {
+			position--;
+		}
+		return position;
+	}
+}
+
+// Simpler than Document::NextPosition as lexers only move over characters they have already seen.
+Sci::Position StyleSnapshot::NextPosition(Sci::Position pos, int moveDir) const noexcept {
+	if (moveDir > 0) {
+		if (pos >= length)
+			return pos;
+		Sci_Position width = 1;
+		GetCharacterAndWidth(pos, &width);
+		return pos + width;
+	} else {
+		if (pos <= 0)
+			return pos;
+		if (SC_CP_UTF8 == codePage) {
+			Sci::Position posStart = pos - 1;
+			while ((posStart > 0) && (pos - posStart < UTF8MaxBytes) && UTF8IsTrailByte(UCharAt(posStart))) {
+				posStart--;
+			}
+			return posStart;
+		} else if (codePage) {
+			// Step forward from the line start as trail bytes may look like lead bytes.
+			Sci::Position posCheck = LineStart(LineFromPosition(pos - 1));
+			Sci::Position posPrevious = posCheck;
+			while (posCheck < pos) {
+				posPrevious = posCheck;
+				posCheck += IsDBCSLeadByte(UCharAt(posCheck)) ? 2 : 1;
+			}
+			return posPrevious;
+		}
+		return pos - 1;
+	}
+}
+
+Sci_Position SCI_METHOD StyleSnapshot::GetRelativePosition(Sci_Position positionStart, Sci_Position characterOffset) const {
+	Sci::Position pos = positionStart;
+	if (codePage) {
+		const int increment = (characterOffset > 0) ? 1 : -1;
+		while (characterOffset != 0) {
+			const Sci::Position posNext = NextPosition(pos, increment);
+			if (posNext == pos)
+				return INVALID_POSITION;
+			pos = posNext;
+			characterOffset -= increment;
+		}
+	} else {
+		pos = positionStart + characterOffset;
+		if ((pos < 0) || (pos > length))
+			return INVALID_POSITION;
+	}
+	return pos;
+}
+
+int SCI_METHOD StyleSnapshot::GetCharacterAndWidth(Sci_Position position, Sci_Position *pWidth) const {
+	int character;
+	int bytesInCharacter = 1;
+	const unsigned char leadByteCharacter = UCharAt(position);
+	if (SC_CP_UTF8 == codePage) {
+		if (UTF8IsAscii(leadByteCharacter)) {
+			character = leadByteCharacter;
+		} else {
+			const int widthCharBytes = UTF8BytesOfLead[leadByteCharacter];
+			unsigned char charBytes[UTF8MaxBytes] = {leadByteCharacter,0,0,0};
+			for (int b=1; b<widthCharBytes; b++)
+				charBytes[b] = UCharAt(position+b);
+			const int utf8status = UTF8Classify(charBytes, widthCharBytes);
+			if (utf8status & UTF8MaskInvalid) {
+				// Report as singleton surrogate values which are invalid Unicode
+				character = 0xDC80 + leadByteCharacter;
+			} else {
+				bytesInCharacter = utf8status & UTF8MaskWidth;
+				character = UnicodeFromUTF8(charBytes);
+			}
+		}
+	} else if (codePage && leadByte[leadByteCharacter]) {
+		bytesInCharacter = 2;
+		character = (leadByteCharacter << 8) | UCharAt(position+1);
+	} else {
+		character = leadByteCharacter;
+	}
+	if (pWidth) {
+		*pWidth = bytesInCharacter;
+	}
+	return character;
+}
+
+const char * SCI_METHOD StyleSnapshot::RangePointer(Sci_Position position, Sci_Position rangeLength) {
+	// Ranges extending outside the window are not available so the lexer copies them instead
+	// which is noticed by GetCharRange.
+	if ((position < windowStart) || (position + rangeLength > windowEnd))
+		return nullptr;
+	return text.data() + position - windowStart;
+}
+
+BackgroundStyler::BackgroundStyler() noexcept :
+	pli(nullptr), start(0), end(0), endStyledAtStart(0), stale(false), fallenBack(false) {
+}
+
+BackgroundStyler::~BackgroundStyler() {
+	// Must not destroy the snapshot while the worker may still be using it.
+	if (job.valid()) {
+		job.wait();
+	}
+}
+
+bool BackgroundStyler::Active() const noexcept {
+	return job.valid();
+}
+
+void BackgroundStyler::Start(Document *pdoc, LexInterface *pli_, Sci::Position start_, Sci::Position end_) {
+	// Lexers may look outside the range they are asked to style, most often back to the
+	// start of a construct, so copy this much text either side.
+	const Sci::Position lookAround = 0x10000;
+	pli = pli_;
+	start = start_;
+	end = end_;
+	endStyledAtStart = pdoc->GetEndStyled();
+	stale = false;
+	snapshot = std::make_unique<StyleSnapshot>(pdoc, start, end, lookAround);
+	const int styleStart = (start > 0) ? pdoc->StyleIndexAt(start - 1) : 0;
+	StyleSnapshot *pSnapshot = snapshot.get();
+	job = std::async(std::launch::async, [pli_, pSnapshot, start_, end_, styleStart]() {
+		ElapsedPeriod epStyling;
+		pli_->ColouriseSnapshot(pSnapshot, start_, end_, styleStart);
+		return epStyling.Duration();
+	});
+}
+
+bool BackgroundStyler::Wait(double secondsAllowed) const {
+	if (!job.valid())
+		return true;
+	return job.wait_for(std::chrono::duration<double>(secondsAllowed)) == std::future_status::ready;
+}
+
+void BackgroundStyler::Invalidate(Sci::Position pos) noexcept {
+	if (snapshot && (pos < snapshot->WindowEnd())) {
+		stale = true;
+	}
+}
+
+Sci::Line BackgroundStyler::Finish(Document *pdoc, bool commit, double &duration) {
+	if (!job.valid())
+		return 0;
+	duration = job.get();
+	Sci::Line linesStyled = 0;
+	// Discard the results if the document was changed inside the window or styled by other means.
+	if (commit && !stale && (pdoc->GetEndStyled() == endStyledAtStart) && (snapshot->StyledEnd() > start)) {
+		const Sci::Line lineStart = pdoc->SciLineFromPosition(start);
+		if (snapshot->Outside()) {
+			// The lexer reached outside the snapshot, perhaps backtracking to the start of a
+			// long construct, so its results may be wrong. Style the range directly instead
+			// and stop styling this document in the background.
+			fallenBack = true;
+			ElapsedPeriod epStyling;
+			pli->Colourise(start, end);
+			duration = epStyling.Duration();
+		} else {
+			const Sci::Position lengthChunk = 0x10000;
+			snapshot->Commit(pdoc, start, lengthChunk);
+		}
+		linesStyled = pdoc->SciLineFromPosition(pdoc->GetEndStyled()) - lineStart;
+	}
+	snapshot.reset();
+	return linesStyled;
+}
+
+namespace {
+
+struct ReleaseLexer {
+	void operator()(ILexerCheckpoints *lexer) const noexcept {
+		lexer->Release();
+	}
+};
+
+// A range styled by a fork of the lexer against a snapshot.
+// The job is declared last so it is waited for before the fork and snapshot are destroyed.
+struct ForkedRange {
+	Sci::Position start;
+	Sci::Position end;
+	std::unique_ptr<StyleSnapshot> snapshot;
+	std::unique_ptr<ILexerCheckpoints, ReleaseLexer> fork;
+	std::future<void> job;
+};
+
+}
+
+// Style from start to end by splitting the range at line starts into one range for each thread.
+// The first range is lexed by lexer directly into the document while the others are lexed at the
+// same time by forks of lexer into snapshots, starting from whatever state the document had.
+// Each later range is then checked in order: if the document now has the same state at its start as the
+// fork started with then the fork's results are committed, otherwise lines are relexed with lexer
+// until the states agree. Fold levels accumulate over the whole document so rarely agree at range
+// starts: folding is performed afterwards by lexer over the whole range.
+// Returns false without styling when the range is too small to split or the lexer can not be forked.
+bool Scintilla::StyleInParallel(Document *pdoc, ILexerCheckpoints *lexer, Sci::Position start, Sci::Position end, int styleStart, int threads) {
+	// Smaller ranges are not worth the cost of copying and checking.
+	const Sci::Position minimumRange = 0x40000;
+	const Sci::Position lookAround = 0x10000;
+	const Sci::Position lengthChunk = 0x10000;
+	const int ranges = static_cast<int>(std::min<Sci::Position>(threads, (end - start) / minimumRange));
+	if (ranges < 2)
+		return false;
+
+	std::vector<ForkedRange> forked;
+	for (int range = 1; range < ranges; range++) {
+		const Sci::Position position = start + (end - start) * range / ranges;
+		const Sci::Position rangeStart = pdoc->LineStart(pdoc->SciLineFromPosition(position));
+		if (rangeStart > (forked.empty() ? start : forked.back().start)) {
+			ILexerCheckpoints *fork = lexer->Fork();
+			if (!fork)
+				return false;
+			forked.push_back(ForkedRange{ rangeStart, end, nullptr,
+				std::unique_ptr<ILexerCheckpoints, ReleaseLexer>(fork), std::future<void>() });
+		}
+	}
+	if (forked.empty())
+		return false;
+	for (size_t i = 0; i + 1 < forked.size(); i++) {
+		forked[i].end = forked[i + 1].start;
+	}
+
+	// Snapshots must all be taken before the document is styled.
+	for (ForkedRange &fr : forked) {
+		fr.snapshot = std::make_unique<StyleSnapshot>(pdoc, fr.start, fr.end, lookAround);
+	}
+	for (ForkedRange &fr : forked) {
+		const int styleFork = pdoc->StyleIndexAt(fr.start - 1);
+		ILexerCheckpoints *fork = fr.fork.get();
+		StyleSnapshot *pSnapshot = fr.snapshot.get();
+		const Sci::Position startFork = fr.start;
+		const Sci::Position lengthFork = fr.end - fr.start;
+		fr.job = std::async(std::launch::async, [fork, pSnapshot, startFork, lengthFork, styleFork]() {
+			fork->Lex(startFork, lengthFork, styleFork, pSnapshot);
+		});
+	}
+
+	lexer->Lex(start, forked.front().start - start, styleStart, pdoc);
+
+	for (size_t i = 0; i < forked.size(); i++) {
+		ForkedRange &fr = forked[i];
+		fr.job.get();
+		const bool last = i == forked.size() - 1;
+		const Sci::Line lineEnd = last ? pdoc->LinesTotal() : pdoc->SciLineFromPosition(fr.end);
+		// Restyle in growing steps so a fork that started in the wrong state is
+		// abandoned quickly when the states never agree.
+		Sci::Line linesRepair = 100;
+		Sci::Position position = fr.start;
+		while (position < fr.end) {
+			const Sci::Line line = pdoc->SciLineFromPosition(position);
+			if ((fr.snapshot->StyledEnd() >= fr.end) && !fr.snapshot->Outside() &&
+				fr.snapshot->SameStateAt(pdoc, position) &&
+				lexer->SameCheckpoint(fr.fork.get(), line)) {
+				fr.snapshot->CommitStyles(pdoc, position, fr.end, lengthChunk);
+				fr.snapshot->CommitLines(pdoc, line, lineEnd);
+				fr.snapshot->CommitCalls(pdoc);
+				lexer->Join(fr.fork.get(), line, pdoc->SciLineFromPosition(fr.end - 1) + 1);
+				break;
+			}
+			const Sci::Position next = std::min(pdoc->LineStart(line + linesRepair), fr.end);
+			lexer->Lex(position, next - position, pdoc->StyleIndexAt(position - 1), pdoc);
+			position = next;
+			linesRepair *= 2;
+		}
+	}
+
+	lexer->Fold(start, end - start, styleStart, pdoc);
+	return true;
+}
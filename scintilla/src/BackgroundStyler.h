@@ -0,0 +1,173 @@
+// Scintilla source code edit control
+/** @file BackgroundStyler.h
+ ** Run lexers on worker threads against snapshots of parts of a document.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef BACKGROUNDSTYLER_H
+#define BACKGROUNDSTYLER_H
+
+namespace Scintilla {
+
+/**
+ * An immutable copy of the text, styles, line states and fold levels around a range of a document.
+ * A lexer can run against it on another thread while the document continues to be edited.
+ * Writes by the lexer are kept and then replayed onto the document by Commit.
+ * Lexers see only the window copied so positions and lines outside it read as empty.
+ * Reading those or styling before the start makes the results differ from styling
+ * the document directly so this is remembered and reported by Outside.
+ */
+class StyleSnapshot : public IDocumentRangePointer {
+	struct DecorationFill {
+		int indicator;
+		Sci::Position position;
+		int value;
+		Sci::Position fillLength;
+	};
+	struct LexerStateChange {
+		Sci::Position start;
+		Sci::Position end;
+	};
+
+	int codePage;
+	int tabInChars;
+	bool leadByte[256];
+	Sci::Position length;
+	Sci::Line linesTotal;
+	Sci::Position windowStart;
+	Sci::Position windowEnd;
+	Sci::Line lineFirst;
+	std::string text;
+	std::vector<char> styles;
+	// lineStarts, lineStates and levels cover lines from lineFirst to the line starting at windowEnd.
+	std::vector<Sci::Position> lineStarts;
+	std::vector<int> lineStates;
+	std::vector<int> levels;
+	std::vector<bool> lineStatesChanged;
+	std::vector<bool> levelsChanged;
+
+	Sci::Position startStyling;
+	Sci::Position endStyled;
+	Sci::Position styledEnd;
+	mutable bool outside;
+	int currentIndicator;
+	std::vector<DecorationFill> decorationFills;
+	std::vector<LexerStateChange> lexerStateChanges;
+	std::vector<int> errorStatuses;
+
+	bool LineInWindow(Sci_Position line) const noexcept {
+		if ((line >= lineFirst) && (line < lineFirst + static_cast<Sci::Line>(lineStarts.size())))
+			return true;
+		if ((line >= 0) && (line < linesTotal))
+			outside = true;
+		return false;
+	}
+	bool PositionInWindow(Sci::Position position) const noexcept {
+		if ((position >= windowStart) && (position < windowEnd))
+			return true;
+		if ((position >= 0) && (position < length))
+			outside = true;
+		return false;
+	}
+	unsigned char UCharAt(Sci::Position position) const noexcept {
+		if (!PositionInWindow(position))
+			return 0;
+		return text[position - windowStart];
+	}
+	void NoteStyled(Sci::Position first, Sci::Position last) noexcept {
+		if ((first < startStyling) || (last > windowEnd))
+			outside = true;
+	}
+	Sci::Position NextPosition(Sci::Position pos, int moveDir) const noexcept;
+public:
+	StyleSnapshot(Document *pdoc, Sci::Position start, Sci::Position end, Sci::Position lookAround);
+	// Deleted so StyleSnapshot objects can not be copied.
+	StyleSnapshot(const StyleSnapshot &) = delete;
+	StyleSnapshot(StyleSnapshot &&) = delete;
+	StyleSnapshot &operator=(const StyleSnapshot &) = delete;
+	StyleSnapshot &operator=(StyleSnapshot &&) = delete;
+	virtual ~StyleSnapshot();
+
+	Sci::Position WindowEnd() const noexcept {
+		return windowEnd;
+	}
+	Sci::Position StyledEnd() const noexcept {
+		return styledEnd;
+	}
+	bool Outside() const noexcept {
+		return outside;
+	}
+	bool SameStateAt(const Document *pdoc, Sci::Position position) const;
+	void CommitStyles(Document *pdoc, Sci::Position start, Sci::Position end, Sci::Position lengthChunk);
+	void CommitLines(Document *pdoc, Sci::Line lineFrom, Sci::Line lineTo);
+	void CommitCalls(Document *pdoc);
+	void Commit(Document *pdoc, Sci::Position start, Sci::Position lengthChunk);
+
+	int SCI_METHOD Version() const override;
+	void SCI_METHOD SetErrorStatus(int status) override;
+	Sci_Position SCI_METHOD Length() const override;
+	void SCI_METHOD GetCharRange(char *buffer, Sci_Position position, Sci_Position lengthRetrieve) const override;
+	char SCI_METHOD StyleAt(Sci_Position position) const override;
+	Sci_Position SCI_METHOD LineFromPosition(Sci_Position position) const override;
+	Sci_Position SCI_METHOD LineStart(Sci_Position line) const override;
+	int SCI_METHOD GetLevel(Sci_Position line) const override;
+	int SCI_METHOD SetLevel(Sci_Position line, int level) override;
+	int SCI_METHOD GetLineState(Sci_Position line) const override;
+	int SCI_METHOD SetLineState(Sci_Position line, int state) override;
+	void SCI_METHOD StartStyling(Sci_Position position) override;
+	bool SCI_METHOD SetStyleFor(Sci_Position length, char style) override;
+	bool SCI_METHOD SetStyles(Sci_Position length, const char *styles) override;
+	void SCI_METHOD DecorationSetCurrentIndicator(int indicator) override;
+	void SCI_METHOD DecorationFillRange(Sci_Position position, int value, Sci_Position fillLength) override;
+	void SCI_METHOD ChangeLexerState(Sci_Position start, Sci_Position end) override;
+	int SCI_METHOD CodePage() const override;
+	bool SCI_METHOD IsDBCSLeadByte(char ch) const override;
+	const char * SCI_METHOD BufferPointer() override;
+	int SCI_METHOD GetLineIndentation(Sci_Position line) override;
+	Sci_Position SCI_METHOD LineEnd(Sci_Position line) const override;
+	Sci_Position SCI_METHOD GetRelativePosition(Sci_Position positionStart, Sci_Position characterOffset) const override;
+	int SCI_METHOD GetCharacterAndWidth(Sci_Position position, Sci_Position *pWidth) const override;
+	const char * SCI_METHOD RangePointer(Sci_Position position, Sci_Position rangeLength) override;
+};
+
+/**
+ * Styles one range of a document at a time on a worker thread.
+ * The results are only applied to the document by Finish if no modification
+ * has touched the snapshot window since the job started.
+ */
+class BackgroundStyler {
+	std::unique_ptr<StyleSnapshot> snapshot;
+	std::future<double> job;
+	LexInterface *pli;
+	Sci::Position start;
+	Sci::Position end;
+	Sci::Position endStyledAtStart;
+	bool stale;
+	bool fallenBack;
+public:
+	BackgroundStyler() noexcept;
+	// Deleted so BackgroundStyler objects can not be copied.
+	BackgroundStyler(const BackgroundStyler &) = delete;
+	BackgroundStyler(BackgroundStyler &&) = delete;
+	BackgroundStyler &operator=(const BackgroundStyler &) = delete;
+	BackgroundStyler &operator=(BackgroundStyler &&) = delete;
+	~BackgroundStyler();
+
+	bool Active() const noexcept;
+	// After the lexer has looked outside a snapshot all styling should be synchronous.
+	bool FallenBack() const noexcept {
+		return fallenBack;
+	}
+	void Start(Document *pdoc, LexInterface *pli_, Sci::Position start_, Sci::Position end_);
+	bool Wait(double secondsAllowed) const;
+	void Invalidate(Sci::Position pos) noexcept;
+	// Returns number of lines styled for adjusting line duration or 0 if nothing committed.
+	Sci::Line Finish(Document *pdoc, bool commit, double &duration);
+};
+
+bool StyleInParallel(Document *pdoc, ILexerCheckpoints *lexer, Sci::Position start, Sci::Position end, int styleStart, int threads);
+
+}
+
+#endif
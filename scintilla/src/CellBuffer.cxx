@@ -7,6 +7,7 @@
 
 #include <cstddef>
 #include <cstdlib>
+#include <cstdint>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
@@ -25,6 +26,7 @@
 #include "Position.h"
 #include "SplitVector.h"
 #include "Partitioning.h"
+#include "ChunkVector.h"
 #include "CellBuffer.h"
 #include "UniConversion.h"
 
@@ -65,6 +67,7 @@ public:
 	virtual void SetPerLine(PerLine *pl) = 0;
 	virtual void InsertText(Sci::Line line, Sci::Position delta) = 0;
 	virtual void InsertLine(Sci::Line line, Sci::Position position, bool lineStart) = 0;
+	virtual void InsertLines(Sci::Line line, const Sci::Position *positions, size_t lines, bool lineStart) = 0;
 	virtual void SetLineStart(Sci::Line line, Sci::Position position) noexcept = 0;
 	virtual void RemoveLine(Sci::Line line) = 0;
 	virtual Sci::Line Lines() const noexcept = 0;
@@ -111,6 +114,15 @@ public:
 		}
 		return refCount == 1;
 	}
+	void InsertLines(Sci::Line line, size_t lines) {
+		// Produce an ascending sequence that will be filled in with correct widths later
+		std::vector<POS> positions(lines);
+		POS position = starts.PositionFromPartition(static_cast<POS>(line) - 1);
+		for (POS &pos : positions) {
+			pos = ++position;
+		}
+		starts.InsertPartitions(static_cast<POS>(line), positions.data(), lines);
+	}
 	bool Release() {
 		if (refCount == 1) {
 			starts.DeleteAll();
@@ -179,6 +191,22 @@ public:
 			perLine->InsertLine(line);
 		}
 	}
+	void InsertLines(Sci::Line line, const Sci::Position *positions, size_t lines, bool lineStart) override {
+		const POS lineAsPos = static_cast<POS>(line);
+		std::vector<POS> positionsAsPos(positions, positions + lines);
+		starts.InsertPartitions(lineAsPos, positionsAsPos.data(), lines);
+		if (startsUTF32.Active()) {
+			startsUTF32.InsertLines(line, lines);
+		}
+		if (startsUTF16.Active()) {
+			startsUTF16.InsertLines(line, lines);
+		}
+		if (perLine) {
+			if ((line > 0) && lineStart)
+				line--;
+			perLine->InsertLines(line, static_cast<Sci::Line>(lines));
+		}
+	}
 	void SetLineStart(Sci::Line line, Sci::Position position) noexcept override {
 		starts.SetPartitionStartPosition(static_cast<POS>(line), static_cast<POS>(position));
 	}
@@ -270,31 +298,78 @@ public:
 	}
 };
 
-Action::Action() {
+Action::Action() noexcept {
 	at = startAction;
 	position = 0;
+	data = nullptr;
 	lenData = 0;
 	mayCoalesce = false;
 }
 
-Action::~Action() {
-}
-
-void Action::Create(actionType at_, Sci::Position position_, const char *data_, Sci::Position lenData_, bool mayCoalesce_) {
-	data = nullptr;
-	position = position_;
+Action::Action(actionType at_, Sci::Position position_, const char *data_, Sci::Position lenData_, bool mayCoalesce_) noexcept {
 	at = at_;
-	if (lenData_) {
-		data = std::make_unique<char[]>(lenData_);
-		memcpy(&data[0], data_, lenData_);
-	}
+	position = position_;
+	data = data_;
 	lenData = lenData_;
 	mayCoalesce = mayCoalesce_;
 }
 
-void Action::Clear() {
-	data = nullptr;
-	lenData = 0;
+UndoArena::UndoArena() noexcept : begin(0), end(0) {
+}
+
+UndoArena::~UndoArena() {
+}
+
+size_t UndoArena::Append(const char *s, size_t length) {
+	if (blocks.empty() || (blocks.back().start + blocks.back().size - end < length)) {
+		// Text of one action is always contiguous so start a new block, replacing an empty
+		// last block as two blocks may not start at the same offset.
+		if (!blocks.empty() && (blocks.back().start == end)) {
+			blocks.pop_back();
+		}
+		const size_t sizeBlock = std::max<size_t>(blockSize, length);
+		blocks.push_back({std::make_unique<char[]>(sizeBlock), end, sizeBlock});
+	}
+	const size_t offset = end;
+	memcpy(&blocks.back().data[offset - blocks.back().start], s, length);
+	end += length;
+	return offset;
+}
+
+const char *UndoArena::Pointer(size_t offset) const noexcept {
+	// Most accesses are near the end so check the last block before searching
+	if (blocks.empty()) {
+		return nullptr;
+	}
+	if (offset >= blocks.back().start) {
+		return &blocks.back().data[offset - blocks.back().start];
+	}
+	const auto it = std::upper_bound(blocks.cbegin(), blocks.cend(), offset,
+		[](size_t position, const Block &block) noexcept { return position < block.start; }) - 1;
+	return &it->data[offset - it->start];
+}
+
+void UndoArena::Truncate(size_t position) noexcept {
+	// Blocks starting after position are freed but the block containing position is kept for reuse
+	while ((blocks.size() > 1) && (blocks.back().start > position)) {
+		blocks.pop_back();
+	}
+	end = position;
+}
+
+void UndoArena::Discard(size_t position) noexcept {
+	size_t blocksBefore = 0;
+	while ((blocksBefore + 1 < blocks.size()) && (blocks[blocksBefore + 1].start <= position)) {
+		blocksBefore++;
+	}
+	blocks.erase(blocks.begin(), blocks.begin() + blocksBefore);
+	begin = position;
+}
+
+void UndoArena::Clear() noexcept {
+	blocks.clear();
+	begin = 0;
+	end = 0;
 }
 
 // The undo history stores a sequence of user operations that represent the user's view of the
@@ -314,6 +389,10 @@ void Action::Clear() {
 // operation. If there is no outstanding BeginUndoAction call then a new operation is started
 // unless it looks as if the new action is caused by the user typing or deleting a stream of text.
 // Sequences that look like typing or deletion are coalesced into a single user operation.
+// The text of each action follows the text of the previous action in the arena so writing an
+// action at some index discards the text of that action and all later actions.
+// When a memory limit is set, complete user operations are dropped from the start of the
+// history once the limit is exceeded.
 
 UndoHistory::UndoHistory() {
 
@@ -323,8 +402,10 @@ UndoHistory::UndoHistory() {
 	undoSequenceDepth = 0;
 	savePoint = 0;
 	tentativePoint = -1;
+	memoryLimit = 0;
+	memoryCheck = 0;
 
-	actions[currentAction].Create(startAction);
+	Record(currentAction, startAction);
 }
 
 UndoHistory::~UndoHistory() {
@@ -339,6 +420,69 @@ void UndoHistory::EnsureUndoRoom() {
 	}
 }
 
+void UndoHistory::Record(int index, actionType at, Sci::Position position, const char *data, Sci::Position lengthData, bool mayCoalesce) {
+	if (index > 0) {
+		arena.Truncate(actions[index - 1].offset + actions[index - 1].lenData);
+	} else {
+		arena.Truncate(arena.Begin());
+	}
+	ActionRecord &record = actions[index];
+	record.position = position;
+	record.lenData = lengthData;
+	record.offset = lengthData ? arena.Append(data, lengthData) : arena.End();
+	record.at = at;
+	record.mayCoalesce = mayCoalesce;
+}
+
+Action UndoHistory::ActionAt(int index) const noexcept {
+	const ActionRecord &record = actions[index];
+	return Action(record.at, record.position,
+		record.lenData ? arena.Pointer(record.offset) : nullptr, record.lenData, record.mayCoalesce);
+}
+
+void UndoHistory::LimitMemory() {
+	const Sci::Position memoryUse = MemoryUse();
+	if ((memoryLimit <= 0) || (memoryUse <= memoryCheck)) {
+		return;
+	}
+	// Drop until well under the limit so the cost of moving the remaining actions is spread over
+	// many appends. Only complete operations before the current action may be dropped, keeping
+	// any tentative start reachable.
+	const Sci::Position memoryTarget = memoryLimit - memoryLimit / 8;
+	const int actionLast = (tentativePoint >= 0) ? std::min(tentativePoint, currentAction - 1) : currentAction - 1;
+	const size_t endData = actions[maxAction].offset + actions[maxAction].lenData;
+	int dropTo = 0;
+	for (int act = 1; act <= actionLast; act++) {
+		if (actions[act].at == startAction) {
+			dropTo = act;
+			const Sci::Position memoryAfter = static_cast<Sci::Position>(
+				endData - actions[act].offset + sizeof(ActionRecord) * (maxAction - act + 1));
+			if (memoryAfter <= memoryTarget) {
+				break;
+			}
+		}
+	}
+	if (dropTo > 0) {
+		// actions[0] remains as the start action and takes over the text position of actions[dropTo]
+		actions[0].offset = actions[dropTo].offset;
+		actions.erase(actions.begin() + 1, actions.begin() + dropTo + 1);
+		arena.Discard(actions[0].offset);
+		maxAction -= dropTo;
+		currentAction -= dropTo;
+		if (tentativePoint >= 0) {
+			tentativePoint -= dropTo;
+		}
+		if (savePoint >= dropTo) {
+			savePoint -= dropTo;
+		} else {
+			// Can no longer reach the save point by undoing
+			savePoint = -1;
+		}
+	}
+	// When not enough could be dropped, wait for more growth before scanning again
+	memoryCheck = std::max(memoryLimit, MemoryUse() + memoryLimit / 8);
+}
+
 const char *UndoHistory::AppendAction(actionType at, Sci::Position position, const char *data, Sci::Position lengthData,
 	bool &startSequence, bool mayCoalesce) {
 	EnsureUndoRoom();
@@ -353,7 +497,7 @@ const char *UndoHistory::AppendAction(actionType at, Sci::Position position, con
 		if (0 == undoSequenceDepth) {
 			// Top level actions may not always be coalesced
 			int targetAct = -1;
-			const Action *actPrevious = &(actions[currentAction + targetAct]);
+			const ActionRecord *actPrevious = &(actions[currentAction + targetAct]);
 			// Container actions may forward the coalesce state of Scintilla Actions.
 			while ((actPrevious->at == containerAction) && actPrevious->mayCoalesce) {
 				targetAct--;
@@ -403,12 +547,13 @@ const char *UndoHistory::AppendAction(actionType at, Sci::Position position, con
 		currentAction++;
 	}
 	startSequence = oldCurrentAction != currentAction;
-	const int actionWithData = currentAction;
-	actions[currentAction].Create(at, position, data, lengthData, mayCoalesce);
+	Record(currentAction, at, position, data, lengthData, mayCoalesce);
 	currentAction++;
-	actions[currentAction].Create(startAction);
+	Record(currentAction, startAction);
 	maxAction = currentAction;
-	return actions[actionWithData].data.get();
+	LimitMemory();
+	const ActionRecord &recordWithData = actions[currentAction - 1];
+	return recordWithData.lenData ? arena.Pointer(recordWithData.offset) : nullptr;
 }
 
 void UndoHistory::BeginUndoAction() {
@@ -416,7 +561,7 @@ void UndoHistory::BeginUndoAction() {
 	if (undoSequenceDepth == 0) {
 		if (actions[currentAction].at != startAction) {
 			currentAction++;
-			actions[currentAction].Create(startAction);
+			Record(currentAction, startAction);
 			maxAction = currentAction;
 		}
 		actions[currentAction].mayCoalesce = false;
@@ -431,7 +576,7 @@ void UndoHistory::EndUndoAction() {
 	if (0 == undoSequenceDepth) {
 		if (actions[currentAction].at != startAction) {
 			currentAction++;
-			actions[currentAction].Create(startAction);
+			Record(currentAction, startAction);
 			maxAction = currentAction;
 		}
 		actions[currentAction].mayCoalesce = false;
@@ -443,13 +588,28 @@ void UndoHistory::DropUndoSequence() {
 }
 
 void UndoHistory::DeleteUndoHistory() {
-	for (int i = 1; i < maxAction; i++)
-		actions[i].Clear();
+	arena.Clear();
 	maxAction = 0;
 	currentAction = 0;
-	actions[currentAction].Create(startAction);
+	Record(currentAction, startAction);
 	savePoint = 0;
 	tentativePoint = -1;
+	memoryCheck = memoryLimit;
+}
+
+void UndoHistory::SetMemoryLimit(Sci::Position limit) {
+	memoryLimit = std::max<Sci::Position>(limit, 0);
+	memoryCheck = memoryLimit;
+	LimitMemory();
+}
+
+Sci::Position UndoHistory::GetMemoryLimit() const noexcept {
+	return memoryLimit;
+}
+
+Sci::Position UndoHistory::MemoryUse() const noexcept {
+	const size_t endData = actions[maxAction].offset + actions[maxAction].lenData;
+	return static_cast<Sci::Position>(endData - actions[0].offset + sizeof(ActionRecord) * (maxAction + 1));
 }
 
 void UndoHistory::SetSavePoint() {
@@ -497,8 +657,8 @@ int UndoHistory::StartUndo() {
 	return currentAction - act;
 }
 
-const Action &UndoHistory::GetUndoStep() const {
-	return actions[currentAction];
+Action UndoHistory::GetUndoStep() const {
+	return ActionAt(currentAction);
 }
 
 void UndoHistory::CompletedUndoStep() {
@@ -522,16 +682,126 @@ int UndoHistory::StartRedo() {
 	return act - currentAction;
 }
 
-const Action &UndoHistory::GetRedoStep() const {
-	return actions[currentAction];
+Action UndoHistory::GetRedoStep() const {
+	return ActionAt(currentAction);
 }
 
 void UndoHistory::CompletedRedoStep() {
 	currentAction++;
 }
 
-CellBuffer::CellBuffer(bool hasStyles_, bool largeDocument_) :
-	hasStyles(hasStyles_), largeDocument(largeDocument_) {
+CellStore::CellStore(bool chunkable_) noexcept : chunkable(chunkable_) {
+}
+
+CellStore::~CellStore() {
+}
+
+// Switch from the gap buffer to chunks once the length is large enough for chunks to be faster.
+void CellStore::ChunkIfLarge(Sci::Position lengthWanted) {
+	if (chunkable && !chunked && (lengthWanted > lengthChunked)) {
+		chunked = std::make_unique<ChunkVector<char>>();
+		const Sci::Position length = gapped.Length();
+		chunked->InsertFromArray(0, gapped.BufferPointer(), 0, length);
+		gapped.DeleteAll();
+	}
+}
+
+bool CellStore::IsChunkable() const noexcept {
+	return chunkable;
+}
+
+bool CellStore::IsChunked() const noexcept {
+	return static_cast<bool>(chunked);
+}
+
+char CellStore::ValueAt(Sci::Position position) const noexcept {
+	return chunked ? chunked->ValueAt(position) : gapped.ValueAt(position);
+}
+
+void CellStore::SetValueAt(Sci::Position position, char v) noexcept {
+	if (chunked) {
+		chunked->SetValueAt(position, v);
+	} else {
+		gapped.SetValueAt(position, v);
+	}
+}
+
+bool CellStore::SetRange(Sci::Position position, Sci::Position rangeLength, char v) noexcept {
+	if (chunked) {
+		return chunked->SetRange(position, rangeLength, v);
+	}
+	bool changed = false;
+	while (rangeLength--) {
+		if (gapped.ValueAt(position) != v) {
+			gapped.SetValueAt(position, v);
+			changed = true;
+		}
+		position++;
+	}
+	return changed;
+}
+
+Sci::Position CellStore::Length() const noexcept {
+	return chunked ? chunked->Length() : gapped.Length();
+}
+
+void CellStore::ReAllocate(Sci::Position newSize) {
+	// Chunks are allocated as needed so only the gap buffer benefits from preallocation.
+	ChunkIfLarge(newSize);
+	if (!chunked) {
+		gapped.ReAllocate(newSize);
+	}
+}
+
+void CellStore::InsertValue(Sci::Position position, Sci::Position insertLength, char v) {
+	ChunkIfLarge(Length() + insertLength);
+	if (chunked) {
+		chunked->InsertValue(position, insertLength, v);
+	} else {
+		gapped.InsertValue(position, insertLength, v);
+	}
+}
+
+void CellStore::InsertFromArray(Sci::Position positionToInsert, const char s[], Sci::Position positionFrom, Sci::Position insertLength) {
+	ChunkIfLarge(Length() + insertLength);
+	if (chunked) {
+		chunked->InsertFromArray(positionToInsert, s, positionFrom, insertLength);
+	} else {
+		gapped.InsertFromArray(positionToInsert, s, positionFrom, insertLength);
+	}
+}
+
+void CellStore::DeleteRange(Sci::Position position, Sci::Position deleteLength) {
+	if (chunked) {
+		chunked->DeleteRange(position, deleteLength);
+	} else {
+		gapped.DeleteRange(position, deleteLength);
+	}
+}
+
+void CellStore::GetRange(char *buffer, Sci::Position position, Sci::Position retrieveLength) const noexcept {
+	if (chunked) {
+		chunked->GetRange(buffer, position, retrieveLength);
+	} else {
+		gapped.GetRange(buffer, position, retrieveLength);
+	}
+}
+
+char *CellStore::BufferPointer() {
+	return chunked ? chunked->BufferPointer() : gapped.BufferPointer();
+}
+
+char *CellStore::RangePointer(Sci::Position position, Sci::Position rangeLength) {
+	return chunked ? chunked->RangePointer(position, rangeLength) : gapped.RangePointer(position, rangeLength);
+}
+
+Sci::Position CellStore::GapPosition() const noexcept {
+	return chunked ? chunked->GapPosition() : gapped.GapPosition();
+}
+
+CellBuffer::CellBuffer(bool hasStyles_, bool largeDocument_, bool chunkedDocument_) :
+	hasStyles(hasStyles_), largeDocument(largeDocument_),
+	substance(chunkedDocument_), style(chunkedDocument_ && hasStyles_) {
 	readOnly = false;
 	utf8Substance = false;
 	utf8LineEnds = 0;
@@ -632,18 +902,9 @@ bool CellBuffer::SetStyleFor(Sci::Position position, Sci::Position lengthStyle,
 	if (!hasStyles) {
 		return false;
 	}
-	bool changed = false;
 	PLATFORM_ASSERT(lengthStyle == 0 ||
 		(lengthStyle > 0 && lengthStyle + position <= style.Length()));
-	while (lengthStyle--) {
-		const char curVal = style.ValueAt(position);
-		if (curVal != styleValue) {
-			style.SetValueAt(position, styleValue);
-			changed = true;
-		}
-		position++;
-	}
-	return changed;
+	return style.SetRange(position, lengthStyle, styleValue);
 }
 
 // The char* returned is to an allocation owned by the undo history
@@ -656,6 +917,13 @@ const char *CellBuffer::DeleteChars(Sci::Position position, Sci::Position delete
 			// Save into the undo/redo stack, but only the characters - not the formatting
 			// The gap would be moved to position anyway for the deletion so this doesn't cost extra
 			data = substance.RangePointer(position, deleteLength);
+			std::string copied;
+			if (!data) {
+				// Chunked storage only provides pointers to ranges within one chunk
+				copied.resize(deleteLength);
+				substance.GetRange(&copied[0], position, deleteLength);
+				data = copied.c_str();
+			}
 			data = uh.AppendAction(removeAction, position, data, deleteLength, startSequence);
 		}
 
@@ -768,6 +1036,14 @@ bool CellBuffer::IsLarge() const {
 	return largeDocument;
 }
 
+bool CellBuffer::IsChunkable() const noexcept {
+	return substance.IsChunkable();
+}
+
+bool CellBuffer::IsChunked() const noexcept {
+	return substance.IsChunked();
+}
+
 bool CellBuffer::HasStyles() const {
 	return hasStyles;
 }
@@ -847,39 +1123,132 @@ bool CellBuffer::UTF8IsCharacterBoundary(Sci::Position position) const {
 	return true;
 }
 
-void CellBuffer::ResetLineEnds() {
-	// Reinitialize line data -- too much work to preserve
-	plv->Init();
+namespace {
 
-	const Sci::Position position = 0;
-	const Sci::Position length = Length();
-	Sci::Line lineInsert = 1;
-	const bool atLineStart = true;
-	plv->InsertText(lineInsert-1, length);
-	unsigned char chBeforePrev = 0;
-	unsigned char chPrev = 0;
-	for (Sci::Position i = 0; i < length; i++) {
-		const unsigned char ch = substance.ValueAt(position + i);
+// Line starts found in inserted text are added to the line vector in batches of this size.
+constexpr size_t lineStartsBatch = 0x10000;
+
+// CR and LF, and with Unicode line ends, the non-ASCII bytes that make up NEL, LS, and PS.
+constexpr bool MayBeLineEndByte(unsigned char ch, bool utf8LineEnds) noexcept {
+	return (ch == '\r') || (ch == '\n') || (utf8LineEnds && (ch >= 0x80));
+}
+
+// Set the high bit of each zero byte in word. Bytes above a zero byte may also be marked.
+constexpr uint64_t MarkZeroBytes(uint64_t word) noexcept {
+	constexpr uint64_t lowBits = 0x0101010101010101ULL;
+	constexpr uint64_t highBits = 0x8080808080808080ULL;
+	return (word - lowBits) & ~word & highBits;
+}
+
+// Return the position of the first byte at or after start that may be part of a line end
+// or length if there is none.
+// Text is examined 8 bytes at a time so lines of ASCII text are quickly skipped.
+Sci::Position FindLineEndByte(const char *s, Sci::Position start, Sci::Position length, bool utf8LineEnds) noexcept {
+	constexpr Sci::Position wordLength = sizeof(uint64_t);
+	constexpr uint64_t allCR = 0x0D0D0D0D0D0D0D0DULL;
+	constexpr uint64_t allLF = 0x0A0A0A0A0A0A0A0AULL;
+	constexpr uint64_t highBits = 0x8080808080808080ULL;
+	Sci::Position i = start;
+	while (i < length) {
+		while (i + wordLength <= length) {
+			uint64_t word;
+			memcpy(&word, s + i, wordLength);
+			const uint64_t nonASCII = utf8LineEnds ? (word & highBits) : 0;
+			if (MarkZeroBytes(word ^ allCR) | MarkZeroBytes(word ^ allLF) | nonASCII)
+				break;
+			i += wordLength;
+		}
+		// Examine the bytes of the marked word or the bytes at the end
+		const Sci::Position end = std::min(i + wordLength, length);
+		for (; i < end; i++) {
+			if (MayBeLineEndByte(s[i], utf8LineEnds))
+				return i;
+		}
+	}
+	return length;
+}
+
+}
+
+// Add lines for the line ends in text s inserted at position, starting at line lineInsert.
+// chBeforePrev and chPrev are the 2 bytes before s and are updated to be the last 2 bytes of s.
+// Returns the number of lines added and sets lineEndFound if s contains any line end bytes.
+Sci::Line CellBuffer::InsertLineEnds(Sci::Position position, const char *s, Sci::Position insertLength,
+	Sci::Line lineInsert, bool atLineStart, unsigned char &chBeforePrev, unsigned char &chPrev, bool &lineEndFound) {
+	const Sci::Line lineFirst = lineInsert;
+	std::vector<Sci::Position> lineStarts;
+	Sci::Position i = 0;
+	while (i < insertLength) {
+		const Sci::Position next = FindLineEndByte(s, i, insertLength, utf8LineEnds);
+		if (next > i) {
+			chBeforePrev = (next - i >= 2) ? s[next - 2] : chPrev;
+			chPrev = s[next - 1];
+			i = next;
+			if (i >= insertLength)
+				break;
+		}
+		const unsigned char ch = s[i];
 		if (ch == '\r') {
-			InsertLine(lineInsert, (position + i) + 1, atLineStart);
-			lineInsert++;
+			lineStarts.push_back((position + i) + 1);
+			lineEndFound = true;
 		} else if (ch == '\n') {
 			if (chPrev == '\r') {
 				// Patch up what was end of line
-				plv->SetLineStart(lineInsert - 1, (position + i) + 1);
+				if (lineStarts.empty()) {
+					plv->SetLineStart(lineInsert - 1, (position + i) + 1);
+				} else {
+					lineStarts.back() = (position + i) + 1;
+				}
 			} else {
-				InsertLine(lineInsert, (position + i) + 1, atLineStart);
-				lineInsert++;
+				lineStarts.push_back((position + i) + 1);
 			}
-		} else if (utf8LineEnds) {
+			lineEndFound = true;
+		} else {
 			const unsigned char back3[3] = {chBeforePrev, chPrev, ch};
 			if (UTF8IsSeparator(back3) || UTF8IsNEL(back3+1)) {
-				InsertLine(lineInsert, (position + i) + 1, atLineStart);
-				lineInsert++;
+				lineStarts.push_back((position + i) + 1);
+				lineEndFound = true;
 			}
 		}
 		chBeforePrev = chPrev;
 		chPrev = ch;
+		i++;
+		if (lineStarts.size() >= lineStartsBatch) {
+			plv->InsertLines(lineInsert, lineStarts.data(), lineStarts.size(), atLineStart);
+			lineInsert += lineStarts.size();
+			lineStarts.clear();
+		}
+	}
+	if (!lineStarts.empty()) {
+		plv->InsertLines(lineInsert, lineStarts.data(), lineStarts.size(), atLineStart);
+		lineInsert += lineStarts.size();
+	}
+	return lineInsert - lineFirst;
+}
+
+void CellBuffer::ResetLineEnds() {
+	// Reinitialize line data -- too much work to preserve
+	plv->Init();
+
+	const Sci::Position length = Length();
+	Sci::Line lineInsert = 1;
+	plv->InsertText(lineInsert-1, length);
+	unsigned char chBeforePrev = 0;
+	unsigned char chPrev = 0;
+	bool lineEndFound = false;
+	// Examine the text in blocks, copied when chunked storage is not contiguous
+	constexpr Sci::Position blockLength = 0x100000;
+	std::vector<char> block;
+	for (Sci::Position position = 0; position < length; position += blockLength) {
+		const Sci::Position lengthBlock = std::min(blockLength, length - position);
+		const char *text = substance.RangePointer(position, lengthBlock);
+		if (!text) {
+			block.resize(lengthBlock);
+			substance.GetRange(block.data(), position, lengthBlock);
+			text = block.data();
+		}
+		lineInsert += InsertLineEnds(position, text, lengthBlock,
+			lineInsert, true, chBeforePrev, chPrev, lineEndFound);
 	}
 }
 
@@ -887,13 +1256,16 @@ namespace {
 
 CountWidths CountCharacterWidthsUTF8(std::string_view sv) noexcept {
 	CountWidths cw;
-	size_t remaining = sv.length();
-	while (remaining > 0) {
+	while (!sv.empty()) {
+		const size_t lengthAscii = UTF8AsciiLength(sv);
+		cw.countBasePlane += lengthAscii;
+		sv.remove_prefix(lengthAscii);
+		if (sv.empty())
+			break;
 		const int utf8Status = UTF8Classify(sv);
 		const int lenChar = utf8Status & UTF8MaskWidth;
 		cw.CountChar(lenChar);
 		sv.remove_prefix(lenChar);
-		remaining -= lenChar;
 	}
 	return cw;
 }
@@ -964,33 +1336,12 @@ void CellBuffer::BasicInsertString(Sci::Position position, const char *s, Sci::P
 	if (breakingUTF8LineEnd) {
 		RemoveLine(lineInsert);
 	}
-	unsigned char ch = ' ';
-	for (Sci::Position i = 0; i < insertLength; i++) {
-		ch = s[i];
-		if (ch == '\r') {
-			InsertLine(lineInsert, (position + i) + 1, atLineStart);
-			lineInsert++;
-			simpleInsertion = false;
-		} else if (ch == '\n') {
-			if (chPrev == '\r') {
-				// Patch up what was end of line
-				plv->SetLineStart(lineInsert - 1, (position + i) + 1);
-			} else {
-				InsertLine(lineInsert, (position + i) + 1, atLineStart);
-				lineInsert++;
-			}
-			simpleInsertion = false;
-		} else if (utf8LineEnds) {
-			const unsigned char back3[3] = {chBeforePrev, chPrev, ch};
-			if (UTF8IsSeparator(back3) || UTF8IsNEL(back3+1)) {
-				InsertLine(lineInsert, (position + i) + 1, atLineStart);
-				lineInsert++;
-				simpleInsertion = false;
-			}
-		}
-		chBeforePrev = chPrev;
-		chPrev = ch;
+	bool lineEndFound = false;
+	lineInsert += InsertLineEnds(position, s, insertLength, lineInsert, atLineStart, chBeforePrev, chPrev, lineEndFound);
+	if (lineEndFound) {
+		simpleInsertion = false;
 	}
+	const unsigned char ch = chPrev;
 	// Joining two lines where last insertion is cr and following substance starts with lf
 	if (chAfter == '\n') {
 		if (ch == '\r') {
@@ -1155,6 +1506,18 @@ void CellBuffer::DeleteUndoHistory() {
 	uh.DeleteUndoHistory();
 }
 
+void CellBuffer::SetUndoMemoryLimit(Sci::Position limit) {
+	uh.SetMemoryLimit(limit);
+}
+
+Sci::Position CellBuffer::GetUndoMemoryLimit() const noexcept {
+	return uh.GetMemoryLimit();
+}
+
+Sci::Position CellBuffer::UndoMemoryUse() const noexcept {
+	return uh.MemoryUse();
+}
+
 bool CellBuffer::CanUndo() const {
 	return uh.CanUndo();
 }
@@ -1163,12 +1526,12 @@ int CellBuffer::StartUndo() {
 	return uh.StartUndo();
 }
 
-const Action &CellBuffer::GetUndoStep() const {
+Action CellBuffer::GetUndoStep() const {
 	return uh.GetUndoStep();
 }
 
 void CellBuffer::PerformUndoStep() {
-	const Action &actionStep = uh.GetUndoStep();
+	const Action actionStep = uh.GetUndoStep();
 	if (actionStep.at == insertAction) {
 		if (substance.Length() < actionStep.lenData) {
 			throw std::runtime_error(
@@ -1176,7 +1539,7 @@ void CellBuffer::PerformUndoStep() {
 		}
 		BasicDeleteChars(actionStep.position, actionStep.lenData);
 	} else if (actionStep.at == removeAction) {
-		BasicInsertString(actionStep.position, actionStep.data.get(), actionStep.lenData);
+		BasicInsertString(actionStep.position, actionStep.data, actionStep.lenData);
 	}
 	uh.CompletedUndoStep();
 }
@@ -1189,14 +1552,14 @@ int CellBuffer::StartRedo() {
 	return uh.StartRedo();
 }
 
-const Action &CellBuffer::GetRedoStep() const {
+Action CellBuffer::GetRedoStep() const {
 	return uh.GetRedoStep();
 }
 
 void CellBuffer::PerformRedoStep() {
-	const Action &actionStep = uh.GetRedoStep();
+	const Action actionStep = uh.GetRedoStep();
 	if (actionStep.at == insertAction) {
-		BasicInsertString(actionStep.position, actionStep.data.get(), actionStep.lenData);
+		BasicInsertString(actionStep.position, actionStep.data, actionStep.lenData);
 	} else if (actionStep.at == removeAction) {
 		BasicDeleteChars(actionStep.position, actionStep.lenData);
 	}
@@ -16,6 +16,7 @@ public:
 	virtual ~PerLine() {}
 	virtual void Init()=0;
 	virtual void InsertLine(Sci::Line line)=0;
+	virtual void InsertLines(Sci::Line line, Sci::Line lines)=0;
 	virtual void RemoveLine(Sci::Line line)=0;
 };
 
@@ -28,39 +29,78 @@ enum actionType { insertAction, removeAction, startAction, containerAction };
 
 /**
  * Actions are used to store all the information required to perform one undo/redo step.
+ * The text of an action is owned by the UndoHistory and remains valid until the history is changed.
  */
 class Action {
 public:
 	actionType at;
 	Sci::Position position;
-	std::unique_ptr<char[]> data;
+	const char *data;
 	Sci::Position lenData;
 	bool mayCoalesce;
 
-	Action();
-	// Deleted so Action objects can not be copied.
-	Action(const Action &other) = delete;
-	Action &operator=(const Action &other) = delete;
-	Action &operator=(const Action &&other) = delete;
-	// Move constructor allows vector to be resized without reallocating.
-	Action(Action &&other) noexcept = default;
-	~Action();
-	void Create(actionType at_, Sci::Position position_=0, const char *data_=nullptr, Sci::Position lenData_=0, bool mayCoalesce_=true);
-	void Clear();
+	Action() noexcept;
+	Action(actionType at_, Sci::Position position_, const char *data_, Sci::Position lenData_, bool mayCoalesce_) noexcept;
+};
+
+/**
+ * Append-only storage for the text of undo actions in large blocks.
+ * Text is addressed by a logical offset that keeps increasing as text is appended so that
+ * offsets remain valid when blocks are discarded from the start.
+ */
+class UndoArena {
+	struct Block {
+		std::unique_ptr<char[]> data;
+		size_t start;
+		size_t size;
+	};
+	std::vector<Block> blocks;
+	size_t begin;
+	size_t end;
+public:
+	enum { blockSize = 0x10000 };
+	UndoArena() noexcept;
+	// Deleted so UndoArena objects can not be copied.
+	UndoArena(const UndoArena &) = delete;
+	UndoArena(UndoArena &&) = delete;
+	void operator=(const UndoArena &) = delete;
+	void operator=(UndoArena &&) = delete;
+	~UndoArena();
+	size_t Begin() const noexcept { return begin; }
+	size_t End() const noexcept { return end; }
+	size_t Append(const char *s, size_t length);
+	const char *Pointer(size_t offset) const noexcept;
+	void Truncate(size_t position) noexcept;
+	void Discard(size_t position) noexcept;
+	void Clear() noexcept;
 };
 
 /**
  *
  */
 class UndoHistory {
-	std::vector<Action> actions;
+	// Compact form of an Action with its text held in the arena
+	struct ActionRecord {
+		Sci::Position position;
+		Sci::Position lenData;
+		size_t offset;
+		actionType at;
+		bool mayCoalesce;
+	};
+	std::vector<ActionRecord> actions;
+	UndoArena arena;
 	int maxAction;
 	int currentAction;
 	int undoSequenceDepth;
 	int savePoint;
 	int tentativePoint;
+	Sci::Position memoryLimit;
+	Sci::Position memoryCheck;
 
 	void EnsureUndoRoom();
+	void Record(int index, actionType at, Sci::Position position=0, const char *data=nullptr, Sci::Position lengthData=0, bool mayCoalesce=true);
+	Action ActionAt(int index) const noexcept;
+	void LimitMemory();
 
 public:
 	UndoHistory();
@@ -78,6 +118,11 @@ public:
 	void DropUndoSequence();
 	void DeleteUndoHistory();
 
+	/// Memory used by the history may be limited by dropping the oldest user operations.
+	void SetMemoryLimit(Sci::Position limit);
+	Sci::Position GetMemoryLimit() const noexcept;
+	Sci::Position MemoryUse() const noexcept;
+
 	/// The save point is a marker in the undo stack where the container has stated that
 	/// the buffer was saved. Undo and redo can move over the save point.
 	void SetSavePoint();
@@ -93,14 +138,53 @@ public:
 	/// called that many times. Similarly for redo.
 	bool CanUndo() const;
 	int StartUndo();
-	const Action &GetUndoStep() const;
+	Action GetUndoStep() const;
 	void CompletedUndoStep();
 	bool CanRedo() const;
 	int StartRedo();
-	const Action &GetRedoStep() const;
+	Action GetRedoStep() const;
 	void CompletedRedoStep();
 };
 
+template <typename T> class ChunkVector;
+
+/**
+ * Holds the bytes of text or styles for a CellBuffer in a SplitVector or, for
+ * documents created with SC_DOCUMENTOPTION_TEXT_CHUNKED that grow beyond
+ * lengthChunked, in a ChunkVector.
+ */
+class CellStore {
+	bool chunkable;
+	SplitVector<char> gapped;
+	std::unique_ptr<ChunkVector<char>> chunked;
+	void ChunkIfLarge(Sci::Position lengthWanted);
+public:
+	// Below 4 MB moving the gap is cheap and chunks would make access slower.
+	static constexpr Sci::Position lengthChunked = 0x400000;
+	explicit CellStore(bool chunkable_) noexcept;
+	// Deleted so CellStore objects can not be copied.
+	CellStore(const CellStore &) = delete;
+	CellStore(CellStore &&) = delete;
+	void operator=(const CellStore &) = delete;
+	void operator=(CellStore &&) = delete;
+	~CellStore();
+
+	bool IsChunkable() const noexcept;
+	bool IsChunked() const noexcept;
+	char ValueAt(Sci::Position position) const noexcept;
+	void SetValueAt(Sci::Position position, char v) noexcept;
+	bool SetRange(Sci::Position position, Sci::Position rangeLength, char v) noexcept;
+	Sci::Position Length() const noexcept;
+	void ReAllocate(Sci::Position newSize);
+	void InsertValue(Sci::Position position, Sci::Position insertLength, char v);
+	void InsertFromArray(Sci::Position positionToInsert, const char s[], Sci::Position positionFrom, Sci::Position insertLength);
+	void DeleteRange(Sci::Position position, Sci::Position deleteLength);
+	void GetRange(char *buffer, Sci::Position position, Sci::Position retrieveLength) const noexcept;
+	char *BufferPointer();
+	char *RangePointer(Sci::Position position, Sci::Position rangeLength);
+	Sci::Position GapPosition() const noexcept;
+};
+
 /**
  * Holder for an expandable array of characters that supports undo and line markers.
  * Based on article "Data Structures in a Bit-Mapped Text Editor"
@@ -110,8 +194,8 @@ class CellBuffer {
 private:
 	bool hasStyles;
 	bool largeDocument;
-	SplitVector<char> substance;
-	SplitVector<char> style;
+	CellStore substance;
+	CellStore style;
 	bool readOnly;
 	bool utf8Substance;
 	int utf8LineEnds;
@@ -123,6 +207,8 @@ private:
 
 	bool UTF8LineEndOverlaps(Sci::Position position) const;
 	bool UTF8IsCharacterBoundary(Sci::Position position) const;
+	Sci::Line InsertLineEnds(Sci::Position position, const char *s, Sci::Position insertLength,
+		Sci::Line lineInsert, bool atLineStart, unsigned char &chBeforePrev, unsigned char &chPrev, bool &lineEndFound);
 	void ResetLineEnds();
 	void RecalculateIndexLineStarts(Sci::Line lineFirst, Sci::Line lineLast);
 	bool MaintainingLineCharacterIndex() const noexcept;
@@ -132,7 +218,7 @@ private:
 
 public:
 
-	CellBuffer(bool hasStyles_, bool largeDocument_);
+	CellBuffer(bool hasStyles_, bool largeDocument_, bool chunkedDocument_);
 	// Deleted so CellBuffer objects can not be copied.
 	CellBuffer(const CellBuffer &) = delete;
 	CellBuffer(CellBuffer &&) = delete;
@@ -179,6 +265,8 @@ public:
 	bool IsReadOnly() const;
 	void SetReadOnly(bool set);
 	bool IsLarge() const;
+	bool IsChunkable() const noexcept;
+	bool IsChunked() const noexcept;
 	bool HasStyles() const;
 
 	/// The save point is a marker in the undo stack where the container has stated that
@@ -197,16 +285,19 @@ public:
 	void EndUndoAction();
 	void AddUndoAction(Sci::Position token, bool mayCoalesce);
 	void DeleteUndoHistory();
+	void SetUndoMemoryLimit(Sci::Position limit);
+	Sci::Position GetUndoMemoryLimit() const noexcept;
+	Sci::Position UndoMemoryUse() const noexcept;
 
 	/// To perform an undo, StartUndo is called to retrieve the number of steps, then UndoStep is
 	/// called that many times. Similarly for redo.
 	bool CanUndo() const;
 	int StartUndo();
-	const Action &GetUndoStep() const;
+	Action GetUndoStep() const;
 	void PerformUndoStep();
 	bool CanRedo() const;
 	int StartRedo();
-	const Action &GetRedoStep() const;
+	Action GetRedoStep() const;
 	void PerformRedoStep();
 };
 
@@ -0,0 +1,282 @@
+// Scintilla source code edit control
+/** @file ChunkVector.h
+ ** Data structure for holding very large arrays that handle insertions
+ ** and deletions anywhere efficiently by dividing them into chunks.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef CHUNKVECTOR_H
+#define CHUNKVECTOR_H
+
+namespace Scintilla {
+
+/**
+ * An alternative to SplitVector for very large documents where insertions and
+ * deletions are spread around so that moving a single gap would move a large
+ * amount of memory.
+ * Elements are held in a sequence of chunks of up to chunkLengthMax elements each
+ * where each chunk is a small SplitVector so that a run of edits in one place only
+ * moves the gap of that chunk.
+ * The chunk containing a position is found by a binary search of a Partitioning.
+ * Modifying a chunk's length updates the partition step which, like changing the
+ * number of chunks, may move O(chunks) values so this is only an improvement over
+ * a single gap once documents are much larger than a chunk.
+ * Pointers are only provided to ranges within one chunk as combining chunks would
+ * move as much memory as the single gap this avoids.
+ */
+template <typename T>
+class ChunkVector {
+public:
+	// Chunks are filled to chunkLengthFill when created so there is room to insert.
+	enum { chunkLengthFill = 0x8000, chunkLengthMax = 0x10000 };
+private:
+	using Chunk = SplitVector<T>;
+	SplitVector<std::unique_ptr<Chunk>> chunks;
+	Partitioning<ptrdiff_t> starts;
+	T empty;	/// Returned as the result of out-of-bounds access.
+	ptrdiff_t lengthBody;
+
+	ptrdiff_t ChunkStart(ptrdiff_t chunk) const noexcept {
+		return starts.PositionFromPartition(chunk);
+	}
+
+	// Insert a new chunk after chunk, starting at position.
+	Chunk &AddChunk(ptrdiff_t chunk, ptrdiff_t position) {
+		chunks.Insert(chunk + 1, std::make_unique<Chunk>());
+		starts.InsertPartition(chunk + 1, position);
+		return *chunks[chunk + 1];
+	}
+
+	// Combine the chunk with the following chunk if they are small enough.
+	void MergeWithNext(ptrdiff_t chunk) {
+		if ((chunk + 1 < chunks.Length()) &&
+			(chunks[chunk]->Length() + chunks[chunk + 1]->Length() <= chunkLengthFill)) {
+			Chunk &next = *chunks[chunk + 1];
+			chunks[chunk]->InsertFromArray(chunks[chunk]->Length(), next.RangePointer(0, next.Length()), 0, next.Length());
+			chunks.Delete(chunk + 1);
+			starts.RemovePartition(chunk + 1);
+		}
+	}
+
+	/// Insert insertLength elements at position with insert(chunk, offset, length, offsetSource)
+	/// called to insert each part.
+	template <typename Insert>
+	void InsertPieces(ptrdiff_t position, ptrdiff_t insertLength, Insert insert) {
+		PLATFORM_ASSERT((position >= 0) && (position <= lengthBody));
+		if ((insertLength <= 0) || (position < 0) || (position > lengthBody)) {
+			return;
+		}
+		ptrdiff_t chunk = starts.PartitionFromPosition(position);
+		const ptrdiff_t startChunk = ChunkStart(chunk);
+		const ptrdiff_t offset = position - startChunk;
+		starts.InsertText(chunk, insertLength);
+		lengthBody += insertLength;
+		if (chunks[chunk]->Length() + insertLength <= chunkLengthMax) {
+			insert(*chunks[chunk], offset, insertLength, 0);
+			return;
+		}
+		// Move the part of the chunk after position into tail then append new elements
+		// to the chunk and then to new chunks before appending the tail.
+		std::vector<T> tail(chunks[chunk]->Length() - offset);
+		chunks[chunk]->GetRange(tail.data(), offset, tail.size());
+		chunks[chunk]->DeleteRange(offset, tail.size());
+		ptrdiff_t positionChunk = startChunk;
+		ptrdiff_t inserted = 0;
+		while (inserted < insertLength) {
+			if (chunks[chunk]->Length() >= chunkLengthFill) {
+				positionChunk += chunks[chunk]->Length();
+				AddChunk(chunk, positionChunk);
+				chunk++;
+			}
+			Chunk &current = *chunks[chunk];
+			const ptrdiff_t lengthPiece = std::min(insertLength - inserted, chunkLengthFill - current.Length());
+			insert(current, current.Length(), lengthPiece, inserted);
+			inserted += lengthPiece;
+		}
+		const ptrdiff_t lengthTail = tail.size();
+		if (chunks[chunk]->Length() + lengthTail > chunkLengthMax) {
+			positionChunk += chunks[chunk]->Length();
+			AddChunk(chunk, positionChunk);
+			chunk++;
+		}
+		chunks[chunk]->InsertFromArray(chunks[chunk]->Length(), tail.data(), 0, lengthTail);
+	}
+
+public:
+	ChunkVector() : starts(8), empty(), lengthBody(0) {
+		chunks.Insert(0, std::make_unique<Chunk>());
+	}
+	// Deleted so ChunkVector objects can not be copied.
+	ChunkVector(const ChunkVector &) = delete;
+	ChunkVector(ChunkVector &&) = delete;
+	void operator=(const ChunkVector &) = delete;
+	void operator=(ChunkVector &&) = delete;
+
+	~ChunkVector() {
+	}
+
+	/// Retrieve the element at a particular position.
+	/// Retrieving positions outside the range of the buffer returns empty or 0.
+	const T &ValueAt(ptrdiff_t position) const noexcept {
+		if ((position < 0) || (position >= lengthBody)) {
+			return empty;
+		}
+		const ptrdiff_t chunk = starts.PartitionFromPosition(position);
+		return (*chunks[chunk])[position - ChunkStart(chunk)];
+	}
+
+	/// Set the element at a particular position.
+	/// Setting positions outside the range of the buffer performs no assignment
+	/// but asserts in debug builds.
+	void SetValueAt(ptrdiff_t position, T v) noexcept {
+		if ((position < 0) || (position >= lengthBody)) {
+			PLATFORM_ASSERT(position >= 0);
+			PLATFORM_ASSERT(position < lengthBody);
+			return;
+		}
+		const ptrdiff_t chunk = starts.PartitionFromPosition(position);
+		(*chunks[chunk])[position - ChunkStart(chunk)] = v;
+	}
+
+	/// Set a range of elements to a value.
+	/// @return true if any element changed.
+	bool SetRange(ptrdiff_t position, ptrdiff_t rangeLength, T v) noexcept {
+		bool changed = false;
+		while ((rangeLength > 0) && (position >= 0) && (position < lengthBody)) {
+			const ptrdiff_t chunk = starts.PartitionFromPosition(position);
+			Chunk &current = *chunks[chunk];
+			const ptrdiff_t offset = position - ChunkStart(chunk);
+			const ptrdiff_t lengthPiece = std::min(rangeLength, current.Length() - offset);
+			for (ptrdiff_t i = offset; i < offset + lengthPiece; i++) {
+				if (current[i] != v) {
+					current[i] = v;
+					changed = true;
+				}
+			}
+			position += lengthPiece;
+			rangeLength -= lengthPiece;
+		}
+		return changed;
+	}
+
+	/// Retrieve the length of the buffer.
+	ptrdiff_t Length() const noexcept {
+		return lengthBody;
+	}
+
+	/// Retrieve the number of chunks used to store the elements.
+	ptrdiff_t Chunks() const noexcept {
+		return chunks.Length();
+	}
+
+	/// Insert a number of elements into the buffer setting their value.
+	/// Inserting at positions outside the current range fails.
+	void InsertValue(ptrdiff_t position, ptrdiff_t insertLength, T v) {
+		InsertPieces(position, insertLength, [v](Chunk &chunk, ptrdiff_t offset, ptrdiff_t lengthPiece, ptrdiff_t) {
+			chunk.InsertValue(offset, lengthPiece, v);
+		});
+	}
+
+	/// Insert text into the buffer from an array.
+	void InsertFromArray(ptrdiff_t positionToInsert, const T s[], ptrdiff_t positionFrom, ptrdiff_t insertLength) {
+		InsertPieces(positionToInsert, insertLength, [s, positionFrom](Chunk &chunk, ptrdiff_t offset, ptrdiff_t lengthPiece, ptrdiff_t offsetSource) {
+			chunk.InsertFromArray(offset, s, positionFrom + offsetSource, lengthPiece);
+		});
+	}
+
+	/// Delete a range from the buffer.
+	/// Deleting positions outside the current range fails.
+	void DeleteRange(ptrdiff_t position, ptrdiff_t deleteLength) {
+		PLATFORM_ASSERT((position >= 0) && (position + deleteLength <= lengthBody));
+		if ((position < 0) || ((position + deleteLength) > lengthBody)) {
+			return;
+		}
+		if ((position == 0) && (deleteLength == lengthBody)) {
+			DeleteAll();
+			return;
+		}
+		while (deleteLength > 0) {
+			const ptrdiff_t chunk = starts.PartitionFromPosition(position);
+			Chunk &current = *chunks[chunk];
+			const ptrdiff_t offset = position - ChunkStart(chunk);
+			const ptrdiff_t lengthPiece = std::min(deleteLength, current.Length() - offset);
+			current.DeleteRange(offset, lengthPiece);
+			starts.InsertText(chunk, -lengthPiece);
+			lengthBody -= lengthPiece;
+			deleteLength -= lengthPiece;
+			if (current.Length() == 0) {
+				// Empty chunk has same start as next so remove the following start.
+				chunks.Delete(chunk);
+				starts.RemovePartition(chunk + 1);
+				if (chunk > 0) {
+					MergeWithNext(chunk - 1);
+				}
+			} else {
+				MergeWithNext(chunk);
+				if (chunk > 0) {
+					MergeWithNext(chunk - 1);
+				}
+			}
+		}
+	}
+
+	/// Delete all the buffer contents.
+	void DeleteAll() {
+		chunks.DeleteAll();
+		chunks.Insert(0, std::make_unique<Chunk>());
+		starts.DeleteAll();
+		lengthBody = 0;
+	}
+
+	/// Retrieve a range of elements into an array
+	void GetRange(T *buffer, ptrdiff_t position, ptrdiff_t retrieveLength) const noexcept {
+		while ((retrieveLength > 0) && (position >= 0) && (position < lengthBody)) {
+			const ptrdiff_t chunk = starts.PartitionFromPosition(position);
+			const Chunk &current = *chunks[chunk];
+			const ptrdiff_t offset = position - ChunkStart(chunk);
+			const ptrdiff_t lengthPiece = std::min(retrieveLength, current.Length() - offset);
+			current.GetRange(buffer, offset, lengthPiece);
+			buffer += lengthPiece;
+			position += lengthPiece;
+			retrieveLength -= lengthPiece;
+		}
+	}
+
+	/// Return a pointer to the first element when all the elements are in one chunk
+	/// or nullptr when the contents are not contiguous.
+	/// Also ensures there is an empty element beyond logical end in case its
+	/// passed to a function expecting a NUL terminated string.
+	T *BufferPointer() {
+		if (chunks.Length() > 1) {
+			return nullptr;
+		}
+		return chunks[0]->BufferPointer();
+	}
+
+	/// Return a pointer to a range of elements when that range is within one chunk,
+	/// moving that chunk's gap if needed, or nullptr when the range spans chunks.
+	T *RangePointer(ptrdiff_t position, ptrdiff_t rangeLength) noexcept {
+		if ((position < 0) || (rangeLength < 0) || (position + rangeLength > lengthBody)) {
+			return nullptr;
+		}
+		const ptrdiff_t chunk = starts.PartitionFromPosition(position);
+		const ptrdiff_t offset = position - ChunkStart(chunk);
+		Chunk &current = *chunks[chunk];
+		if (offset + rangeLength > current.Length()) {
+			return nullptr;
+		}
+		return current.RangePointer(offset, rangeLength);
+	}
+
+	/// Return the position of the gap within the buffer.
+	/// There is no single gap so report the end: RangePointer may still fail for ranges
+	/// that span chunks.
+	ptrdiff_t GapPosition() const noexcept {
+		return lengthBody;
+	}
+};
+
+}
+
+#endif
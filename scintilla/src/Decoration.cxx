@@ -79,6 +79,7 @@ class DecorationList : public IDecorationList {
 	std::vector<std::unique_ptr<Decoration<POS>>> decorationList;
 	std::vector<const IDecoration*> decorationView;	// Read-only view of decorationList
 	bool clickNotified;
+	size_t version;
 
 	Decoration<POS> *DecorationFromIndicator(int indicator);
 	Decoration<POS> *Create(int indicator, Sci::Position length);
@@ -108,6 +109,11 @@ public:
 
 	void DeleteLexerDecorations() override;
 
+	size_t Version() const noexcept override {
+		return version;
+	}
+	void SpansIntersecting(Sci::Position start, Sci::Position end, std::vector<DecorationSpan> &spans) const override;
+
 	int AllOnFor(Sci::Position position) const override;
 	int ValueAt(int indicator, Sci::Position position) override;
 	Sci::Position Start(int indicator, Sci::Position position) override;
@@ -123,7 +129,7 @@ public:
 
 template <typename POS>
 DecorationList<POS>::DecorationList() : currentIndicator(0), currentValue(1), current(nullptr),
-	lengthDocument(0), clickNotified(false) {
+	lengthDocument(0), clickNotified(false), version(0) {
 }
 
 template <typename POS>
@@ -193,6 +199,9 @@ FillResult<Sci::Position> DecorationList<POS>::FillRange(Sci::Position position,
 	// Converting result from POS to Sci::Position as callers not polymorphic.
 	const FillResult<POS> frInPOS = current->rs.FillRange(static_cast<POS>(position), value, static_cast<POS>(fillLength));
 	const FillResult<Sci::Position> fr { frInPOS.changed, frInPOS.position, frInPOS.fillLength };
+	if (fr.changed) {
+		version++;
+	}
 		if (current->Empty()) {
 		Delete(currentIndicator);
 	}
@@ -203,6 +212,7 @@ template <typename POS>
 void DecorationList<POS>::InsertSpace(Sci::Position position, Sci::Position insertLength) {
 	const bool atEnd = position == lengthDocument;
 	lengthDocument += insertLength;
+	version++;
 	for (const std::unique_ptr<Decoration<POS>> &deco : decorationList) {
 		deco->rs.InsertSpace(static_cast<POS>(position), static_cast<POS>(insertLength));
 		if (atEnd) {
@@ -214,6 +224,7 @@ void DecorationList<POS>::InsertSpace(Sci::Position position, Sci::Position inse
 template <typename POS>
 void DecorationList<POS>::DeleteRange(Sci::Position position, Sci::Position deleteLength) {
 	lengthDocument -= deleteLength;
+	version++;
 	for (const std::unique_ptr<Decoration<POS>> &deco : decorationList) {
 		deco->rs.DeleteRange(static_cast<POS>(position), static_cast<POS>(deleteLength));
 	}
@@ -232,6 +243,7 @@ void DecorationList<POS>::DeleteLexerDecorations() {
 		return deco->Indicator() < INDIC_CONTAINER;
 	}), decorationList.end());
 	current = nullptr;
+	version++;
 	SetView();
 }
 
@@ -255,6 +267,27 @@ void DecorationList<POS>::SetView() {
 	}
 }
 
+template <typename POS>
+void DecorationList<POS>::SpansIntersecting(Sci::Position start, Sci::Position end, std::vector<DecorationSpan> &spans) const {
+	const POS startRange = static_cast<POS>(std::max<Sci::Position>(start, 0));
+	const POS endRange = static_cast<POS>(std::min(end, lengthDocument));
+	if (startRange >= endRange) {
+		return;
+	}
+	for (const std::unique_ptr<Decoration<POS>> &deco : decorationList) {
+		// Walk forward one run at a time from the run containing the start of the range
+		POS startRun = deco->rs.StartRun(startRange);
+		while (startRun < endRange) {
+			const POS endRun = deco->rs.EndRun(startRun);
+			const int value = deco->rs.ValueAt(startRun);
+			if (value) {
+				spans.push_back({ deco->Indicator(), value, startRun, endRun });
+			}
+			startRun = endRun;
+		}
+	}
+}
+
 template <typename POS>
 int DecorationList<POS>::AllOnFor(Sci::Position position) const {
 	int mask = 0;
@@ -23,6 +23,14 @@ public:
 	virtual Sci::Position Runs() const = 0;
 };
 
+// A run of one indicator with a non-zero value.
+struct DecorationSpan {
+	int indicator;
+	int value;
+	Sci::Position start;
+	Sci::Position end;
+};
+
 class IDecorationList {
 public:
 	virtual ~IDecorationList() {}
@@ -41,6 +49,12 @@ public:
 	virtual void DeleteRange(Sci::Position position, Sci::Position deleteLength) = 0;
 	virtual void DeleteLexerDecorations() = 0;
 
+	// Changes whenever any decoration may have changed so extracted spans can be reused until then.
+	virtual size_t Version() const noexcept = 0;
+	// Appends the runs with non-zero values that overlap [start, end) ordered by indicator then position.
+	// Spans are not clipped to the range.
+	virtual void SpansIntersecting(Sci::Position start, Sci::Position end, std::vector<DecorationSpan> &spans) const = 0;
+
 	virtual int AllOnFor(Sci::Position position) const = 0;
 	virtual int ValueAt(int indicator, Sci::Position position) = 0;
 	virtual Sci::Position Start(int indicator, Sci::Position position) = 0;
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <memory>
 #include <chrono>
+#include <future>
 
 #ifndef NO_CXX11_REGEX
 #include <regex>
@@ -43,6 +44,7 @@
 #include "Decoration.h"
 #include "CaseFolder.h"
 #include "Document.h"
+#include "BackgroundStyler.h"
 #include "RESearch.h"
 #include "UniConversion.h"
 #include "ElapsedPeriod.h"
@@ -69,14 +71,29 @@ void LexInterface::Colourise(Sci::Position start, Sci::Position end) {
 			styleStart = pdoc->StyleAt(start - 1);
 
 		if (len > 0) {
-			instance->Lex(start, len, styleStart, pdoc);
-			instance->Fold(start, len, styleStart, pdoc);
+			// Large ranges may be split between forks of the lexer when it supports checkpoints.
+			const bool parallel = (pdoc->stylingThreads > 1) && (instance->Version() >= lvCheckpoints) &&
+				StyleInParallel(pdoc, static_cast<ILexerCheckpoints *>(instance), start, end, styleStart, pdoc->stylingThreads);
+			if (!parallel) {
+				instance->Lex(start, len, styleStart, pdoc);
+				instance->Fold(start, len, styleStart, pdoc);
+			}
 		}
 
 		performingStyle = false;
 	}
 }
 
+// Lexes against a snapshot of the document so may be called on a worker thread.
+// The document must ensure no other use is made of the lexer until this returns.
+void LexInterface::ColouriseSnapshot(IDocument *pAccess, Sci::Position start, Sci::Position end, int styleStart) {
+	const Sci::Position len = end - start;
+	if (instance && (len > 0)) {
+		instance->Lex(start, len, styleStart, pAccess);
+		instance->Fold(start, len, styleStart, pAccess);
+	}
+}
+
 int LexInterface::LineEndTypesSupported() {
 	if (instance) {
 		return instance->LineEndTypesSupported();
@@ -107,7 +124,8 @@ double ActionDuration::Duration() const noexcept {
 }
 
 Document::Document(int options) :
-	cb((options & SC_DOCUMENTOPTION_STYLES_NONE) == 0, (options & SC_DOCUMENTOPTION_TEXT_LARGE) != 0),
+	cb((options & SC_DOCUMENTOPTION_STYLES_NONE) == 0, (options & SC_DOCUMENTOPTION_TEXT_LARGE) != 0,
+		(options & SC_DOCUMENTOPTION_TEXT_CHUNKED) != 0),
 	durationStyleOneLine(0.00001, 0.000001, 0.0001) {
 	refCount = 0;
 #ifdef _WIN32
@@ -129,6 +147,7 @@ Document::Document(int options) :
 	useTabs = true;
 	tabIndents = true;
 	backspaceUnindents = false;
+	stylingThreads = 1;
 
 	matchesValid = false;
 
@@ -178,6 +197,13 @@ void Document::InsertLine(Sci::Line line) {
 	}
 }
 
+void Document::InsertLines(Sci::Line line, Sci::Line lines) {
+	for (const std::unique_ptr<PerLine> &pl : perLineData) {
+		if (pl)
+			pl->InsertLines(line, lines);
+	}
+}
+
 void Document::RemoveLine(Sci::Line line) {
 	for (const std::unique_ptr<PerLine> &pl : perLineData) {
 		if (pl)
@@ -259,7 +285,7 @@ void Document::TentativeUndo() {
 			//Platform::DebugPrintf("Steps=%d\n", steps);
 			for (int step = 0; step < steps; step++) {
 				const Sci::Line prevLinesTotal = LinesTotal();
-				const Action &action = cb.GetUndoStep();
+				const Action action = cb.GetUndoStep();
 				if (action.at == removeAction) {
 					NotifyModified(DocModification(
 									SC_MOD_BEFOREINSERT | SC_PERFORMED_UNDO, action));
@@ -294,7 +320,7 @@ void Document::TentativeUndo() {
 						modFlags |= SC_MULTILINEUNDOREDO;
 				}
 				NotifyModified(DocModification(modFlags, action.position, action.lenData,
-											   linesAdded, action.data.get()));
+											   linesAdded, action.data));
 			}
 
 			const bool endSavePoint = cb.IsSavePoint();
@@ -1150,6 +1176,8 @@ EncodingFamily Document::CodePageFamily() const noexcept {
 void Document::ModifiedAt(Sci::Position pos) noexcept {
 	if (endStyled > pos)
 		endStyled = pos;
+	if (backgroundStyler)
+		backgroundStyler->Invalidate(pos);
 }
 
 void Document::CheckReadOnly() {
@@ -1289,7 +1317,7 @@ Sci::Position Document::Undo() {
 			Sci::Position prevRemoveActionLen = 0;
 			for (int step = 0; step < steps; step++) {
 				const Sci::Line prevLinesTotal = LinesTotal();
-				const Action &action = cb.GetUndoStep();
+				const Action action = cb.GetUndoStep();
 				if (action.at == removeAction) {
 					NotifyModified(DocModification(
 									SC_MOD_BEFOREINSERT | SC_PERFORMED_UNDO, action));
@@ -1346,7 +1374,7 @@ Sci::Position Document::Undo() {
 						modFlags |= SC_MULTILINEUNDOREDO;
 				}
 				NotifyModified(DocModification(modFlags, action.position, action.lenData,
-											   linesAdded, action.data.get()));
+											   linesAdded, action.data));
 			}
 
 			const bool endSavePoint = cb.IsSavePoint();
@@ -1369,7 +1397,7 @@ Sci::Position Document::Redo() {
 			const int steps = cb.StartRedo();
 			for (int step = 0; step < steps; step++) {
 				const Sci::Line prevLinesTotal = LinesTotal();
-				const Action &action = cb.GetRedoStep();
+				const Action action = cb.GetRedoStep();
 				if (action.at == insertAction) {
 					NotifyModified(DocModification(
 									SC_MOD_BEFOREINSERT | SC_PERFORMED_REDO, action));
@@ -1406,7 +1434,7 @@ Sci::Position Document::Redo() {
 				}
 				NotifyModified(
 					DocModification(modFlags, action.position, action.lenData,
-									linesAdded, action.data.get()));
+									linesAdded, action.data));
 			}
 
 			const bool endSavePoint = cb.IsSavePoint();
@@ -1524,9 +1552,40 @@ Sci::Position Document::GetColumn(Sci::Position pos) {
 	return column;
 }
 
+Sci::Position Document::CountUTF8(Sci::Position startPos, Sci::Position endPos, bool countUTF16) const {
+	// Text is copied in blocks so the gap does not move.
+	// Blocks end before any character that continues into the next block.
+	constexpr Sci::Position blockSize = 0x10000;
+	std::string text;
+	Sci::Position count = 0;
+	Sci::Position pos = startPos;
+	while (pos < endPos) {
+		Sci::Position lengthBlock = std::min(endPos - pos, blockSize);
+		text.resize(lengthBlock);
+		cb.GetCharRange(text.data(), pos, lengthBlock);
+		if (pos + lengthBlock < endPos) {
+			for (Sci::Position back = 1; (back < UTF8MaxBytes) && (back < lengthBlock); back++) {
+				const unsigned char ch = text[lengthBlock - back];
+				if (!UTF8IsTrailByte(ch)) {
+					if (UTF8BytesOfLead[ch] > back)
+						lengthBlock -= back;
+					break;
+				}
+			}
+		}
+		count += UTF8CountCharacters(std::string_view(text.data(), lengthBlock), countUTF16);
+		pos += lengthBlock;
+	}
+	return count;
+}
+
 Sci::Position Document::CountCharacters(Sci::Position startPos, Sci::Position endPos) const {
 	startPos = MovePositionOutsideChar(startPos, 1, false);
 	endPos = MovePositionOutsideChar(endPos, -1, false);
+	if (!dbcsCodePage)
+		return std::max<Sci::Position>(endPos - startPos, 0);
+	if (SC_CP_UTF8 == dbcsCodePage)
+		return CountUTF8(startPos, endPos, false);
 	Sci::Position count = 0;
 	Sci::Position i = startPos;
 	while (i < endPos) {
@@ -1539,6 +1598,10 @@ Sci::Position Document::CountCharacters(Sci::Position startPos, Sci::Position en
 Sci::Position Document::CountUTF16(Sci::Position startPos, Sci::Position endPos) const {
 	startPos = MovePositionOutsideChar(startPos, 1, false);
 	endPos = MovePositionOutsideChar(endPos, -1, false);
+	if (!dbcsCodePage)
+		return std::max<Sci::Position>(endPos - startPos, 0);
+	if (SC_CP_UTF8 == dbcsCodePage)
+		return CountUTF8(startPos, endPos, true);
 	Sci::Position count = 0;
 	Sci::Position i = startPos;
 	while (i < endPos) {
@@ -1551,6 +1614,83 @@ Sci::Position Document::CountUTF16(Sci::Position startPos, Sci::Position endPos)
 	return count;
 }
 
+const LineCharacterCache::LineSteps *LineCharacterCache::Steps(const Document *pdoc, Sci::Line line) {
+	const Sci::Position lineStart = pdoc->LineStart(line);
+	const Sci::Position lineEnd = pdoc->LineStart(line + 1);
+	if (lineEnd - lineStart < lengthCached) {
+		// counting short lines is as quick as using steps
+		return nullptr;
+	}
+	auto it = std::find_if(lines.begin(), lines.end(), [line](const LineSteps &ls) noexcept {
+		return ls.line == line;
+	});
+	if (it != lines.end()) {
+		std::rotate(it, it + 1, lines.end());
+		return &lines.back();
+	}
+	if (lines.size() >= linesCached) {
+		lines.erase(lines.begin());
+	}
+	LineSteps ls { line, {} };
+	Sci::Position characters = 0;
+	for (Sci::Position pos = lineStart; pos < lineEnd; pos = pdoc->NextPosition(pos, 1)) {
+		if ((characters % stepCharacters) == 0) {
+			ls.steps.push_back(pos - lineStart);
+		}
+		characters++;
+	}
+	lines.push_back(std::move(ls));
+	return &lines.back();
+}
+
+Sci::Position LineCharacterCache::CharactersBefore(const Document *pdoc, Sci::Line line, Sci::Position byteOffset) {
+	const Sci::Position lineStart = pdoc->LineStart(line);
+	const LineSteps *pls = Steps(pdoc, line);
+	if (!pls) {
+		return pdoc->CountCharacters(lineStart, byteOffset);
+	}
+	// steps starts with 0 so there is always a step at or before byteOffset
+	const auto it = std::upper_bound(pls->steps.begin(), pls->steps.end(), byteOffset - lineStart);
+	const Sci::Position step = it - pls->steps.begin() - 1;
+	return step * stepCharacters + pdoc->CountCharacters(lineStart + pls->steps[step], byteOffset);
+}
+
+Sci::Position LineCharacterCache::PositionOfCharacter(const Document *pdoc, Sci::Line line, Sci::Position characterInLine) {
+	const Sci::Position lineStart = pdoc->LineStart(line);
+	const LineSteps *pls = Steps(pdoc, line);
+	Sci::Position pos;
+	if (!pls) {
+		pos = pdoc->GetRelativePosition(lineStart, characterInLine);
+	} else {
+		const Sci::Position step = std::min<Sci::Position>(characterInLine / stepCharacters, pls->steps.size() - 1);
+		pos = pdoc->GetRelativePosition(lineStart + pls->steps[step], characterInLine - step * stepCharacters);
+	}
+	return (pos == INVALID_POSITION) ? pdoc->Length() : pos;
+}
+
+void LineCharacterCache::Modified(Sci::Line line, Sci::Line linesAdded) {
+	// Lines from line up to any lines removed have changed, while following lines only move
+	const Sci::Line lineLastChanged = line + std::max<Sci::Line>(-linesAdded, 0);
+	lines.erase(std::remove_if(lines.begin(), lines.end(), [line, lineLastChanged](const LineSteps &ls) noexcept {
+		return (ls.line >= line) && (ls.line <= lineLastChanged);
+	}), lines.end());
+	if (linesAdded) {
+		for (LineSteps &ls : lines) {
+			if (ls.line > lineLastChanged) {
+				ls.line += linesAdded;
+			}
+		}
+	}
+}
+
+void LineCharacterCache::Clear() noexcept {
+	lines.clear();
+}
+
+size_t LineCharacterCache::LinesCached() const noexcept {
+	return lines.size();
+}
+
 Sci::Position Document::FindColumn(Sci::Line line, Sci::Position column) {
 	Sci::Position position = LineStart(line);
 	if ((line >= 0) && (line < LinesTotal())) {
@@ -1653,6 +1793,7 @@ void Document::ConvertLineEnds(int eolModeSet) {
 
 int Document::Options() const {
 	return (IsLarge() ? SC_DOCUMENTOPTION_TEXT_LARGE : 0) |
+		(cb.IsChunkable() ? SC_DOCUMENTOPTION_TEXT_CHUNKED : 0) |
 		(cb.HasStyles() ? 0 : SC_DOCUMENTOPTION_STYLES_NONE);
 }
 
@@ -2131,6 +2272,25 @@ Sci::Position Document::FindText(Sci::Position minPos, Sci::Position maxPos, con
 	return -1;
 }
 
+/**
+ * Find text like FindText but without changing the groups used by SubstituteByPosition
+ * so searches can be performed in the background between an application's search and replace.
+ */
+Sci::Position Document::FindTextRetainingGroups(Sci::Position minPos, Sci::Position maxPos, const char *search,
+	int flags, Sci::Position *length) {
+	if (!(flags & SCFIND_REGEXP))
+		return FindText(minPos, maxPos, search, flags, length);
+	std::swap(regex, regexRetaining);
+	try {
+		const Sci::Position pos = FindText(minPos, maxPos, search, flags, length);
+		std::swap(regex, regexRetaining);
+		return pos;
+	} catch (...) {
+		std::swap(regex, regexRetaining);
+		throw;
+	}
+}
+
 const char *Document::SubstituteByPosition(const char *text, Sci::Position *length) {
 	if (regex)
 		return regex->SubstituteByPosition(this, text, length);
@@ -2224,6 +2384,10 @@ bool SCI_METHOD Document::SetStyles(Sci_Position length, const char *styles) {
 }
 
 void Document::EnsureStyledTo(Sci::Position pos) {
+	if ((enteredStyling == 0) && (pos > GetEndStyled())) {
+		// Background results may already cover pos and the lexer can not be used twice at once.
+		FinishBackgroundStyling();
+	}
 	if ((enteredStyling == 0) && (pos > GetEndStyled())) {
 		IncrementStyleClock();
 		if (pli && !pli->UseContainerLexing()) {
@@ -2248,6 +2412,48 @@ void Document::StyleToAdjustingLineDuration(Sci::Position pos) {
 	durationStyleOneLine.AddSample(lineLast - lineFirst, epStyling.Duration());
 }
 
+// Style towards pos with the lexer running on a worker thread against a snapshot.
+// Waits up to secondsAllowed for any current job then publishes its results and starts the next.
+// Returns false when styling can not be performed in the background, such as for container lexing.
+bool Document::StyleInBackground(Sci::Position pos, double secondsAllowed) {
+	if (!pli || pli->UseContainerLexing() || (enteredStyling != 0)) {
+		return false;
+	}
+	if (!backgroundStyler) {
+		backgroundStyler = std::make_unique<BackgroundStyler>();
+	}
+	if (backgroundStyler->Active()) {
+		if (!backgroundStyler->Wait(secondsAllowed)) {
+			return true;
+		}
+		FinishBackgroundStyling();
+	}
+	if (backgroundStyler->FallenBack()) {
+		return false;
+	}
+	if (pos > GetEndStyled()) {
+		// Size jobs to take about a tenth of a second so that waiting for one is not noticeable.
+		const Sci::Line lineEndStyled = SciLineFromPosition(GetEndStyled());
+		const Sci::Line linesToStyle = std::clamp(
+			static_cast<Sci::Line>(0.1 / durationStyleOneLine.Duration()),
+			static_cast<Sci::Line>(100), static_cast<Sci::Line>(0x40000));
+		const Sci::Position start = LineStart(lineEndStyled);
+		const Sci::Position end = std::min(LineStart(lineEndStyled + linesToStyle), pos);
+		IncrementStyleClock();
+		backgroundStyler->Start(this, pli.get(), start, end);
+	}
+	return true;
+}
+
+void Document::FinishBackgroundStyling() {
+	if (backgroundStyler && backgroundStyler->Active()) {
+		double duration = 0.0;
+		// Can not commit from inside styling as that would interleave with the current styling.
+		const Sci::Line linesStyled = backgroundStyler->Finish(this, enteredStyling == 0, duration);
+		durationStyleOneLine.AddSample(linesStyled, duration);
+	}
+}
+
 void Document::LexerChanged() {
 	// Tell the watchers the lexer has changed.
 	for (const WatcherWithUserData &watcher : watchers) {
@@ -2260,6 +2466,9 @@ LexInterface *Document::GetLexInterface() const {
 }
 
 void Document::SetLexInterface(LexInterface *pLexInterface) {
+	FinishBackgroundStyling();
+	// A different lexer may stay inside snapshots so may be styled in the background.
+	backgroundStyler.reset();
 	pli.reset(pLexInterface);
 }
 
@@ -2630,6 +2839,23 @@ Sci::Position Document::BraceMatch(Sci::Position position, Sci::Position /*maxRe
 	return - 1;
 }
 
+#ifndef NO_CXX11_REGEX
+
+/**
+ * A compiled std::regex along with the pattern and flags it was compiled from.
+ */
+struct Cxx11RegexCompiled {
+	std::string pattern;
+	std::regex::flag_type flags = std::regex::ECMAScript;
+	bool unicode = false;
+	bool valid = false;
+	std::regex regexp;
+	std::wregex wregexp;
+	std::string prefix;
+};
+
+#endif
+
 /**
  * Implementation of RegexSearchBase for the default built-in regular expression engine
  */
@@ -2651,6 +2877,17 @@ public:
 private:
 	RESearch search;
 	std::string substituted;
+	// The most recently compiled pattern is retained as searches are often repeated
+	// many times with the same pattern by replace all and by marking all matches.
+	std::string compiledPattern;
+	bool compiledCaseSensitive = false;
+	bool compiledPosix = false;
+	// Word characters are built into the compiled program for \w and case-insensitive literals.
+	std::string compiledWordCharacters;
+	std::string compiledPrefix;
+#ifndef NO_CXX11_REGEX
+	Cxx11RegexCompiled cxx11Compiled;
+#endif
 };
 
 namespace {
@@ -2696,13 +2933,179 @@ public:
 	}
 };
 
+/**
+ * The text of a regular expression that every match must start with, used to skip lines
+ * without running the regular expression engine. Stops at any character that may be special
+ * and drops the final literal if it is followed by an operator that allows it to be absent.
+ * Case-insensitive prefixes are limited to ASCII as other characters may fold to different
+ * byte sequences and non-ASCII text is not skipped by case-insensitive prefixes.
+ */
+std::string LiteralPrefix(const char *pattern, Sci::Position length, bool caseSensitive, bool cxx11) {
+	if (cxx11 && std::find(pattern, pattern + length, '|') != pattern + length) {
+		// Alternatives may start differently
+		return std::string();
+	}
+	Sci::Position i = (length > 0 && pattern[0] == '^') ? 1 : 0;
+	std::string prefix;
+	for (; i < length; i++) {
+		const unsigned char ch = pattern[i];
+		if (strchr("\\.[]()*+?{}^$|\r\n", ch) || (!caseSensitive && !UTF8IsAscii(ch))) {
+			break;
+		}
+		prefix.push_back(caseSensitive ? ch : MakeLowerCase(ch));
+	}
+	if ((i < length) && !prefix.empty() && strchr("*?{", pattern[i])) {
+		prefix.pop_back();
+	}
+	return prefix;
+}
+
+/**
+ * TextWindow provides direct access to a contiguous window of whole lines so that regular expression
+ * matching and the literal prefix check read memory instead of calling into the document for each
+ * character. Windows are limited in length so that making text contiguous, by moving the gap or
+ * copying from chunks, remains proportional to the text examined.
+ */
+class TextWindow {
+	Document *doc;
+	const char *text;
+	std::string copied;
+	Sci::Position start;
+	Sci::Position end;
+	Sci::Line lineFirst;
+	Sci::Line lineLast;
+
+	// Find the prefix in the window between from and to, returning the position or -1.
+	Sci::Position FindPrefix(Sci::Position from, Sci::Position to, const std::string &prefix, bool caseSensitive, bool forward) const noexcept {
+		const Sci::Position lengthPrefix = prefix.length();
+		if (to - from < lengthPrefix) {
+			return -1;
+		}
+		const std::string_view sv(text + from - start, to - from);
+		if (caseSensitive) {
+			const size_t found = forward ? sv.find(prefix) : sv.rfind(prefix);
+			return (found == std::string_view::npos) ? -1 : from + static_cast<Sci::Position>(found);
+		}
+		// Non-ASCII text may fold to ASCII, like KELVIN SIGN to 'k', in the regular expression
+		// engine's locale so is treated as matching and left to the regular expression.
+		auto MayMatch = [](char ch, char chPrefix) noexcept {
+			return !UTF8IsAscii(static_cast<unsigned char>(ch)) || (MakeLowerCase(ch) == chPrefix);
+		};
+		const Sci::Position last = sv.length() - lengthPrefix;
+		const Sci::Position increment = forward ? 1 : -1;
+		for (Sci::Position pos = forward ? 0 : last; forward ? (pos <= last) : (pos >= 0); pos += increment) {
+			if (MayMatch(sv[pos], prefix[0])) {
+				Sci::Position matched = 1;
+				while ((matched < lengthPrefix) && MayMatch(sv[pos + matched], prefix[matched])) {
+					matched++;
+				}
+				if (matched == lengthPrefix) {
+					return from + pos;
+				}
+			}
+		}
+		return -1;
+	}
+
+public:
+	enum { windowLength = 0x10000 };
+
+	explicit TextWindow(Document *doc_) noexcept :
+		doc(doc_), text(nullptr), start(0), end(0), lineFirst(-1), lineLast(-1) {
+	}
+
+	const Document *Doc() const noexcept {
+		return doc;
+	}
+
+	// Make line contiguous along with following lines in the direction of the search.
+	void Cover(Sci::Line line, const RESearchRange &resr) {
+		if ((line >= lineFirst) && (line <= lineLast)) {
+			return;
+		}
+		if (resr.increment == 1) {
+			lineFirst = line;
+			lineLast = doc->SciLineFromPosition(std::min(doc->LineStart(line) + windowLength, resr.endPos));
+		} else {
+			lineLast = line;
+			lineFirst = doc->SciLineFromPosition(std::max(doc->LineEnd(line) - windowLength, resr.endPos));
+		}
+		lineFirst = std::min(lineFirst, line);
+		lineLast = std::max(lineLast, line);
+		start = doc->LineStart(lineFirst);
+		end = doc->LineEnd(lineLast);
+		text = doc->RangePointer(start, end - start);
+		if (!text) {
+			// Chunked storage only provides pointers to ranges within one chunk
+			copied.resize(end - start);
+			doc->GetCharRange(&copied[0], start, end - start);
+			text = copied.c_str();
+		}
+	}
+
+	// Return line if it may contain a match or the next line that contains the prefix or
+	// resr.lineRangeBreak if no more lines contain the prefix.
+	Sci::Line CandidateLine(Sci::Line line, const RESearchRange &resr, const std::string &prefix, bool caseSensitive) {
+		while (line != resr.lineRangeBreak) {
+			Cover(line, resr);
+			if (prefix.empty()) {
+				return line;
+			}
+			const Range lineRange = resr.LineRange(line);
+			Sci::Position found = -1;
+			if (resr.increment == 1) {
+				found = FindPrefix(lineRange.start, std::min(end, resr.endPos), prefix, caseSensitive, true);
+			} else {
+				found = FindPrefix(std::max(start, resr.endPos), lineRange.end, prefix, caseSensitive, false);
+			}
+			if (found >= 0) {
+				return doc->SciLineFromPosition(found);
+			}
+			line = (resr.increment == 1) ? lineLast + 1 : lineFirst - 1;
+			if ((resr.increment == 1) ? (line > resr.lineRangeEnd) : (line < resr.lineRangeEnd)) {
+				return resr.lineRangeBreak;
+			}
+		}
+		return line;
+	}
+
+	char CharAt(Sci::Position position) const noexcept {
+		if ((position >= start) && (position < end)) {
+			return text[position - start];
+		}
+		return doc->CharAt(position);
+	}
+
+	Document::CharacterExtracted ExtractCharacter(Sci::Position position) const noexcept {
+		if ((position >= start) && (position + UTF8MaxBytes <= end)) {
+			const unsigned char *us = reinterpret_cast<const unsigned char *>(text + position - start);
+			if (UTF8IsAscii(us[0])) {
+				return Document::CharacterExtracted(us[0], 1);
+			}
+			const int utf8status = UTF8Classify(us, UTF8BytesOfLead[us[0]]);
+			if (utf8status & UTF8MaskInvalid) {
+				return Document::CharacterExtracted(unicodeReplacementChar, 1);
+			}
+			return Document::CharacterExtracted(UnicodeFromUTF8(us), utf8status & UTF8MaskWidth);
+		}
+		return doc->ExtractCharacter(position);
+	}
+
+	Sci::Position NextPosition(Sci::Position position, int moveDir) const noexcept {
+		if ((moveDir > 0) && (position >= start) && (position < end)) {
+			return position + ExtractCharacter(position).widthBytes;
+		}
+		return doc->NextPosition(position, moveDir);
+	}
+};
+
 // Define a way for the Regular Expression code to access the document
 class DocumentIndexer : public CharacterIndexer {
-	Document *pdoc;
+	const TextWindow &window;
 	Sci::Position end;
 public:
-	DocumentIndexer(Document *pdoc_, Sci::Position end_) noexcept :
-		pdoc(pdoc_), end(end_) {
+	DocumentIndexer(const TextWindow &window_, Sci::Position end_) noexcept :
+		window(window_), end(end_) {
 	}
 
 	DocumentIndexer(const DocumentIndexer &) = delete;
@@ -2716,7 +3119,7 @@ public:
 		if (index < 0 || index >= end)
 			return 0;
 		else
-			return pdoc->CharAt(index);
+			return window.CharAt(index);
 	}
 };
 
@@ -2730,23 +3133,23 @@ public:
 	typedef char* pointer;
 	typedef char& reference;
 
-	const Document *doc;
+	const TextWindow *window;
 	Sci::Position position;
 
-	ByteIterator(const Document *doc_=nullptr, Sci::Position position_=0) noexcept :
-		doc(doc_), position(position_) {
+	ByteIterator(const TextWindow *window_=nullptr, Sci::Position position_=0) noexcept :
+		window(window_), position(position_) {
 	}
 	ByteIterator(const ByteIterator &other) noexcept {
-		doc = other.doc;
+		window = other.window;
 		position = other.position;
 	}
 	ByteIterator(ByteIterator &&other) noexcept {
-		doc = other.doc;
+		window = other.window;
 		position = other.position;
 	}
 	ByteIterator &operator=(const ByteIterator &other) noexcept {
 		if (this != &other) {
-			doc = other.doc;
+			window = other.window;
 			position = other.position;
 		}
 		return *this;
@@ -2754,7 +3157,7 @@ public:
 	ByteIterator &operator=(ByteIterator &&) noexcept = default;
 	~ByteIterator() = default;
 	char operator*() const noexcept {
-		return doc->CharAt(position);
+		return window->CharAt(position);
 	}
 	ByteIterator &operator++() noexcept {
 		position++;
@@ -2770,10 +3173,10 @@ public:
 		return *this;
 	}
 	bool operator==(const ByteIterator &other) const noexcept {
-		return doc == other.doc && position == other.position;
+		return window == other.window && position == other.position;
 	}
 	bool operator!=(const ByteIterator &other) const noexcept {
-		return doc != other.doc || position != other.position;
+		return window != other.window || position != other.position;
 	}
 	Sci::Position Pos() const noexcept {
 		return position;
@@ -2801,7 +3204,7 @@ public:
 // matches wregex since it is based on wchar_t.
 class UTF8Iterator {
 	// These 3 fields determine the iterator position and are used for comparisons
-	const Document *doc;
+	const TextWindow *window;
 	Sci::Position position;
 	size_t characterIndex;
 	// Remaining fields are derived from the determining fields so are excluded in comparisons
@@ -2815,16 +3218,16 @@ public:
 	typedef wchar_t* pointer;
 	typedef wchar_t& reference;
 
-	UTF8Iterator(const Document *doc_=nullptr, Sci::Position position_=0) noexcept :
-		doc(doc_), position(position_), characterIndex(0), lenBytes(0), lenCharacters(0), buffered{} {
+	UTF8Iterator(const TextWindow *window_=nullptr, Sci::Position position_=0) noexcept :
+		window(window_), position(position_), characterIndex(0), lenBytes(0), lenCharacters(0), buffered{} {
 		buffered[0] = 0;
 		buffered[1] = 0;
-		if (doc) {
+		if (window) {
 			ReadCharacter();
 		}
 	}
 	UTF8Iterator(const UTF8Iterator &other) noexcept : buffered{} {
-		doc = other.doc;
+		window = other.window;
 		position = other.position;
 		characterIndex = other.characterIndex;
 		lenBytes = other.lenBytes;
@@ -2835,7 +3238,7 @@ public:
 	UTF8Iterator(UTF8Iterator &&other) noexcept = default;
 	UTF8Iterator &operator=(const UTF8Iterator &other) noexcept {
 		if (this != &other) {
-			doc = other.doc;
+			window = other.window;
 			position = other.position;
 			characterIndex = other.characterIndex;
 			lenBytes = other.lenBytes;
@@ -2876,7 +3279,7 @@ public:
 		if (characterIndex) {
 			characterIndex--;
 		} else {
-			position = doc->NextPosition(position, -1);
+			position = window->NextPosition(position, -1);
 			ReadCharacter();
 			characterIndex = lenCharacters - 1;
 		}
@@ -2884,13 +3287,13 @@ public:
 	}
 	bool operator==(const UTF8Iterator &other) const noexcept {
 		// Only test the determining fields, not the character widths and values derived from this
-		return doc == other.doc &&
+		return window == other.window &&
 			position == other.position &&
 			characterIndex == other.characterIndex;
 	}
 	bool operator!=(const UTF8Iterator &other) const noexcept {
 		// Only test the determining fields, not the character widths and values derived from this
-		return doc != other.doc ||
+		return window != other.window ||
 			position != other.position ||
 			characterIndex != other.characterIndex;
 	}
@@ -2905,7 +3308,7 @@ public:
 	}
 private:
 	void ReadCharacter() noexcept {
-		const Document::CharacterExtracted charExtracted = doc->ExtractCharacter(position);
+		const Document::CharacterExtracted charExtracted = window->ExtractCharacter(position);
 		lenBytes = charExtracted.widthBytes;
 		if (charExtracted.character == unicodeReplacementChar) {
 			lenCharacters = 1;
@@ -2921,7 +3324,7 @@ private:
 // On Unix, report non-BMP characters as single characters
 
 class UTF8Iterator {
-	const Document *doc;
+	const TextWindow *window;
 	Sci::Position position;
 public:
 	typedef std::bidirectional_iterator_tag iterator_category;
@@ -2930,17 +3333,17 @@ public:
 	typedef wchar_t* pointer;
 	typedef wchar_t& reference;
 
-	UTF8Iterator(const Document *doc_=nullptr, Sci::Position position_=0) noexcept :
-		doc(doc_), position(position_) {
+	UTF8Iterator(const TextWindow *window_=nullptr, Sci::Position position_=0) noexcept :
+		window(window_), position(position_) {
 	}
 	UTF8Iterator(const UTF8Iterator &other) noexcept {
-		doc = other.doc;
+		window = other.window;
 		position = other.position;
 	}
 	UTF8Iterator(UTF8Iterator &&other) noexcept = default;
 	UTF8Iterator &operator=(const UTF8Iterator &other) noexcept {
 		if (this != &other) {
-			doc = other.doc;
+			window = other.window;
 			position = other.position;
 		}
 		return *this;
@@ -2948,27 +3351,27 @@ public:
 	UTF8Iterator &operator=(UTF8Iterator &&) noexcept = default;
 	~UTF8Iterator() = default;
 	wchar_t operator*() const noexcept {
-		const Document::CharacterExtracted charExtracted = doc->ExtractCharacter(position);
+		const Document::CharacterExtracted charExtracted = window->ExtractCharacter(position);
 		return charExtracted.character;
 	}
 	UTF8Iterator &operator++() noexcept {
-		position = doc->NextPosition(position, 1);
+		position = window->NextPosition(position, 1);
 		return *this;
 	}
 	UTF8Iterator operator++(int) noexcept {
 		UTF8Iterator retVal(*this);
-		position = doc->NextPosition(position, 1);
+		position = window->NextPosition(position, 1);
 		return retVal;
 	}
 	UTF8Iterator &operator--() noexcept {
-		position = doc->NextPosition(position, -1);
+		position = window->NextPosition(position, -1);
 		return *this;
 	}
 	bool operator==(const UTF8Iterator &other) const noexcept {
-		return doc == other.doc && position == other.position;
+		return window == other.window && position == other.position;
 	}
 	bool operator!=(const UTF8Iterator &other) const noexcept {
-		return doc != other.doc || position != other.position;
+		return window != other.window || position != other.position;
 	}
 	Sci::Position Pos() const noexcept {
 		return position;
@@ -2990,7 +3393,9 @@ std::regex_constants::match_flag_type MatchFlags(const Document *doc, Sci::Posit
 }
 
 template<typename Iterator, typename Regex>
-bool MatchOnLines(const Document *doc, const Regex &regexp, const RESearchRange &resr, RESearch &search) {
+bool MatchOnLines(TextWindow &window, const Regex &regexp, const RESearchRange &resr, RESearch &search,
+	const std::string &prefix, bool caseSensitive) {
+	const Document *doc = window.Doc();
 	std::match_results<Iterator> match;
 
 	// MSVC and libc++ have problems with ^ and $ matching line ends inside a range.
@@ -3001,24 +3406,27 @@ bool MatchOnLines(const Document *doc, const Regex &regexp, const RESearchRange
 	// If multiline regex worked well then the line by line iteration could be removed
 	// for the forwards case and replaced with the following 4 lines:
 #ifdef REGEX_MULTILINE
-	Iterator itStart(doc, resr.startPos);
-	Iterator itEnd(doc, resr.endPos);
+	Iterator itStart(&window, resr.startPos);
+	Iterator itEnd(&window, resr.endPos);
 	const std::regex_constants::match_flag_type flagsMatch = MatchFlags(doc, resr.startPos, resr.endPos);
 	const bool matched = std::regex_search(itStart, itEnd, match, regexp, flagsMatch);
 #else
 	// Line by line.
 	bool matched = false;
 	for (Sci::Line line = resr.lineRangeStart; line != resr.lineRangeBreak; line += resr.increment) {
+		line = window.CandidateLine(line, resr, prefix, caseSensitive);
+		if (line == resr.lineRangeBreak)
+			break;
 		const Range lineRange = resr.LineRange(line);
-		Iterator itStart(doc, lineRange.start);
-		Iterator itEnd(doc, lineRange.end);
+		Iterator itStart(&window, lineRange.start);
+		Iterator itEnd(&window, lineRange.end);
 		std::regex_constants::match_flag_type flagsMatch = MatchFlags(doc, lineRange.start, lineRange.end);
 		matched = std::regex_search(itStart, itEnd, match, regexp, flagsMatch);
 		// Check for the last match on this line.
 		if (matched) {
 			if (resr.increment == -1) {
 				while (matched) {
-					Iterator itNext(doc, match[0].second.PosRoundUp());
+					Iterator itNext(&window, match[0].second.PosRoundUp());
 					flagsMatch = MatchFlags(doc, itNext.Pos(), lineRange.end);
 					std::match_results<Iterator> matchNext;
 					matched = std::regex_search(itNext, itEnd, matchNext, regexp, flagsMatch);
@@ -3043,15 +3451,15 @@ bool MatchOnLines(const Document *doc, const Regex &regexp, const RESearchRange
 			const Sci::Position lenMatch = search.eopat[co] - search.bopat[co];
 			search.pat[co].resize(lenMatch);
 			for (Sci::Position iPos = 0; iPos < lenMatch; iPos++) {
-				search.pat[co][iPos] = doc->CharAt(iPos + search.bopat[co]);
+				search.pat[co][iPos] = window.CharAt(iPos + search.bopat[co]);
 			}
 		}
 	}
 	return matched;
 }
 
-Sci::Position Cxx11RegexFindText(const Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
-	bool caseSensitive, Sci::Position *length, RESearch &search) {
+Sci::Position Cxx11RegexFindText(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
+	bool caseSensitive, Sci::Position *length, RESearch &search, Cxx11RegexCompiled &compiled) {
 	const RESearchRange resr(doc, minPos, maxPos);
 	try {
 		//ElapsedPeriod ep;
@@ -3061,20 +3469,31 @@ Sci::Position Cxx11RegexFindText(const Document *doc, Sci::Position minPos, Sci:
 		if (!caseSensitive)
 			flagsRe = flagsRe | std::regex::icase;
 
+		const bool unicode = SC_CP_UTF8 == doc->dbcsCodePage;
+		if (!compiled.valid || (compiled.pattern != s) || (compiled.flags != flagsRe) || (compiled.unicode != unicode)) {
+			compiled.valid = false;
+			if (unicode) {
+				const std::wstring ws = WStringFromUTF8(s);
+				compiled.wregexp.assign(ws, flagsRe);
+			} else {
+				compiled.regexp.assign(s, flagsRe);
+			}
+			compiled.pattern = s;
+			compiled.flags = flagsRe;
+			compiled.unicode = unicode;
+			compiled.prefix = LiteralPrefix(s, strlen(s), caseSensitive, true);
+			compiled.valid = true;
+		}
+
 		// Clear the RESearch so can fill in matches
 		search.Clear();
 
+		TextWindow window(doc);
 		bool matched = false;
-		if (SC_CP_UTF8 == doc->dbcsCodePage) {
-			const std::wstring ws = WStringFromUTF8(s);
-			std::wregex regexp;
-			regexp.assign(ws, flagsRe);
-			matched = MatchOnLines<UTF8Iterator>(doc, regexp, resr, search);
-
+		if (unicode) {
+			matched = MatchOnLines<UTF8Iterator>(window, compiled.wregexp, resr, search, compiled.prefix, caseSensitive);
 		} else {
-			std::regex regexp;
-			regexp.assign(s, flagsRe);
-			matched = MatchOnLines<ByteIterator>(doc, regexp, resr, search);
+			matched = MatchOnLines<ByteIterator>(window, compiled.regexp, resr, search, compiled.prefix, caseSensitive);
 		}
 
 		Sci::Position posMatch = -1;
@@ -3108,7 +3527,7 @@ Sci::Position BuiltinRegex::FindText(Document *doc, Sci::Position minPos, Sci::P
 #ifndef NO_CXX11_REGEX
 	if (flags & SCFIND_CXX11REGEX) {
 			return Cxx11RegexFindText(doc, minPos, maxPos, s,
-			caseSensitive, length, search);
+			caseSensitive, length, search, cxx11Compiled);
 	}
 #endif
 
@@ -3116,9 +3535,23 @@ Sci::Position BuiltinRegex::FindText(Document *doc, Sci::Position minPos, Sci::P
 
 	const bool posix = (flags & SCFIND_POSIX) != 0;
 
-	const char *errmsg = search.Compile(s, *length, caseSensitive, posix);
-	if (errmsg) {
-		return -1;
+	const std::string_view pattern(s, *length);
+	unsigned char wordCharacters[256] {};
+	const int lengthWordCharacters = doc->GetCharsOfClass(CharClassify::ccWord, wordCharacters);
+	const std::string_view words(reinterpret_cast<const char *>(wordCharacters), lengthWordCharacters);
+	if (compiledPattern.empty() || (compiledPattern != pattern) ||
+		(compiledCaseSensitive != caseSensitive) || (compiledPosix != posix) ||
+		(compiledWordCharacters != words)) {
+		compiledPattern.clear();
+		const char *errmsg = search.Compile(s, *length, caseSensitive, posix);
+		if (errmsg) {
+			return -1;
+		}
+		compiledPattern = pattern;
+		compiledCaseSensitive = caseSensitive;
+		compiledPosix = posix;
+		compiledWordCharacters = words;
+		compiledPrefix = LiteralPrefix(s, *length, caseSensitive, false);
 	}
 	// Find a variable in a property file: \$(\([A-Za-z0-9_.]+\))
 	// Replace first '.' with '-' in each property file variable reference:
@@ -3130,7 +3563,11 @@ Sci::Position BuiltinRegex::FindText(Document *doc, Sci::Position minPos, Sci::P
 	const char searchEnd = s[*length - 1];
 	const char searchEndPrev = (*length > 1) ? s[*length - 2] : '\0';
 	const bool searchforLineEnd = (searchEnd == '$') && (searchEndPrev != '\\');
+	TextWindow window(doc);
 	for (Sci::Line line = resr.lineRangeStart; line != resr.lineRangeBreak; line += resr.increment) {
+		line = window.CandidateLine(line, resr, compiledPrefix, caseSensitive);
+		if (line == resr.lineRangeBreak)
+			break;
 		Sci::Position startOfLine = doc->LineStart(line);
 		Sci::Position endOfLine = doc->LineEnd(line);
 		if (resr.increment == 1) {
@@ -3157,7 +3594,7 @@ Sci::Position BuiltinRegex::FindText(Document *doc, Sci::Position minPos, Sci::P
 			}
 		}
 
-		const DocumentIndexer di(doc, endOfLine);
+		const DocumentIndexer di(window, endOfLine);
 		int success = search.Execute(di, startOfLine, endOfLine);
 		if (success) {
 			pos = search.bopat[0];
@@ -3189,7 +3626,8 @@ Sci::Position BuiltinRegex::FindText(Document *doc, Sci::Position minPos, Sci::P
 
 const char *BuiltinRegex::SubstituteByPosition(Document *doc, const char *text, Sci::Position *length) {
 	substituted.clear();
-	const DocumentIndexer di(doc, doc->Length());
+	const TextWindow window(doc);
+	const DocumentIndexer di(window, doc->Length());
 	search.GrabMatches(di);
 	for (Sci::Position j = 0; j < *length; j++) {
 		if (text[j] == '\\') {
@@ -17,6 +17,7 @@ class LineMarkers;
 class LineLevels;
 class LineState;
 class LineAnnotation;
+class BackgroundStyler;
 
 enum EncodingFamily { efEightBit, efUnicode, efDBCS };
 
@@ -179,6 +180,7 @@ public:
 	virtual ~LexInterface() {
 	}
 	void Colourise(Sci::Position start, Sci::Position end);
+	void ColouriseSnapshot(IDocument *pAccess, Sci::Position start, Sci::Position end, int styleStart);
 	virtual int LineEndTypesSupported();
 	bool UseContainerLexing() const noexcept {
 		return instance == nullptr;
@@ -211,7 +213,7 @@ public:
 
 /**
  */
-class Document : PerLine, public IDocument, public ILoader {
+class Document : PerLine, public IDocumentRangePointer, public ILoader {
 
 public:
 	/** Used to pair watcher pointer with user data. */
@@ -254,7 +256,11 @@ private:
 
 	bool matchesValid;
 	std::unique_ptr<RegexSearchBase> regex;
+	// Used by FindTextRetainingGroups so the groups found by regex are not replaced
+	std::unique_ptr<RegexSearchBase> regexRetaining;
 	std::unique_ptr<LexInterface> pli;
+	// Declared after pli so it is destroyed first as its worker may be using the lexer.
+	std::unique_ptr<BackgroundStyler> backgroundStyler;
 
 public:
 
@@ -280,6 +286,8 @@ public:
 	bool useTabs;
 	bool tabIndents;
 	bool backspaceUnindents;
+	/// Maximum threads used to style large ranges with lexers that support ILexerCheckpoints
+	int stylingThreads;
 	ActionDuration durationStyleOneLine;
 
 	std::unique_ptr<IDecorationList> decorations;
@@ -298,6 +306,7 @@ public:
 	// From PerLine
 	void Init() override;
 	void InsertLine(Sci::Line line) override;
+	void InsertLines(Sci::Line line, Sci::Line lines) override;
 	void RemoveLine(Sci::Line line) override;
 
 	int LineEndTypesSupported() const;
@@ -307,7 +316,7 @@ public:
 	int GetLineEndTypesActive() const { return cb.GetLineEndTypes(); }
 
 	int SCI_METHOD Version() const override {
-		return dvRelease4;
+		return dvRangePointer;
 	}
 
 	void SCI_METHOD SetErrorStatus(int status) override;
@@ -349,6 +358,8 @@ public:
 	bool CanUndo() const { return cb.CanUndo(); }
 	bool CanRedo() const { return cb.CanRedo(); }
 	void DeleteUndoHistory() { cb.DeleteUndoHistory(); }
+	void SetUndoMemoryLimit(Sci::Position limit) { cb.SetUndoMemoryLimit(limit); }
+	Sci::Position GetUndoMemoryLimit() const noexcept { return cb.GetUndoMemoryLimit(); }
 	bool SetUndoCollection(bool collectUndo) {
 		return cb.SetUndoCollection(collectUndo);
 	}
@@ -365,7 +376,7 @@ public:
 	bool TentativeActive() const { return cb.TentativeActive(); }
 
 	const char * SCI_METHOD BufferPointer() override { return cb.BufferPointer(); }
-	const char *RangePointer(Sci::Position position, Sci::Position rangeLength) { return cb.RangePointer(position, rangeLength); }
+	const char * SCI_METHOD RangePointer(Sci_Position position, Sci_Position rangeLength) override { return cb.RangePointer(position, rangeLength); }
 	Sci::Position GapPosition() const { return cb.GapPosition(); }
 
 	int SCI_METHOD GetLineIndentation(Sci_Position line) override;
@@ -436,6 +447,7 @@ public:
 	bool HasCaseFolder() const noexcept;
 	void SetCaseFolder(CaseFolder *pcf_);
 	Sci::Position FindText(Sci::Position minPos, Sci::Position maxPos, const char *search, int flags, Sci::Position *length);
+	Sci::Position FindTextRetainingGroups(Sci::Position minPos, Sci::Position maxPos, const char *search, int flags, Sci::Position *length);
 	const char *SubstituteByPosition(const char *text, Sci::Position *length);
 	int LineCharacterIndex() const;
 	void AllocateLineCharacterIndex(int lineCharacterIndex);
@@ -453,6 +465,8 @@ public:
 	Sci::Position GetEndStyled() const noexcept { return endStyled; }
 	void EnsureStyledTo(Sci::Position pos);
 	void StyleToAdjustingLineDuration(Sci::Position pos);
+	bool StyleInBackground(Sci::Position pos, double secondsAllowed);
+	void FinishBackgroundStyling();
 	void LexerChanged();
 	int GetStyleClock() const noexcept { return styleClock; }
 	void IncrementStyleClock() noexcept;
@@ -495,6 +509,7 @@ public:
 	Sci::Position BraceMatch(Sci::Position position, Sci::Position maxReStyle);
 
 private:
+	Sci::Position CountUTF8(Sci::Position startPos, Sci::Position endPos, bool countUTF16) const;
 	void NotifyModifyAttempt();
 	void NotifySavePoint(bool atSavePoint);
 	void NotifyModified(DocModification mh);
@@ -562,7 +577,7 @@ public:
 		position(act.position),
 		length(act.lenData),
 		linesAdded(linesAdded_),
-		text(act.data.get()),
+		text(act.data),
 		line(0),
 		foldLevelNow(0),
 		foldLevelPrev(0),
@@ -587,6 +602,29 @@ public:
 	virtual void NotifyErrorOccurred(Document *doc, void *userData, int status) = 0;
 };
 
+/**
+ * Byte positions of every stepCharacters'th character of recently used long lines so that
+ * converting a character offset inside one of those lines does not count from the line start.
+ * The owner must call Modified for every insertion and deletion.
+ */
+class LineCharacterCache {
+	struct LineSteps {
+		Sci::Line line;
+		std::vector<Sci::Position> steps;	// Relative to line start
+	};
+	std::vector<LineSteps> lines;	// Most recently used last
+	const LineSteps *Steps(const Document *pdoc, Sci::Line line);
+public:
+	static constexpr Sci::Position stepCharacters = 64;
+	static constexpr Sci::Position lengthCached = 1024;
+	static constexpr size_t linesCached = 8;
+	Sci::Position CharactersBefore(const Document *pdoc, Sci::Line line, Sci::Position byteOffset);
+	Sci::Position PositionOfCharacter(const Document *pdoc, Sci::Line line, Sci::Position characterInLine);
+	void Modified(Sci::Line line, Sci::Line linesAdded);
+	void Clear() noexcept;
+	size_t LinesCached() const noexcept;
+};
+
 }
 
 #endif
@@ -343,12 +343,18 @@ LineLayout *EditView::RetrieveLineLayout(Sci::Line lineNumber, const EditModel &
 		model.LinesOnScreen() + 1, model.pdoc->LinesTotal());
 }
 
+void EditView::LayoutLine(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle, LineLayout *ll, int width) {
+	LayoutLine(model, line, surface, vstyle, ll, width, posCache);
+}
+
 /**
 * Fill in the LineLayout data for the given line.
 * Copy the given @a line and its styles from the document into local arrays.
 * Also determine the x position at which each character starts.
+* Only @a ll and @a cache are modified so, when each thread has its own surface, line layout
+* and position cache, lines may be laid out on multiple threads at once.
 */
-void EditView::LayoutLine(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle, LineLayout *ll, int width) {
+void EditView::LayoutLine(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle, LineLayout *ll, int width, PositionCache &cache) const {
 	if (!ll)
 		return;
 
@@ -473,7 +479,7 @@ void EditView::LayoutLine(const EditModel &model, Sci::Line line, Surface *surfa
 					} else {
 						if (representationWidth <= 0.0) {
 							XYPOSITION positionsRepr[256];	// Should expand when needed
-							posCache.MeasureWidths(surface, vstyle, STYLE_CONTROLCHAR, ts.representation->stringRep.c_str(),
+							cache.MeasureWidths(surface, vstyle, STYLE_CONTROLCHAR, ts.representation->stringRep.c_str(),
 								static_cast<unsigned int>(ts.representation->stringRep.length()), positionsRepr, model.pdoc);
 							representationWidth = positionsRepr[ts.representation->stringRep.length() - 1] + vstyle.ctrlCharPadding;
 						}
@@ -485,7 +491,7 @@ void EditView::LayoutLine(const EditModel &model, Sci::Line line, Surface *surfa
 						// Over half the segments are single characters and of these about half are space characters.
 						ll->positions[ts.start + 1] = vstyle.styles[ll->styles[ts.start]].spaceWidth;
 					} else {
-						posCache.MeasureWidths(surface, vstyle, ll->styles[ts.start], &ll->chars[ts.start],
+						cache.MeasureWidths(surface, vstyle, ll->styles[ts.start], &ll->chars[ts.start],
 							ts.length, &ll->positions[ts.start + 1], model.pdoc);
 					}
 				}
@@ -627,6 +633,21 @@ void EditView::UpdateBidiData(const EditModel &model, const ViewStyle &vstyle, L
 	}
 }
 
+// Extract the indicator runs over the line once so that each drawing phase and text segment
+// scans only those runs. They are kept until the decorations change or the line moves.
+
+void EditView::UpdateDecorationSpans(const EditModel &model, Sci::Line line, LineLayout *ll) {
+	const Sci::Position posLineStart = model.pdoc->LineStart(line);
+	const size_t version = model.pdoc->decorations->Version();
+	if ((ll->decorationsLineStart != posLineStart) || (ll->decorationsVersion != version)) {
+		ll->decorationSpans.clear();
+		model.pdoc->decorations->SpansIntersecting(posLineStart, posLineStart + ll->numCharsInLine,
+			ll->decorationSpans);
+		ll->decorationsVersion = version;
+		ll->decorationsLineStart = posLineStart;
+	}
+}
+
 Point EditView::LocationFromPosition(Surface *surface, const EditModel &model, SelectionPosition pos, Sci::Line topLine,
 				     const ViewStyle &vs, PointEnd pe, const PRectangle rcClient) {
 	Point pt;
@@ -1139,28 +1160,19 @@ static void DrawIndicators(Surface *surface, const EditModel &model, const ViewS
 	const Sci::Position lineStart = ll->LineStart(subLine);
 	const Sci::Position posLineEnd = posLineStart + lineEnd;
 
-	for (const IDecoration *deco : model.pdoc->decorations->View()) {
-		if (under == vsDraw.indicators[deco->Indicator()].under) {
-			Sci::Position startPos = posLineStart + lineStart;
-			if (!deco->ValueAt(startPos)) {
-				startPos = deco->EndRun(startPos);
-			}
-			while ((startPos < posLineEnd) && (deco->ValueAt(startPos))) {
-				const Range rangeRun(deco->StartRun(startPos), deco->EndRun(startPos));
-				const Sci::Position endPos = std::min(rangeRun.end, posLineEnd);
-				const bool hover = vsDraw.indicators[deco->Indicator()].IsDynamic() &&
-					rangeRun.ContainsCharacter(model.hoverIndicatorPos);
-				const int value = deco->ValueAt(startPos);
-				const Indicator::DrawState drawState = hover ? Indicator::drawHover : Indicator::drawNormal;
-				const Sci::Position posSecond = model.pdoc->MovePositionOutsideChar(rangeRun.First() + 1, 1);
-				DrawIndicator(deco->Indicator(), startPos - posLineStart, endPos - posLineStart,
-					surface, vsDraw, ll, xStart, rcLine, posSecond - posLineStart, subLine, drawState,
-					value, model.BidirectionalEnabled(), tabWidthMinimumPixels);
-				startPos = endPos;
-				if (!deco->ValueAt(startPos)) {
-					startPos = deco->EndRun(startPos);
-				}
-			}
+	for (const DecorationSpan &span : ll->decorationSpans) {
+		if ((under == vsDraw.indicators[span.indicator].under) &&
+			(span.start < posLineEnd) && (span.end > posLineStart + lineStart)) {
+			const Range rangeRun(span.start, span.end);
+			const Sci::Position startPos = std::max(rangeRun.start, posLineStart + lineStart);
+			const Sci::Position endPos = std::min(rangeRun.end, posLineEnd);
+			const bool hover = vsDraw.indicators[span.indicator].IsDynamic() &&
+				rangeRun.ContainsCharacter(model.hoverIndicatorPos);
+			const Indicator::DrawState drawState = hover ? Indicator::drawHover : Indicator::drawNormal;
+			const Sci::Position posSecond = model.pdoc->MovePositionOutsideChar(rangeRun.First() + 1, 1);
+			DrawIndicator(span.indicator, startPos - posLineStart, endPos - posLineStart,
+				surface, vsDraw, ll, xStart, rcLine, posSecond - posLineStart, subLine, drawState,
+				span.value, model.BidirectionalEnabled(), tabWidthMinimumPixels);
 		}
 	}
 
@@ -1802,10 +1814,10 @@ void EditView::DrawForeground(Surface *surface, const EditModel &model, const Vi
 			}
 			if (vsDraw.indicatorsSetFore) {
 				// At least one indicator sets the text colour so see if it applies to this segment
-				for (const IDecoration *deco : model.pdoc->decorations->View()) {
-					const int indicatorValue = deco->ValueAt(ts.start + posLineStart);
-					if (indicatorValue) {
-						const Indicator &indicator = vsDraw.indicators[deco->Indicator()];
+				for (const DecorationSpan &span : ll->decorationSpans) {
+					if ((span.start <= ts.start + posLineStart) && (span.end > ts.start + posLineStart)) {
+						const int indicatorValue = span.value;
+						const Indicator &indicator = vsDraw.indicators[span.indicator];
 						const bool hover = indicator.IsDynamic() &&
 							((model.hoverIndicatorPos >= ts.start + posLineStart) &&
 							(model.hoverIndicatorPos <= ts.end() + posLineStart));
@@ -2230,6 +2242,8 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, PRectan
 						UpdateBidiData(model, vsDraw, ll);
 					}
 
+					UpdateDecorationSpans(model, lineDoc, ll);
+
 					DrawLine(surface, model, vsDraw, ll, lineDoc, visibleLine, xStart, rcLine, subLine, phase);
 #if defined(TIME_PAINTING)
 					durPaint += ep.Duration(true);
@@ -2506,6 +2520,7 @@ Sci::Position EditView::FormatRange(bool draw, const Sci_RangeToFormat *pfr, Sur
 
 		// Draw the line
 		surface->FlushCachedState();
+		UpdateDecorationSpans(model, lineDoc, &ll);
 
 		for (int iwl = 0; iwl < ll.lines; iwl++) {
 			if (ypos + vsPrint.lineHeight <= pfr->rc.bottom) {
@@ -22,6 +22,9 @@
 #include <iterator>
 #include <memory>
 #include <chrono>
+#include <atomic>
+#include <future>
+#include <thread>
 
 #include "Platform.h"
 
@@ -165,6 +168,7 @@ Editor::Editor() : durationWrapOneLine(0.00001, 0.000001, 0.0001) {
 	multipleSelection = false;
 	additionalSelectionTyping = false;
 	multiPasteMode = SC_MULTIPASTE_ONCE;
+	changingSelectionsTogether = false;
 	virtualSpaceOptions = SCVS_NONE;
 
 	targetStart = 0;
@@ -184,7 +188,11 @@ Editor::Editor() : durationWrapOneLine(0.00001, 0.000001, 0.0001) {
 	paintingAllText = false;
 	willRedrawAll = false;
 	idleStyling = SC_IDLESTYLING_NONE;
+	idleStylingThreaded = false;
+	layoutThreads = 1;
+	linesDisplayedScrollBars = 0;
 	needIdleStyling = false;
+	matchHighlightStyle = -1;
 
 	modEventMask = SC_MODEVENTMASKALL;
 	commandEvents = true;
@@ -850,7 +858,7 @@ void Editor::MovedCaret(SelectionPosition newPos, SelectionPosition previousPos,
 	if (ensureVisible) {
 		// In case in need of wrapping to ensure DisplayFromDoc works.
 		if (currentLine >= wrapPending.start) {
-			if (WrapLines(WrapScope::wsAll)) {
+			if (WrapLines(WrapScope::wsNear, currentLine)) {
 				Redraw();
 			}
 		}
@@ -1494,12 +1502,112 @@ bool Editor::WrapOneLine(Surface *surface, Sci::Line lineToWrap) {
 		(vs.annotationVisible ? pdoc->AnnotationLines(lineToWrap) : 0));
 }
 
+// Wrap a range of lines on up to layoutThreads threads.
+// Each thread lays out lines with its own surface, position cache and line layout while
+// the document and view style are only read, so the line layout cache is not updated.
+// The resulting heights are applied on this thread after all threads have finished.
+bool Editor::WrapBlock(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToWrapEnd) {
+	// Threads take lines in blocks to reduce contention while balancing uneven line lengths.
+	constexpr Sci::Line linesPerBlock = 64;
+	const Sci::Line linesBeingWrapped = lineToWrapEnd - lineToWrap;
+	const int threads = static_cast<int>(std::min<Sci::Line>(layoutThreads,
+		(linesBeingWrapped + linesPerBlock - 1) / linesPerBlock));
+	std::vector<std::unique_ptr<AutoSurface>> surfaces;
+	for (int thread = 1; thread < threads; thread++) {
+		// Surfaces are created here as platforms may only allow this on the user interface thread.
+		surfaces.push_back(std::make_unique<AutoSurface>(this));
+	}
+	// Each thread has its own position cache which falls back to reading view.posCache.
+	// This is safe without locking as view.posCache is not modified until all threads finish.
+	std::vector<std::unique_ptr<PositionCache>> caches;
+	for (int thread = 0; thread < threads; thread++) {
+		caches.push_back(std::make_unique<PositionCache>(&view.posCache));
+	}
+
+	std::vector<int> linesWrapped(linesBeingWrapped, 1);
+	std::atomic<Sci::Line> lineNextBlock(lineToWrap);
+	auto layoutBlocks = [&](Surface *surfaceThread, PositionCache *posCacheThread) {
+		std::unique_ptr<LineLayout> ll;
+		for (;;) {
+			const Sci::Line lineBlock = lineNextBlock.fetch_add(linesPerBlock);
+			if (lineBlock >= lineToWrapEnd) {
+				break;
+			}
+			const Sci::Line lineBlockEnd = std::min(lineBlock + linesPerBlock, lineToWrapEnd);
+			for (Sci::Line line = lineBlock; line < lineBlockEnd; line++) {
+				const int lengthLine = static_cast<int>(pdoc->LineStart(line + 1) - pdoc->LineStart(line));
+				if (!ll || (ll->maxLineLength < lengthLine)) {
+					ll = std::make_unique<LineLayout>(lengthLine);
+				}
+				ll->Invalidate(LineLayout::llInvalid);
+				view.LayoutLine(*this, line, surfaceThread, vs, ll.get(), wrapWidth, *posCacheThread);
+				linesWrapped[line - lineToWrap] = ll->lines;
+			}
+		}
+	};
+	std::vector<std::future<void>> layouts;
+	for (size_t thread = 1; thread < caches.size(); thread++) {
+		layouts.push_back(std::async(std::launch::async, layoutBlocks,
+			static_cast<Surface *>(*surfaces[thread - 1]), caches[thread].get()));
+	}
+	layoutBlocks(surface, caches[0].get());
+	for (std::future<void> &layout : layouts) {
+		layout.get();
+	}
+	for (const std::unique_ptr<PositionCache> &cache : caches) {
+		view.posCache.AddStatistics(*cache);
+	}
+
+	bool wrapOccurred = false;
+	for (Sci::Line line = lineToWrap; line < lineToWrapEnd; line++) {
+		if (pcs->SetHeight(line, linesWrapped[line - lineToWrap] +
+			(vs.annotationVisible ? pdoc->AnnotationLines(line) : 0))) {
+			wrapOccurred = true;
+		}
+		wrapPending.Wrapped(line);
+	}
+	return wrapOccurred;
+}
+
+int Editor::WrapWidthFromClient() {
+	PRectangle rcTextArea = GetClientRectangle();
+	rcTextArea.left = static_cast<XYPOSITION>(vs.textStart);
+	rcTextArea.right -= vs.rightMarginWidth;
+	return static_cast<int>(rcTextArea.Width());
+}
+
+// Set the heights of lines that have not yet been wrapped from their length and the average
+// character width so that the scroll bars are close to their final size without laying out
+// each line. Wrapping the lines later replaces these estimates with the real heights.
+// Return true if any height changed.
+bool Editor::EstimateWrapHeights(Sci::Line lineStart, Sci::Line lineEnd) {
+	if (!Wrapping() || (wrapWidth == LineLayout::wrapWidthInfinite) || (wrapWidth <= 0)) {
+		return false;
+	}
+	RefreshStyleData();
+	const XYPOSITION widthChar = std::max<XYPOSITION>(vs.aveCharWidth, 1.0f);
+	lineEnd = std::min(lineEnd, pdoc->LinesTotal());
+	bool changed = false;
+	for (Sci::Line line = std::max<Sci::Line>(lineStart, 0); line < lineEnd; line++) {
+		const XYPOSITION widthLine = static_cast<XYPOSITION>(pdoc->LineEnd(line) - pdoc->LineStart(line)) * widthChar;
+		const int subLines = std::max(static_cast<int>(std::ceil(widthLine / wrapWidth)), 1);
+		if (pcs->SetHeight(line, subLines +
+			(vs.annotationVisible ? pdoc->AnnotationLines(line) : 0))) {
+			changed = true;
+		}
+	}
+	return changed;
+}
+
 // Perform  wrapping for a subset of the lines needing wrapping.
 // wsAll: wrap all lines which need wrapping in this single call
 // wsVisible: wrap currently visible lines
 // wsIdle: wrap one page + 100 lines
+// wsNear: wrap a page either side of lineNear which is about to be shown
+// Lines not yet wrapped have estimated heights so the scroll position is kept at the same
+// document line as the estimates are replaced.
 // Return true if wrapping occurred.
-bool Editor::WrapLines(WrapScope ws) {
+bool Editor::WrapLines(WrapScope ws, Sci::Line lineNear) {
 	Sci::Line goodTopLine = topLine;
 	bool wrapOccurred = false;
 	if (!Wrapping()) {
@@ -1541,26 +1649,40 @@ bool Editor::WrapLines(WrapScope ws) {
 				// Currently visible text does not need wrapping
 				return false;
 			}
+		} else if (ws == WrapScope::wsNear) {
+			// The line may be shown at the top or bottom of the window.
+			const Sci::Line linesAround = LinesOnScreen() + 1;
+			lineToWrap = std::clamp(lineNear - linesAround, wrapPending.start, pdoc->LinesTotal());
+			lineToWrapEnd = lineNear + linesAround;
+			if ((lineToWrap > wrapPending.end) || (lineToWrapEnd < wrapPending.start)) {
+				return false;
+			}
 		} else if (ws == WrapScope::wsIdle) {
 			// Try to keep time taken by wrapping reasonable so interaction remains smooth.
 			const double secondsAllowed = 0.01;
 			const Sci::Line linesInAllowedTime = std::clamp<Sci::Line>(
 				static_cast<Sci::Line>(secondsAllowed / durationWrapOneLine.Duration()),
-				LinesOnScreen() + 50, 0x10000);
+				LinesOnScreen() + 50, 0x10000 * layoutThreads);
 			lineToWrapEnd = lineToWrap + linesInAllowedTime;
 		}
 		const Sci::Line lineEndNeedWrap = std::min(wrapPending.end, pdoc->LinesTotal());
 		lineToWrapEnd = std::min(lineToWrapEnd, lineEndNeedWrap);
 
+		// When the width changes all the pending heights are out of date so estimate
+		// them before wrapping the lines that are needed now.
+		const int wrapWidthClient = WrapWidthFromClient();
+		if (wrapWidth != wrapWidthClient) {
+			wrapWidth = wrapWidthClient;
+			if (EstimateWrapHeights(wrapPending.start, lineEndNeedWrap)) {
+				wrapOccurred = true;
+			}
+		}
+
 		// Ensure all lines being wrapped are styled.
 		pdoc->EnsureStyledTo(pdoc->LineStart(lineToWrapEnd));
 
 		if (lineToWrap < lineToWrapEnd) {
 
-			PRectangle rcTextArea = GetClientRectangle();
-			rcTextArea.left = static_cast<XYPOSITION>(vs.textStart);
-			rcTextArea.right -= vs.rightMarginWidth;
-			wrapWidth = static_cast<int>(rcTextArea.Width());
 			RefreshStyleData();
 			AutoSurface surface(this);
 			if (surface) {
@@ -1568,6 +1690,16 @@ bool Editor::WrapLines(WrapScope ws) {
 
 				const Sci::Line linesBeingWrapped = lineToWrapEnd - lineToWrap;
 				ElapsedPeriod epWrapping;
+				// Threads are only worthwhile when there are many lines, so visible area
+				// wrapping, which is only about a page, stays on this thread.
+				const Sci::Line linesMinimumThreaded = 1000;
+				if ((layoutThreads > 1) && (linesBeingWrapped >= linesMinimumThreaded) &&
+					surface->ThreadSafeMeasureWidths()) {
+					if (WrapBlock(surface, lineToWrap, lineToWrapEnd)) {
+						wrapOccurred = true;
+					}
+					lineToWrap = lineToWrapEnd;
+				}
 				while (lineToWrap < lineToWrapEnd) {
 					if (WrapOneLine(surface, lineToWrap)) {
 						wrapOccurred = true;
@@ -1576,12 +1708,14 @@ bool Editor::WrapLines(WrapScope ws) {
 					lineToWrap++;
 				}
 				durationWrapOneLine.AddSample(linesBeingWrapped, epWrapping.Duration());
-
-				goodTopLine = pcs->DisplayFromDoc(lineDocTop) + std::min(
-					subLineTop, static_cast<Sci::Line>(pcs->GetHeight(lineDocTop)-1));
 			}
 		}
 
+		if (wrapOccurred) {
+			goodTopLine = pcs->DisplayFromDoc(lineDocTop) + std::min(
+				subLineTop, static_cast<Sci::Line>(pcs->GetHeight(lineDocTop)-1));
+		}
+
 		// If wrapping is done, bring it to resting position
 		if (wrapPending.start >= lineEndNeedWrap) {
 			wrapPending.Reset();
@@ -1589,9 +1723,19 @@ bool Editor::WrapLines(WrapScope ws) {
 	}
 
 	if (wrapOccurred) {
-		SetScrollBars();
+		// While wrapping in the background, heights are mostly replacing estimates so only
+		// update the scroll bars when they have drifted by more than a page or 1%.
+		const Sci::Line drift = std::abs(pcs->LinesDisplayed() - linesDisplayedScrollBars);
+		if ((ws != WrapScope::wsIdle) || !wrapPending.NeedsWrap() || (topLine > MaxScrollPos()) ||
+			(drift > std::max(LinesOnScreen(), linesDisplayedScrollBars / 100))) {
+			SetScrollBars();
+		}
 		SetTopLine(std::clamp<Sci::Line>(goodTopLine, 0, MaxScrollPos()));
 		SetVerticalScrollPos();
+	} else if ((ws == WrapScope::wsIdle) && !wrapPending.NeedsWrap() &&
+		(pcs->LinesDisplayed() != linesDisplayedScrollBars)) {
+		// Catch up with changes skipped during background wrapping.
+		SetScrollBars();
 	}
 
 	return wrapOccurred;
@@ -1834,6 +1978,7 @@ void Editor::SetScrollBars() {
 
 	const Sci::Line nMax = MaxScrollPos();
 	const Sci::Line nPage = LinesOnScreen();
+	linesDisplayedScrollBars = pcs->LinesDisplayed();
 	const bool modified = ModifyScrollBars(nMax + nPage - 1, nPage);
 	if (modified) {
 		DwellEnd(true);
@@ -1857,10 +2002,7 @@ void Editor::ChangeSize() {
 	DropGraphics(false);
 	SetScrollBars();
 	if (Wrapping()) {
-		PRectangle rcTextArea = GetClientRectangle();
-		rcTextArea.left = static_cast<XYPOSITION>(vs.textStart);
-		rcTextArea.right -= vs.rightMarginWidth;
-		if (wrapWidth != rcTextArea.Width()) {
+		if (wrapWidth != WrapWidthFromClient()) {
 			NeedWrapping();
 			Redraw();
 		}
@@ -1901,6 +2043,102 @@ void Editor::FilterSelections() {
 	}
 }
 
+namespace {
+
+// A selection that is changed along with the others when typing, pasting, or clearing.
+struct SelectionChange {
+	size_t selection;
+	SelectionRange original;
+	bool changed;
+};
+
+}
+
+/**
+ * Change every selection in document order then move the selections in one sweep instead of after
+ * each change which is much faster when there are many selections.
+ * Each selection is changed by ordinary deletions and insertions so each change is notified with its
+ * own position and text and other views move their selections as usual.
+ * When text is not null each selection is replaced with text as typing does, otherwise each non-empty
+ * selection is deleted. Protected selections are left unchanged.
+ * Returns false without any change when the selections should be changed one at a time: when there
+ * is only one or when they touch so changing one moves another.
+ */
+bool Editor::ReplaceSelectionsTogether(const char *text, Sci::Position len, bool overstrike) {
+	if ((sel.Count() < 2) || pdoc->IsReadOnly())
+		return false;
+
+	std::vector<SelectionChange> changes;
+	changes.reserve(sel.Count());
+	for (size_t r = 0; r < sel.Count(); r++) {
+		const SelectionRange &range = sel.Range(r);
+		const bool changed = (text || !range.Empty()) &&
+			!RangeContainsProtected(range.Start().Position(), range.End().Position());
+		changes.push_back({ r, range, changed });
+	}
+	std::sort(changes.begin(), changes.end(), [](const SelectionChange &a, const SelectionChange &b) {
+		return a.original.Start() < b.original.Start();
+	});
+
+	Sci::Position lastEnd = -1;
+	for (const SelectionChange &change : changes) {
+		const SelectionRange &range = change.original;
+		Sci::Position first = range.Start().Position();
+		Sci::Position last = range.End().Position();
+		if (change.changed && text && (range.Length() == 0)) {
+			if (range.Start().VirtualSpace() > 0) {
+				// Realizing virtual space after the indentation changes the whole indentation
+				const Sci::Line line = pdoc->SciLineFromPosition(first);
+				if (pdoc->GetLineIndentPosition(line) == first) {
+					first = pdoc->LineStart(line);
+				}
+			} else if (range.Empty() && overstrike && (first < pdoc->Length()) && !pdoc->IsPositionInLineEnd(first)) {
+				last = first + pdoc->LenChar(first);
+			}
+		}
+		if (first <= lastEnd) {
+			// Touching or overlapping selections are changed one at a time so each moves the others
+			return false;
+		}
+		lastEnd = last;
+	}
+
+	changingSelectionsTogether = true;
+	Sci::Position shift = 0;
+	for (const SelectionChange &change : changes) {
+		const SelectionRange &original = change.original;
+		SelectionRange &range = sel.Range(change.selection);
+		if (!change.changed) {
+			// Unchanged selections do not touch any change so just move by the changes before them
+			range = SelectionRange(
+				SelectionPosition(original.caret.Position() + shift, original.caret.VirtualSpace()),
+				SelectionPosition(original.anchor.Position() + shift, original.anchor.VirtualSpace()));
+			continue;
+		}
+		const Sci::Position lengthBefore = pdoc->Length();
+		Sci::Position position = original.Start().Position() + shift;
+		if (text) {
+			Sci::Position virtualSpace = original.Start().VirtualSpace();
+			if (original.Length()) {
+				pdoc->DeleteChars(position, original.Length());
+				virtualSpace = 0;
+			} else if (original.Empty() && overstrike && (position < pdoc->Length()) && !pdoc->IsPositionInLineEnd(position)) {
+				pdoc->DelChar(position);
+				virtualSpace = 0;
+			}
+			position = RealizeVirtualSpace(position, virtualSpace);
+			position += pdoc->InsertString(position, text, len);
+			range = SelectionRange(position);
+		} else {
+			pdoc->DeleteChars(position, original.Length());
+			range = SelectionRange(SelectionPosition(position, original.Start().VirtualSpace()));
+		}
+		shift += pdoc->Length() - lengthBefore;
+	}
+	changingSelectionsTogether = false;
+	return true;
+}
+
 // AddCharUTF inserts an array of bytes which may or may not be in UTF-8.
 void Editor::AddCharUTF(const char *s, unsigned int len, bool treatAsDBCS) {
 	if (len == 0) {
@@ -1910,53 +2148,67 @@ void Editor::AddCharUTF(const char *s, unsigned int len, bool treatAsDBCS) {
 	{
 		UndoGroup ug(pdoc, (sel.Count() > 1) || !sel.Empty() || inOverstrike);
 
-		// Vector elements point into selection in order to change selection.
-		std::vector<SelectionRange *> selPtrs;
-		for (size_t r = 0; r < sel.Count(); r++) {
-			selPtrs.push_back(&sel.Range(r));
-		}
-		// Order selections by position in document.
-		std::sort(selPtrs.begin(), selPtrs.end(),
-			[](const SelectionRange *a, const SelectionRange *b) {return *a < *b;});
-
-		// Loop in reverse to avoid disturbing positions of selections yet to be processed.
-		for (std::vector<SelectionRange *>::reverse_iterator rit = selPtrs.rbegin();
-			rit != selPtrs.rend(); ++rit) {
-			SelectionRange *currentSel = *rit;
-			if (!RangeContainsProtected(currentSel->Start().Position(),
-				currentSel->End().Position())) {
-				Sci::Position positionInsert = currentSel->Start().Position();
-				if (!currentSel->Empty()) {
-					if (currentSel->Length()) {
-						pdoc->DeleteChars(positionInsert, currentSel->Length());
-						currentSel->ClearVirtualSpace();
-					} else {
-						// Range is all virtual so collapse to start of virtual space
-						currentSel->MinimizeVirtualSpace();
+		if (ReplaceSelectionsTogether(s, len, inOverstrike)) {
+			// Rewrap the main caret's line so EnsureCaretVisible has accurate information
+			if (Wrapping()) {
+				AutoSurface surface(this);
+				if (surface) {
+					if (WrapOneLine(surface, pdoc->SciLineFromPosition(sel.MainCaret()))) {
+						SetScrollBars();
+						SetVerticalScrollPos();
+						Redraw();
 					}
-				} else if (inOverstrike) {
-					if (positionInsert < pdoc->Length()) {
-						if (!pdoc->IsPositionInLineEnd(positionInsert)) {
-							pdoc->DelChar(positionInsert);
+				}
+			}
+		} else {
+			// Vector elements point into selection in order to change selection.
+			std::vector<SelectionRange *> selPtrs;
+			for (size_t r = 0; r < sel.Count(); r++) {
+				selPtrs.push_back(&sel.Range(r));
+			}
+			// Order selections by position in document.
+			std::sort(selPtrs.begin(), selPtrs.end(),
+				[](const SelectionRange *a, const SelectionRange *b) {return *a < *b;});
+
+			// Loop in reverse to avoid disturbing positions of selections yet to be processed.
+			for (std::vector<SelectionRange *>::reverse_iterator rit = selPtrs.rbegin();
+				rit != selPtrs.rend(); ++rit) {
+				SelectionRange *currentSel = *rit;
+				if (!RangeContainsProtected(currentSel->Start().Position(),
+					currentSel->End().Position())) {
+					Sci::Position positionInsert = currentSel->Start().Position();
+					if (!currentSel->Empty()) {
+						if (currentSel->Length()) {
+							pdoc->DeleteChars(positionInsert, currentSel->Length());
 							currentSel->ClearVirtualSpace();
+						} else {
+							// Range is all virtual so collapse to start of virtual space
+							currentSel->MinimizeVirtualSpace();
+						}
+					} else if (inOverstrike) {
+						if (positionInsert < pdoc->Length()) {
+							if (!pdoc->IsPositionInLineEnd(positionInsert)) {
+								pdoc->DelChar(positionInsert);
+								currentSel->ClearVirtualSpace();
+							}
 						}
 					}
-				}
-				positionInsert = RealizeVirtualSpace(positionInsert, currentSel->caret.VirtualSpace());
-				const Sci::Position lengthInserted = pdoc->InsertString(positionInsert, s, len);
-				if (lengthInserted > 0) {
-					currentSel->caret.SetPosition(positionInsert + lengthInserted);
-					currentSel->anchor.SetPosition(positionInsert + lengthInserted);
-				}
-				currentSel->ClearVirtualSpace();
-				// If in wrap mode rewrap current line so EnsureCaretVisible has accurate information
-				if (Wrapping()) {
-					AutoSurface surface(this);
-					if (surface) {
-						if (WrapOneLine(surface, pdoc->SciLineFromPosition(positionInsert))) {
-							SetScrollBars();
-							SetVerticalScrollPos();
-							Redraw();
+					positionInsert = RealizeVirtualSpace(positionInsert, currentSel->caret.VirtualSpace());
+					const Sci::Position lengthInserted = pdoc->InsertString(positionInsert, s, len);
+					if (lengthInserted > 0) {
+						currentSel->caret.SetPosition(positionInsert + lengthInserted);
+						currentSel->anchor.SetPosition(positionInsert + lengthInserted);
+					}
+					currentSel->ClearVirtualSpace();
+					// If in wrap mode rewrap current line so EnsureCaretVisible has accurate information
+					if (Wrapping()) {
+						AutoSurface surface(this);
+						if (surface) {
+							if (WrapOneLine(surface, pdoc->SciLineFromPosition(positionInsert))) {
+								SetScrollBars();
+								SetVerticalScrollPos();
+								Redraw();
+							}
 						}
 					}
 				}
@@ -2032,7 +2284,7 @@ void Editor::InsertPaste(const char *text, Sci::Position len) {
 		if (lengthInserted > 0) {
 			SetEmptySelection(selStart.Position() + lengthInserted);
 		}
-	} else {
+	} else if (!ReplaceSelectionsTogether(text, len, false)) {
 		// SC_MULTIPASTE_EACH
 		for (size_t r=0; r<sel.Count(); r++) {
 			if (!RangeContainsProtected(sel.Range(r).Start().Position(),
@@ -2093,13 +2345,15 @@ void Editor::ClearSelection(bool retainMultipleSelections) {
 	if (!sel.IsRectangular() && !retainMultipleSelections)
 		FilterSelections();
 	UndoGroup ug(pdoc);
-	for (size_t r=0; r<sel.Count(); r++) {
-		if (!sel.Range(r).Empty()) {
-			if (!RangeContainsProtected(sel.Range(r).Start().Position(),
-				sel.Range(r).End().Position())) {
-				pdoc->DeleteChars(sel.Range(r).Start().Position(),
-					sel.Range(r).Length());
-				sel.Range(r) = SelectionRange(sel.Range(r).Start());
+	if (!ReplaceSelectionsTogether(nullptr, 0, false)) {
+		for (size_t r=0; r<sel.Count(); r++) {
+			if (!sel.Range(r).Empty()) {
+				if (!RangeContainsProtected(sel.Range(r).Start().Position(),
+					sel.Range(r).End().Position())) {
+					pdoc->DeleteChars(sel.Range(r).Start().Position(),
+						sel.Range(r).Length());
+					sel.Range(r) = SelectionRange(sel.Range(r).Start());
+				}
 			}
 		}
 	}
@@ -2519,9 +2773,17 @@ void Editor::CheckModificationForWrap(DocModification mh) {
 	if (mh.modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT)) {
 		view.llc.Invalidate(LineLayout::llCheckTextAndStyle);
 		const Sci::Line lineDoc = pdoc->SciLineFromPosition(mh.position);
-		const Sci::Line lines = std::max(static_cast<Sci::Line>(0), mh.linesAdded);
+		Sci::Line lines = std::max(static_cast<Sci::Line>(0), mh.linesAdded);
+		if (mh.modificationType & SC_MOD_INSERTTEXT) {
+			// Replacing several ranges together may change many lines without adding any
+			lines = std::max(lines, pdoc->SciLineFromPosition(mh.position + mh.length) - lineDoc);
+		}
 		if (Wrapping()) {
 			NeedWrapping(lineDoc, lineDoc + lines + 1);
+			if (mh.linesAdded > 0) {
+				// New lines, such as from loading a file, have estimated heights until wrapped.
+				EstimateWrapHeights(lineDoc + 1, lineDoc + mh.linesAdded + 1);
+			}
 		}
 		RefreshStyleData();
 		// Fix up annotation heights
@@ -2597,18 +2859,40 @@ void Editor::NotifyModified(Document *, DocModification mh, void *) {
 		}
 		if (mh.modificationType & SC_MOD_CHANGESTYLE) {
 			view.llc.Invalidate(LineLayout::llCheckTextAndStyle);
+			for (const std::unique_ptr<MatchHighlight> &highlight : matchHighlights) {
+				if (highlight->style >= 0) {
+					// Matches are only highlighted in one style so search again
+					HighlightMatchesNeeded(*highlight, mh.position, mh.position + mh.length);
+				}
+			}
 		}
 	} else {
 		// Move selection and brace highlights
+		// Selections changed together are moved after all the changes except for the rectangle
 		if (mh.modificationType & SC_MOD_INSERTTEXT) {
-			sel.MovePositions(true, mh.position, mh.length);
+			if (!changingSelectionsTogether)
+				sel.MovePositions(true, mh.position, mh.length);
+			else if (sel.selType == Selection::selRectangle)
+				sel.Rectangular().MoveForInsertDelete(true, mh.position, mh.length);
 			braces[0] = MovePositionForInsertion(braces[0], mh.position, mh.length);
 			braces[1] = MovePositionForInsertion(braces[1], mh.position, mh.length);
 		} else if (mh.modificationType & SC_MOD_DELETETEXT) {
-			sel.MovePositions(false, mh.position, mh.length);
+			if (!changingSelectionsTogether)
+				sel.MovePositions(false, mh.position, mh.length);
+			else if (sel.selType == Selection::selRectangle)
+				sel.Rectangular().MoveForInsertDelete(false, mh.position, mh.length);
 			braces[0] = MovePositionForDeletion(braces[0], mh.position, mh.length);
 			braces[1] = MovePositionForDeletion(braces[1], mh.position, mh.length);
 		}
+		for (const std::unique_ptr<MatchHighlight> &highlight : matchHighlights) {
+			if (mh.modificationType & SC_MOD_INSERTTEXT) {
+				highlight->pending.InsertSpace(mh.position, mh.length);
+				HighlightMatchesNeeded(*highlight, mh.position, mh.position + mh.length);
+			} else if (mh.modificationType & SC_MOD_DELETETEXT) {
+				highlight->pending.DeleteRange(mh.position, mh.length);
+				HighlightMatchesNeeded(*highlight, mh.position, mh.position);
+			}
+		}
 		if ((mh.modificationType & (SC_MOD_BEFOREINSERT | SC_MOD_BEFOREDELETE)) && pcs->HiddenLines()) {
 			// Some lines are hidden so may need shown.
 			const Sci::Line lineOfPos = pdoc->SciLineFromPosition(mh.position);
@@ -4974,6 +5258,8 @@ bool Editor::Idle() {
 		needWrap = wrapPending.NeedsWrap();
 	} else if (needIdleStyling) {
 		IdleStyling();
+	} else if (!HighlightMatchesComplete()) {
+		HighlightMatchesContinue(0.02);
 	}
 
 	// Add more idle things to do here, but make sure idleDone is
@@ -4981,7 +5267,7 @@ bool Editor::Idle() {
 	// false will stop calling this idle function until SetIdle() is
 	// called again.
 
-	const bool idleDone = !needWrap && !needIdleStyling; // && thatDone && theOtherThingDone...
+	const bool idleDone = !needWrap && !needIdleStyling && HighlightMatchesComplete(); // && thatDone && theOtherThingDone...
 
 	return !idleDone;
 }
@@ -5126,13 +5412,149 @@ void Editor::IdleStyling() {
 	const Sci::Position posAfterArea = PositionAfterArea(GetClientRectangle());
 	const Sci::Position endGoal = (idleStyling >= SC_IDLESTYLING_AFTERVISIBLE) ?
 		pdoc->Length() : posAfterArea;
-	const Sci::Position posAfterMax = PositionAfterMaxStyling(endGoal, false);
-	pdoc->StyleToAdjustingLineDuration(posAfterMax);
+	// When threaded, only wait briefly for the worker so that events continue to be processed.
+	if (!idleStylingThreaded || !pdoc->StyleInBackground(endGoal, 0.005)) {
+		const Sci::Position posAfterMax = PositionAfterMaxStyling(endGoal, false);
+		pdoc->StyleToAdjustingLineDuration(posAfterMax);
+	}
 	if (pdoc->GetEndStyled() >= endGoal) {
 		needIdleStyling = false;
 	}
 }
 
+// Start highlighting matches of text. When the indicator is already highlighting, the current
+// highlights remain until each range is searched again so they do not flash.
+void Editor::HighlightMatchesStart(int indicator, const char *text) {
+	if ((indicator < 0) || (indicator > INDIC_MAX))
+		return;
+	if (!*text) {
+		HighlightMatchesStop(indicator);
+		return;
+	}
+	auto it = std::find_if(matchHighlights.begin(), matchHighlights.end(),
+		[indicator](const std::unique_ptr<MatchHighlight> &highlight) noexcept {
+		return highlight->indicator == indicator;
+	});
+	if (it == matchHighlights.end()) {
+		matchHighlights.push_back(std::make_unique<MatchHighlight>(indicator, matchHighlightStyle));
+		it = matchHighlights.end() - 1;
+	}
+	MatchHighlight &highlight = **it;
+	highlight.text = text;
+	highlight.flags = searchFlags;
+	highlight.style = matchHighlightStyle;
+	highlight.pending.DeleteAll();
+	highlight.pending.InsertSpace(0, pdoc->Length());
+	highlight.pending.FillRange(0, 1, pdoc->Length());
+	// Highlight visible matches immediately to avoid flashing
+	HighlightMatchesContinue(0.02);
+	if (!HighlightMatchesComplete()) {
+		SetIdle(true);
+	}
+}
+
+void Editor::HighlightMatchesStop(int indicator) {
+	if ((indicator < 0) || (indicator > INDIC_MAX))
+		return;
+	auto it = std::find_if(matchHighlights.begin(), matchHighlights.end(),
+		[indicator](const std::unique_ptr<MatchHighlight> &highlight) noexcept {
+		return highlight->indicator == indicator;
+	});
+	if (it != matchHighlights.end()) {
+		matchHighlights.erase(it);
+	}
+	// Clear even when not highlighting as matches may remain from before a document switch
+	const int indicatorCurrent = pdoc->decorations->GetCurrentIndicator();
+	pdoc->DecorationSetCurrentIndicator(indicator);
+	pdoc->DecorationFillRange(0, 0, pdoc->Length());
+	pdoc->DecorationSetCurrentIndicator(indicatorCurrent);
+}
+
+bool Editor::HighlightMatchesComplete() const noexcept {
+	return std::all_of(matchHighlights.begin(), matchHighlights.end(),
+		[](const std::unique_ptr<MatchHighlight> &highlight) noexcept {
+		return highlight->Complete();
+	});
+}
+
+// Text between start and end has changed so search its lines again.
+void Editor::HighlightMatchesNeeded(MatchHighlight &highlight, Sci::Position start, Sci::Position end) {
+	// Matches that contain line ends may start or end on other lines
+	const Sci::Position extent = highlight.text.length();
+	const Sci::Position lineStart = pdoc->LineStart(
+		pdoc->SciLineFromPosition(std::max<Sci::Position>(start - extent, 0)));
+	const Sci::Position lineEnd = pdoc->LineStart(
+		pdoc->SciLineFromPosition(std::min(end + extent, pdoc->Length())) + 1);
+	highlight.pending.FillRange(lineStart, 1, lineEnd - lineStart);
+	SetIdle(true);
+}
+
+// Search one segment of pending lines, preferring those from posTop onwards.
+// Returns false when nothing is pending.
+bool Editor::HighlightMatchesSegment(MatchHighlight &highlight, Sci::Position posTop) {
+	const Sci::Line linesSegment = 200;
+	Sci::Position start = highlight.pending.Find(1, posTop);
+	if (start < 0)
+		start = highlight.pending.Find(1, 0);
+	if (start < 0)
+		return false;
+	// Search whole lines so matches are not split
+	const Sci::Line line = pdoc->SciLineFromPosition(start);
+	const Sci::Position rangeStart = pdoc->LineStart(line);
+	const Sci::Position endPending = std::min(pdoc->LineStart(line + linesSegment),
+		highlight.pending.EndRun(start));
+	const Sci::Position rangeEnd = pdoc->LineStart(pdoc->SciLineFromPosition(endPending - 1) + 1);
+	if (highlight.style >= 0) {
+		// Styling may add pending ranges so perform it first
+		pdoc->EnsureStyledTo(rangeEnd);
+	}
+	highlight.pending.FillRange(rangeStart, 0, rangeEnd - rangeStart);
+	const int indicatorCurrent = pdoc->decorations->GetCurrentIndicator();
+	pdoc->DecorationSetCurrentIndicator(highlight.indicator);
+	pdoc->DecorationFillRange(rangeStart, 0, rangeEnd - rangeStart);
+	try {
+		Sci::Position pos = rangeStart;
+		while (pos < rangeEnd) {
+			Sci::Position lengthFound = highlight.text.length();
+			const Sci::Position posFound = pdoc->FindTextRetainingGroups(pos, rangeEnd,
+				highlight.text.c_str(), highlight.flags, &lengthFound);
+			if (posFound < 0)
+				break;
+			if ((lengthFound > 0) &&
+				((highlight.style < 0) || (highlight.style == pdoc->StyleIndexAt(posFound)))) {
+				pdoc->DecorationFillRange(posFound, 1, lengthFound);
+			}
+			pos = posFound + lengthFound;
+			if (lengthFound <= 0) {
+				// Step over a character after an empty match
+				pos = pdoc->NextPosition(pos, 1);
+			}
+		}
+	} catch (RegexError &) {
+		errorStatus = SC_STATUS_WARN_REGEX;
+		highlight.pending.FillRange(0, 0, highlight.pending.Length());
+	}
+	pdoc->DecorationSetCurrentIndicator(indicatorCurrent);
+	return true;
+}
+
+// Search pending ranges for a limited time, starting with the visible text and
+// continuing through the rest of the document.
+void Editor::HighlightMatchesContinue(double secondsAllowed) {
+	ElapsedPeriod epHighlight;
+	if (!pdoc->HasCaseFolder())
+		pdoc->SetCaseFolder(CaseFolderForEncoding());
+	const Sci::Position posTop = pdoc->LineStart(pcs->DocFromDisplay(topLine));
+	bool searched = true;
+	while (searched && (epHighlight.Duration() < secondsAllowed)) {
+		searched = false;
+		for (const std::unique_ptr<MatchHighlight> &highlight : matchHighlights) {
+			if (HighlightMatchesSegment(*highlight, posTop))
+				searched = true;
+		}
+	}
+}
+
 void Editor::IdleWork() {
 	// Style the line after the modification as this allows modifications that change just the
 	// line of the modification to heal instead of propagating to the rest of the window.
@@ -5250,6 +5672,8 @@ void Editor::SetDocPointer(Document *document) {
 	braces[0] = Sci::invalidPosition;
 	braces[1] = Sci::invalidPosition;
 
+	matchHighlights.clear();
+
 	vs.ReleaseAllExtendedStyles();
 
 	SetRepresentations();
@@ -5260,6 +5684,7 @@ void Editor::SetDocPointer(Document *document) {
 	SetAnnotationHeights(0, pdoc->LinesTotal());
 	view.llc.Deallocate();
 	NeedWrapping();
+	EstimateWrapHeights(0, pdoc->LinesTotal());
 
 	hotspot = Range(Sci::invalidPosition);
 	hoverIndicatorPos = Sci::invalidPosition;
@@ -5401,7 +5826,7 @@ void Editor::EnsureLineVisible(Sci::Line lineDoc, bool enforcePolicy) {
 
 	// In case in need of wrapping to ensure DisplayFromDoc works.
 	if (lineDoc >= wrapPending.start) {
-		if (WrapLines(WrapScope::wsAll)) {
+		if (WrapLines(WrapScope::wsNear, lineDoc)) {
 			Redraw();
 		}
 	}
@@ -5588,6 +6013,85 @@ Sci::Position Editor::ReplaceTarget(bool replacePatterns, const char *text, Sci:
 	return length;
 }
 
+namespace {
+
+// A match to be replaced with text held in a buffer shared by all the matches.
+// Positions are in the document before any of the replacements are made.
+struct Replacement {
+	Sci::Position position;
+	Sci::Position lengthDelete;
+	size_t offsetText;
+	Sci::Position lengthText;
+};
+
+}
+
+/**
+ * Replace every match of findText in the target. All matches are found in the unchanged
+ * text first so replacements can not produce further matches, then each is replaced in
+ * document order as one undo action with its own notifications.
+ * The target is set to the last replacement.
+ * Returns the number of replacements or -1 for an invalid regular expression.
+ */
+Sci::Position Editor::ReplaceAllInTarget(const char *findText, const char *replaceText) {
+	const Sci::Position lengthFind = strlen(findText);
+	const Sci::Position lengthReplace = strlen(replaceText);
+	const bool replacePatterns = (searchFlags & SCFIND_REGEXP) != 0;
+	const Sci::Position rangeStart = std::min(targetStart, targetEnd);
+	const Sci::Position rangeEnd = std::max(targetStart, targetEnd);
+
+	if (!pdoc->HasCaseFolder())
+		pdoc->SetCaseFolder(CaseFolderForEncoding());
+	std::vector<Replacement> replacements;
+	std::string texts;
+	try {
+		Sci::Position position = rangeStart;
+		for (;;) {
+			Sci::Position lengthFound = lengthFind;
+			const Sci::Position pos = pdoc->FindText(position, rangeEnd, findText, searchFlags, &lengthFound);
+			if (pos == -1)
+				break;
+			const char *text = replaceText;
+			Sci::Position lengthText = lengthReplace;
+			if (replacePatterns) {
+				text = pdoc->SubstituteByPosition(replaceText, &lengthText);
+				if (!text)
+					break;
+			}
+			replacements.push_back({pos, lengthFound, texts.length(), lengthText});
+			texts.append(text, lengthText);
+			position = pos + lengthFound;
+			if (lengthFound <= 0) {
+				// Step over a character after an empty match
+				position = pdoc->NextPosition(position, 1);
+			}
+			if (position >= rangeEnd)
+				break;
+		}
+	} catch (RegexError &) {
+		errorStatus = SC_STATUS_WARN_REGEX;
+		return -1;
+	}
+
+	UndoGroup ug(pdoc);
+	Sci::Position replaced = 0;
+	Sci::Position shift = 0;
+	for (const Replacement &replacement : replacements) {
+		const Sci::Position position = replacement.position + shift;
+		if ((replacement.lengthDelete > 0) && !pdoc->DeleteChars(position, replacement.lengthDelete))
+			break;
+		const Sci::Position lengthInserted = pdoc->InsertString(position,
+			texts.c_str() + replacement.offsetText, replacement.lengthText);
+		if (pdoc->IsReadOnly())
+			break;
+		targetStart = position;
+		targetEnd = position + lengthInserted;
+		shift += lengthInserted - replacement.lengthDelete;
+		replaced++;
+	}
+	return replaced;
+}
+
 bool Editor::IsUnicodeMode() const noexcept {
 	return pdoc && (SC_CP_UTF8 == pdoc->dbcsCodePage);
 }
@@ -6025,6 +6529,10 @@ sptr_t Editor::WndProc(unsigned int iMessage, uptr_t wParam, sptr_t lParam) {
 		PLATFORM_ASSERT(lParam);
 		return ReplaceTarget(true, CharPtrFromSPtr(lParam), static_cast<Sci::Position>(wParam));
 
+	case SCI_REPLACEALLINTARGET:
+		PLATFORM_ASSERT(wParam && lParam);
+		return ReplaceAllInTarget(ConstCharPtrFromUPtr(wParam), ConstCharPtrFromSPtr(lParam));
+
 	case SCI_SEARCHINTARGET:
 		PLATFORM_ASSERT(lParam);
 		return SearchInTarget(CharPtrFromSPtr(lParam), static_cast<Sci::Position>(wParam));
@@ -6208,6 +6716,13 @@ sptr_t Editor::WndProc(unsigned int iMessage, uptr_t wParam, sptr_t lParam) {
 	case SCI_GETUNDOCOLLECTION:
 		return pdoc->IsCollectingUndo();
 
+	case SCI_SETUNDOMEMORYLIMIT:
+		pdoc->SetUndoMemoryLimit(static_cast<Sci::Position>(wParam));
+		return 0;
+
+	case SCI_GETUNDOMEMORYLIMIT:
+		return pdoc->GetUndoMemoryLimit();
+
 	case SCI_BEGINUNDOACTION:
 		pdoc->BeginUndoAction();
 		return 0;
@@ -6621,6 +7136,24 @@ sptr_t Editor::WndProc(unsigned int iMessage, uptr_t wParam, sptr_t lParam) {
 	case SCI_GETIDLESTYLING:
 		return idleStyling;
 
+	case SCI_SETIDLESTYLINGTHREADED:
+		idleStylingThreaded = wParam != 0;
+		if (!idleStylingThreaded) {
+			pdoc->FinishBackgroundStyling();
+		}
+		break;
+
+	case SCI_GETIDLESTYLINGTHREADED:
+		return idleStylingThreaded;
+
+	case SCI_SETSTYLINGTHREADS:
+		pdoc->stylingThreads = std::clamp(static_cast<int>(wParam), 1,
+			std::max(static_cast<int>(std::thread::hardware_concurrency()), 1));
+		break;
+
+	case SCI_GETSTYLINGTHREADS:
+		return pdoc->stylingThreads;
+
 	case SCI_SETWRAPMODE:
 		if (vs.SetWrapState(static_cast<int>(wParam))) {
 			xOffset = 0;
@@ -6679,6 +7212,14 @@ sptr_t Editor::WndProc(unsigned int iMessage, uptr_t wParam, sptr_t lParam) {
 	case SCI_GETLAYOUTCACHE:
 		return view.llc.GetLevel();
 
+	case SCI_SETLAYOUTTHREADS:
+		layoutThreads = std::clamp(static_cast<int>(wParam), 1,
+			std::max(static_cast<int>(std::thread::hardware_concurrency()), 1));
+		break;
+
+	case SCI_GETLAYOUTTHREADS:
+		return layoutThreads;
+
 	case SCI_SETPOSITIONCACHE:
 		view.posCache.SetSize(wParam);
 		break;
@@ -6686,6 +7227,9 @@ sptr_t Editor::WndProc(unsigned int iMessage, uptr_t wParam, sptr_t lParam) {
 	case SCI_GETPOSITIONCACHE:
 		return view.posCache.GetSize();
 
+	case SCI_GETPOSITIONCACHESTATISTIC:
+		return view.posCache.GetStatistic(static_cast<int>(wParam));
+
 	case SCI_SETSCROLLWIDTH:
 		PLATFORM_ASSERT(wParam > 0);
 		if ((wParam > 0) && (wParam != static_cast<unsigned int>(scrollWidth))) {
@@ -7462,6 +8006,24 @@ sptr_t Editor::WndProc(unsigned int iMessage, uptr_t wParam, sptr_t lParam) {
 			lParam);
 		break;
 
+	case SCI_HIGHLIGHTMATCHES:
+		HighlightMatchesStart(static_cast<int>(wParam), ConstCharPtrFromSPtr(lParam));
+		break;
+
+	case SCI_HIGHLIGHTMATCHESCLEAR:
+		HighlightMatchesStop(static_cast<int>(wParam));
+		break;
+
+	case SCI_SETHIGHLIGHTMATCHESSTYLE:
+		matchHighlightStyle = static_cast<int>(wParam);
+		break;
+
+	case SCI_GETHIGHLIGHTMATCHESSTYLE:
+		return matchHighlightStyle;
+
+	case SCI_GETHIGHLIGHTMATCHESCOMPLETE:
+		return HighlightMatchesComplete();
+
 	case SCI_INDICATORALLONFOR:
 		return pdoc->decorations->AllOnFor(static_cast<Sci::Position>(wParam));
 
@@ -59,6 +59,25 @@ public:
 	}
 };
 
+/**
+ * Every match of a string highlighted with an indicator.
+ * Ranges that still have to be searched are held in pending so they move with
+ * insertions and deletions.
+ */
+class MatchHighlight {
+public:
+	std::string text;
+	int flags;
+	int style;
+	int indicator;
+	RunStyles<Sci::Position, char> pending;
+
+	MatchHighlight(int indicator_, int style_) : flags(0), style(style_), indicator(indicator_) {}
+	bool Complete() const noexcept {
+		return pending.Find(1, 0) < 0;
+	}
+};
+
 /**
  * Hold a piece of text selected for copying or dragging, along with encoding and selection format information.
  */
@@ -181,6 +200,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	bool multipleSelection;
 	bool additionalSelectionTyping;
 	int multiPasteMode;
+	bool changingSelectionsTogether;	///< Selections are moved after all are changed by ReplaceSelectionsTogether
 
 	int virtualSpaceOptions;
 
@@ -226,7 +246,10 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	bool willRedrawAll;
 	WorkNeeded workNeeded;
 	int idleStyling;
+	bool idleStylingThreaded;
 	bool needIdleStyling;
+	std::vector<std::unique_ptr<MatchHighlight>> matchHighlights;
+	int matchHighlightStyle;
 
 	int modEventMask;
 	bool commandEvents;
@@ -251,6 +274,8 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	// Wrapping support
 	WrapPending wrapPending;
 	ActionDuration durationWrapOneLine;
+	int layoutThreads;
+	Sci::Line linesDisplayedScrollBars;	///< Display lines when the scroll bars were last set
 
 	bool convertPastes;
 
@@ -371,8 +396,11 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	bool Wrapping() const noexcept;
 	void NeedWrapping(Sci::Line docLineStart=0, Sci::Line docLineEnd=WrapPending::lineLarge);
 	bool WrapOneLine(Surface *surface, Sci::Line lineToWrap);
-	enum class WrapScope {wsAll, wsVisible, wsIdle};
-	bool WrapLines(WrapScope ws);
+	bool WrapBlock(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToWrapEnd);
+	int WrapWidthFromClient();
+	bool EstimateWrapHeights(Sci::Line lineStart, Sci::Line lineEnd);
+	enum class WrapScope {wsAll, wsVisible, wsIdle, wsNear};
+	bool WrapLines(WrapScope ws, Sci::Line lineNear=0);
 	void LinesJoin();
 	void LinesSplit(int pixelWidth);
 
@@ -390,6 +418,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	void ChangeSize();
 
 	void FilterSelections();
+	bool ReplaceSelectionsTogether(const char *text, Sci::Position len, bool overstrike);
 	Sci::Position RealizeVirtualSpace(Sci::Position position, Sci::Position virtualSpace);
 	SelectionPosition RealizeVirtualSpace(const SelectionPosition &position);
 	void AddChar(char ch);
@@ -526,6 +555,12 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 		return (idleStyling == SC_IDLESTYLING_NONE) || (idleStyling == SC_IDLESTYLING_AFTERVISIBLE);
 	}
 	void IdleStyling();
+	void HighlightMatchesStart(int indicator, const char *text);
+	void HighlightMatchesStop(int indicator);
+	bool HighlightMatchesComplete() const noexcept;
+	void HighlightMatchesNeeded(MatchHighlight &highlight, Sci::Position start, Sci::Position end);
+	bool HighlightMatchesSegment(MatchHighlight &highlight, Sci::Position posTop);
+	void HighlightMatchesContinue(double secondsAllowed);
 	virtual void IdleWork();
 	virtual void QueueIdleWork(WorkNeeded::workItems items, Sci::Position upTo=0);
 
@@ -551,6 +586,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 
 	Sci::Position GetTag(char *tagValue, int tagNumber);
 	Sci::Position ReplaceTarget(bool replacePatterns, const char *text, Sci::Position length=-1);
+	Sci::Position ReplaceAllInTarget(const char *findText, const char *replaceText);
 
 	bool PositionIsHotspot(Sci::Position position) const;
 	bool PointIsHotspot(Point pt);
@@ -94,6 +94,12 @@ void LineMarkers::InsertLine(Sci::Line line) {
 	}
 }
 
+void LineMarkers::InsertLines(Sci::Line line, Sci::Line lines) {
+	if (markers.Length()) {
+		markers.InsertEmpty(line, lines);
+	}
+}
+
 void LineMarkers::RemoveLine(Sci::Line line) {
 	// Retain the markers from the deleted line by oring them into the previous line
 	if (markers.Length()) {
@@ -203,6 +209,13 @@ void LineLevels::InsertLine(Sci::Line line) {
 	}
 }
 
+void LineLevels::InsertLines(Sci::Line line, Sci::Line lines) {
+	if (levels.Length()) {
+		const int level = (line < levels.Length()) ? levels[line] : SC_FOLDLEVELBASE;
+		levels.InsertValue(line, lines, level);
+	}
+}
+
 void LineLevels::RemoveLine(Sci::Line line) {
 	if (levels.Length()) {
 		// Move up following lines but merge header flag from this line
@@ -261,6 +274,14 @@ void LineState::InsertLine(Sci::Line line) {
 	}
 }
 
+void LineState::InsertLines(Sci::Line line, Sci::Line lines) {
+	if (lineStates.Length()) {
+		lineStates.EnsureLength(line);
+		const int val = (line < lineStates.Length()) ? lineStates[line] : 0;
+		lineStates.InsertValue(line, lines, val);
+	}
+}
+
 void LineState::RemoveLine(Sci::Line line) {
 	if (lineStates.Length() > line) {
 		lineStates.Delete(line);
@@ -325,6 +346,13 @@ void LineAnnotation::InsertLine(Sci::Line line) {
 	}
 }
 
+void LineAnnotation::InsertLines(Sci::Line line, Sci::Line lines) {
+	if (annotations.Length()) {
+		annotations.EnsureLength(line);
+		annotations.InsertEmpty(line, lines);
+	}
+}
+
 void LineAnnotation::RemoveLine(Sci::Line line) {
 	if (annotations.Length() && (line > 0) && (line <= annotations.Length())) {
 		annotations[line-1].reset();
@@ -447,6 +475,13 @@ void LineTabstops::InsertLine(Sci::Line line) {
 	}
 }
 
+void LineTabstops::InsertLines(Sci::Line line, Sci::Line lines) {
+	if (tabstops.Length()) {
+		tabstops.EnsureLength(line);
+		tabstops.InsertEmpty(line, lines);
+	}
+}
+
 void LineTabstops::RemoveLine(Sci::Line line) {
 	if (tabstops.Length() > line) {
 		tabstops[line].reset();
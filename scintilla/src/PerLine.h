@@ -58,6 +58,7 @@ public:
 	~LineMarkers() override;
 	void Init() override;
 	void InsertLine(Sci::Line line) override;
+	void InsertLines(Sci::Line line, Sci::Line lines) override;
 	void RemoveLine(Sci::Line line) override;
 
 	int MarkValue(Sci::Line line) noexcept;
@@ -82,6 +83,7 @@ public:
 	~LineLevels() override;
 	void Init() override;
 	void InsertLine(Sci::Line line) override;
+	void InsertLines(Sci::Line line, Sci::Line lines) override;
 	void RemoveLine(Sci::Line line) override;
 
 	void ExpandLevels(Sci::Line sizeNew=-1);
@@ -103,6 +105,7 @@ public:
 	~LineState() override;
 	void Init() override;
 	void InsertLine(Sci::Line line) override;
+	void InsertLines(Sci::Line line, Sci::Line lines) override;
 	void RemoveLine(Sci::Line line) override;
 
 	int SetLineState(Sci::Line line, int state);
@@ -123,6 +126,7 @@ public:
 	~LineAnnotation() override;
 	void Init() override;
 	void InsertLine(Sci::Line line) override;
+	void InsertLines(Sci::Line line, Sci::Line lines) override;
 	void RemoveLine(Sci::Line line) override;
 
 	bool MultipleStyles(Sci::Line line) const;
@@ -152,6 +156,7 @@ public:
 	~LineTabstops() override;
 	void Init() override;
 	void InsertLine(Sci::Line line) override;
+	void InsertLines(Sci::Line line, Sci::Line lines) override;
 	void RemoveLine(Sci::Line line) override;
 
 	bool ClearTabstops(Sci::Line line);
@@ -9,6 +9,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <cmath>
+#include <limits>
 
 #include <stdexcept>
 #include <string>
@@ -67,6 +68,8 @@ LineLayout::LineLayout(int maxLineLength_) :
 	edgeColumn(0),
 	bracePreviousStyles{},
 	hotspot(0,0),
+	decorationsVersion(0),
+	decorationsLineStart(-1),
 	widthLine(wrapWidthInfinite),
 	lines(1),
 	wrapIndent(0) {
@@ -111,6 +114,8 @@ void LineLayout::Free() noexcept {
 void LineLayout::Invalidate(validLevel validity_) {
 	if (validity > validity_)
 		validity = validity_;
+	if (validity_ == llInvalid)
+		decorationsLineStart = -1;
 }
 
 int LineLayout::LineStart(int line) const {
@@ -590,12 +595,12 @@ BreakFinder::BreakFinder(const LineLayout *ll_, const Selection *psel, Range lin
 		}
 	}
 	if (pvsDraw && pvsDraw->indicatorsSetFore) {
-		for (const IDecoration *deco : pdoc->decorations->View()) {
-			if (pvsDraw->indicators[deco->Indicator()].OverridesTextFore()) {
-				Sci::Position startPos = deco->EndRun(posLineStart);
-				while (startPos < (posLineStart + lineRange.end)) {
-					Insert(startPos - posLineStart);
-					startPos = deco->EndRun(startPos);
+		// Break at each end of the indicator runs extracted for the line when it was drawn
+		for (const DecorationSpan &span : ll->decorationSpans) {
+			if (pvsDraw->indicators[span.indicator].OverridesTextFore()) {
+				for (const Sci::Position edge : { span.start, span.end }) {
+					if ((edge > posLineStart) && (edge < (posLineStart + lineRange.end)))
+						Insert(edge - posLineStart);
 				}
 			}
 		}
@@ -669,130 +674,186 @@ bool BreakFinder::More() const noexcept {
 	return (subBreak >= 0) || (nextBreak < lineRange.end);
 }
 
-PositionCacheEntry::PositionCacheEntry() noexcept :
-	styleNumber(0), len(0), clock(0), positions(nullptr) {
+namespace {
+
+// Arena space reserved for each entry in the hash table.
+constexpr size_t arenaPerEntry = 16;
+
 }
 
-// Copy constructor not currently used, but needed for being element in std::vector.
-PositionCacheEntry::PositionCacheEntry(const PositionCacheEntry &other) :
-	styleNumber(other.styleNumber), len(other.styleNumber), clock(other.styleNumber), positions(nullptr) {
-	if (other.positions) {
-		const size_t lenData = len + (len / sizeof(XYPOSITION)) + 1;
-		positions = std::make_unique<XYPOSITION[]>(lenData);
-		memcpy(positions.get(), other.positions.get(), lenData * sizeof(XYPOSITION));
-	}
+PositionCache::PositionCache() : PositionCache(nullptr) {
 }
 
-void PositionCacheEntry::Set(unsigned int styleNumber_, const char *s_,
-	unsigned int len_, const XYPOSITION *positions_, unsigned int clock_) {
-	Clear();
-	styleNumber = styleNumber_;
-	len = len_;
-	clock = clock_;
-	if (s_ && positions_) {
-		positions = std::make_unique<XYPOSITION[]>(len + (len / sizeof(XYPOSITION)) + 1);
-		for (unsigned int i=0; i<len; i++) {
-			positions[i] = positions_[i];
-		}
-		memcpy(&positions[len], s_, len);
-	}
+PositionCache::PositionCache(const PositionCache *shared_) :
+	pces(0x400), arena(0x400 * arenaPerEntry), sequenceNext(0), shared(shared_),
+	hits(0), misses(0), evictions(0), allClear(true) {
 }
 
-PositionCacheEntry::~PositionCacheEntry() {
+PositionCache::~PositionCache() {
 	Clear();
 }
 
-void PositionCacheEntry::Clear() noexcept {
-	positions.reset();
-	styleNumber = 0;
-	len = 0;
-	clock = 0;
+size_t PositionCache::ArenaLength(unsigned int len) noexcept {
+	// Positions followed by bytes of string rounded up to a whole number of XYPOSITION.
+	return len + (len + sizeof(XYPOSITION) - 1) / sizeof(XYPOSITION);
 }
 
-bool PositionCacheEntry::Retrieve(unsigned int styleNumber_, const char *s_,
-	unsigned int len_, XYPOSITION *positions_) const {
-	if ((styleNumber == styleNumber_) && (len == len_) &&
-		(memcmp(&positions[len], s_, len)== 0)) {
-		for (unsigned int i=0; i<len; i++) {
-			positions_[i] = positions[i];
-		}
-		return true;
-	} else {
-		return false;
-	}
+bool PositionCache::Valid(const PositionCacheEntry &pce) const noexcept {
+	// Valid if not overwritten by later allocations from the arena
+	return (pce.len > 0) && (pce.sequence + arena.size() >= sequenceNext);
 }
 
-unsigned int PositionCacheEntry::Hash(unsigned int styleNumber_, const char *s, unsigned int len_) noexcept {
-	unsigned int ret = s[0] << 7;
-	for (unsigned int i=0; i<len_; i++) {
-		ret *= 1000003;
-		ret ^= s[i];
+bool PositionCache::Matches(const PositionCacheEntry &pce, unsigned int hash, unsigned int styleNumber,
+	const char *s, unsigned int len) const noexcept {
+	if ((pce.hash == hash) && (pce.len == len) && (pce.styleNumber == styleNumber) && Valid(pce)) {
+		const XYPOSITION *positionsEntry = &arena[pce.sequence % arena.size()];
+		return memcmp(positionsEntry + len, s, len) == 0;
 	}
-	ret *= 1000003;
-	ret ^= len_;
-	ret *= 1000003;
-	ret ^= styleNumber_;
-	return ret;
+	return false;
 }
 
-bool PositionCacheEntry::NewerThan(const PositionCacheEntry &other) const noexcept {
-	return clock > other.clock;
+bool PositionCache::Retrieve(unsigned int hash, unsigned int styleNumber, const char *s, unsigned int len,
+	XYPOSITION *positions) const noexcept {
+	if (pces.empty()) {
+		return false;
+	}
+	// Two way associative: try two probe positions.
+	for (const size_t probe : { hash % pces.size(), (hash * 37) % pces.size() }) {
+		const PositionCacheEntry &pce = pces[probe];
+		if (Matches(pce, hash, styleNumber, s, len)) {
+			const XYPOSITION *positionsEntry = &arena[pce.sequence % arena.size()];
+			std::copy(positionsEntry, positionsEntry + len, positions);
+			return true;
+		}
+	}
+	return false;
+}
+
+void PositionCache::Store(unsigned int hash, unsigned int styleNumber, const char *s, unsigned int len,
+	const XYPOSITION *positions) {
+	const size_t lengthArena = ArenaLength(len);
+	if (pces.empty() || (lengthArena > arena.size())) {
+		return;
+	}
+	if (sequenceNext > std::numeric_limits<size_t>::max() / 2) {
+		// Avoid sequence overflow by forgetting everything
+		std::fill(pces.begin(), pces.end(), PositionCacheEntry());
+		sequenceNext = 0;
+	}
+	size_t offset = sequenceNext % arena.size();
+	if (offset + lengthArena > arena.size()) {
+		// Does not fit at end so wrap around to start of arena.
+		sequenceNext += arena.size() - offset;
+		offset = 0;
+	}
+	const size_t sequence = sequenceNext;
+	sequenceNext += lengthArena;
+	XYPOSITION *positionsEntry = &arena[offset];
+	std::copy(positions, positions + len, positionsEntry);
+	memcpy(positionsEntry + len, s, len);
+
+	// Choose an unused slot or else the older of the two.
+	size_t probe = hash % pces.size();
+	const size_t probe2 = (hash * 37) % pces.size();
+	if (Valid(pces[probe])) {
+		if (!Valid(pces[probe2])) {
+			probe = probe2;
+		} else {
+			if (pces[probe2].sequence < pces[probe].sequence) {
+				probe = probe2;
+			}
+			evictions++;
+		}
+	}
+	PositionCacheEntry &pce = pces[probe];
+	pce.sequence = sequence;
+	pce.hash = hash;
+	pce.styleNumber = static_cast<unsigned char>(styleNumber);
+	pce.len = static_cast<unsigned char>(len);
 }
 
-void PositionCacheEntry::ResetClock() noexcept {
-	if (clock > 0) {
-		clock = 1;
+void PositionCache::Clear() noexcept {
+	if (!allClear) {
+		// Moving past the whole arena invalidates every entry.
+		sequenceNext += arena.size() + 1;
 	}
+	allClear = true;
 }
 
-PositionCache::PositionCache() {
-	clock = 1;
-	pces.resize(0x400);
+void PositionCache::SetSize(size_t size_) {
+	pces.assign(size_, PositionCacheEntry());
+	arena.assign(size_ * arenaPerEntry, 0.0f);
+	arena.shrink_to_fit();
+	pces.shrink_to_fit();
+	sequenceNext = 0;
+	hits = 0;
+	misses = 0;
+	evictions = 0;
 	allClear = true;
 }
 
-PositionCache::~PositionCache() {
-	Clear();
+size_t PositionCache::GetStatistic(int statistic) const noexcept {
+	switch (statistic) {
+	case SC_POSITIONCACHE_HITS:
+		return hits;
+	case SC_POSITIONCACHE_MISSES:
+		return misses;
+	case SC_POSITIONCACHE_EVICTIONS:
+		return evictions;
+	default:
+		return 0;
+	}
 }
 
-void PositionCache::Clear() noexcept {
-	if (!allClear) {
-		for (PositionCacheEntry &pce : pces) {
-			pce.Clear();
-		}
-	}
-	clock = 1;
-	allClear = true;
+void PositionCache::AddStatistics(const PositionCache &other) noexcept {
+	hits += other.hits;
+	misses += other.misses;
+	evictions += other.evictions;
 }
 
-void PositionCache::SetSize(size_t size_) {
-	Clear();
-	pces.resize(size_);
+// Hash 8 bytes at a time with a multiply and fold of the high bits.
+// The loop has few dependent operations so is quick for the short strings cached.
+unsigned int PositionCache::Hash(unsigned int styleNumber, const char *s, unsigned int len) noexcept {
+	constexpr unsigned long long multiplier = 0x9E3779B97F4A7C15ULL;
+	unsigned long long h = (static_cast<unsigned long long>(styleNumber) << 32) ^ len;
+	while (len >= 8) {
+		unsigned long long v;
+		memcpy(&v, s, 8);
+		h = (h ^ v) * multiplier;
+		h ^= h >> 32;
+		s += 8;
+		len -= 8;
+	}
+	if (len > 0) {
+		unsigned long long v = 0;
+		memcpy(&v, s, len);
+		h = (h ^ v) * multiplier;
+		h ^= h >> 32;
+	}
+	h *= multiplier;
+	return static_cast<unsigned int>(h >> 32);
 }
 
 void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
 	const char *s, unsigned int len, XYPOSITION *positions, const Document *pdoc) {
 
 	allClear = false;
-	size_t probe = pces.size();	// Out of bounds
-	if ((!pces.empty()) && (len < 30)) {
-		// Only store short strings in the cache so it doesn't churn with
-		// long comments with only a single comment.
-
-		// Two way associative: try two probe positions.
-		const unsigned int hashValue = PositionCacheEntry::Hash(styleNumber, s, len);
-		probe = hashValue % pces.size();
-		if (pces[probe].Retrieve(styleNumber, s, len, positions)) {
+	// Only store short strings in the cache so it doesn't churn with
+	// long comments with only a single comment.
+	const bool cacheable = !pces.empty() && (len > 0) && (len <= lengthCachedMax);
+	unsigned int hashValue = 0;
+	if (cacheable) {
+		hashValue = Hash(styleNumber, s, len);
+		if (Retrieve(hashValue, styleNumber, s, len, positions)) {
+			hits++;
 			return;
 		}
-		const unsigned int probe2 = (hashValue * 37) % pces.size();
-		if (pces[probe2].Retrieve(styleNumber, s, len, positions)) {
+		if (shared && shared->Retrieve(hashValue, styleNumber, s, len, positions)) {
+			hits++;
+			Store(hashValue, styleNumber, s, len, positions);
 			return;
 		}
-		// Not found. Choose the oldest of the two slots to replace
-		if (pces[probe].NewerThan(pces[probe2])) {
-			probe = probe2;
-		}
+		misses++;
 	}
 	if (len > BreakFinder::lengthStartSubdivision) {
 		// Break up into segments
@@ -812,17 +873,7 @@ void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, uns
 		FontAlias fontStyle = vstyle.styles[styleNumber].font;
 		surface->MeasureWidths(fontStyle, std::string_view(s, len), positions);
 	}
-	if (probe < pces.size()) {
-		// Store into cache
-		clock++;
-		if (clock > 60000) {
-			// Since there are only 16 bits for the clock, wrap it round and
-			// reset all cache entries so none get stuck with a high clock.
-			for (PositionCacheEntry &pce : pces) {
-				pce.ResetClock();
-			}
-			clock = 2;
-		}
-		pces[probe].Set(styleNumber, s, len, positions, clock);
+	if (cacheable) {
+		Store(hashValue, styleNumber, s, len, positions);
 	}
 }
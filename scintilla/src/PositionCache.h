@@ -82,6 +82,11 @@ public:
 	// Hotspot support
 	Range hotspot;
 
+	// Indicator runs over the line, valid while the decorations version and line start match
+	std::vector<DecorationSpan> decorationSpans;
+	size_t decorationsVersion;
+	Sci::Position decorationsLineStart;
+
 	// Wrapped line support
 	int widthLine;
 	int lines;
@@ -178,26 +183,16 @@ public:
 	void Dispose(LineLayout *ll) noexcept;
 };
 
-class PositionCacheEntry {
-	unsigned int styleNumber:8;
-	unsigned int len:8;
-	unsigned int clock:16;
-	std::unique_ptr<XYPOSITION []> positions;
-public:
-	PositionCacheEntry() noexcept;
-	// Copy constructor not currently used, but needed for being element in std::vector.
-	PositionCacheEntry(const PositionCacheEntry &);
-	// Deleted so PositionCacheEntry objects can not be assigned.
-	PositionCacheEntry(PositionCacheEntry &&) = delete;
-	void operator=(const PositionCacheEntry &) = delete;
-	void operator=(PositionCacheEntry &&) = delete;
-	~PositionCacheEntry();
-	void Set(unsigned int styleNumber_, const char *s_, unsigned int len_, const XYPOSITION *positions_, unsigned int clock_);
-	void Clear() noexcept;
-	bool Retrieve(unsigned int styleNumber_, const char *s_, unsigned int len_, XYPOSITION *positions_) const;
-	static unsigned int Hash(unsigned int styleNumber_, const char *s, unsigned int len_) noexcept;
-	bool NewerThan(const PositionCacheEntry &other) const noexcept;
-	void ResetClock() noexcept;
+/**
+ * Where a string measured by PositionCache is stored.
+ * The positions followed by the bytes of the string are in the arena of the cache at
+ * sequence modulo the arena size.
+ */
+struct PositionCacheEntry {
+	size_t sequence = 0;
+	unsigned int hash = 0;
+	unsigned char styleNumber = 0;
+	unsigned char len = 0;	// 0 indicates an empty slot
 };
 
 class Representation {
@@ -265,12 +260,38 @@ public:
 	bool More() const noexcept;
 };
 
+/**
+ * Caches the widths of short strings measured by a Surface.
+ * A hash table of entries points into a single arena which is filled in order and
+ * reused from its start once full so the oldest strings are dropped first.
+ * An entry is valid only while its part of the arena has not been reused.
+ * A cache may be given a shared cache to consult, without locking, when a string is not
+ * found. This allows threads to each have their own cache while benefiting from the
+ * contents of the user interface thread's cache as long as that is not modified.
+ */
 class PositionCache {
 	std::vector<PositionCacheEntry> pces;
-	unsigned int clock;
+	std::vector<XYPOSITION> arena;
+	// Total length allocated from the arena since cleared. Only the last arena.size() is retained.
+	size_t sequenceNext;
+	const PositionCache *shared;
+	size_t hits;
+	size_t misses;
+	size_t evictions;
 	bool allClear;
+	static size_t ArenaLength(unsigned int len) noexcept;
+	bool Valid(const PositionCacheEntry &pce) const noexcept;
+	bool Matches(const PositionCacheEntry &pce, unsigned int hash, unsigned int styleNumber,
+		const char *s, unsigned int len) const noexcept;
+	bool Retrieve(unsigned int hash, unsigned int styleNumber, const char *s, unsigned int len,
+		XYPOSITION *positions) const noexcept;
+	void Store(unsigned int hash, unsigned int styleNumber, const char *s, unsigned int len,
+		const XYPOSITION *positions);
 public:
+	// Strings up to this length are cached. Longer strings are rarely repeated.
+	enum { lengthCachedMax = BreakFinder::lengthEachSubdivision };
 	PositionCache();
+	explicit PositionCache(const PositionCache *shared_);
 	// Deleted so PositionCache objects can not be copied.
 	PositionCache(const PositionCache &) = delete;
 	PositionCache(PositionCache &&) = delete;
@@ -280,6 +301,9 @@ public:
 	void Clear() noexcept;
 	void SetSize(size_t size_);
 	size_t GetSize() const noexcept { return pces.size(); }
+	size_t GetStatistic(int statistic) const noexcept;
+	void AddStatistics(const PositionCache &other) noexcept;
+	static unsigned int Hash(unsigned int styleNumber, const char *s, unsigned int len) noexcept;
 	void MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
 		const char *s, unsigned int len, XYPOSITION *positions, const Document *pdoc);
 };
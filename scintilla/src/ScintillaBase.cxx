@@ -604,6 +604,8 @@ LexState::~LexState() {
 }
 
 LexState *ScintillaBase::DocumentLexState() {
+	// The lexer may be running on a worker thread so complete that before it is used here.
+	pdoc->FinishBackgroundStyling();
 	if (!pdoc->GetLexInterface()) {
 		pdoc->SetLexInterface(new LexState(pdoc));
 	}
@@ -933,6 +935,13 @@ sptr_t ScintillaBase::WndProc(unsigned int iMessage, uptr_t wParam, sptr_t lPara
 	case SCI_AUTOCGETORDER:
 		return ac.autoSort;
 
+	case SCI_AUTOCSETMATCH:
+		ac.match = static_cast<int>(wParam);
+		break;
+
+	case SCI_AUTOCGETMATCH:
+		return ac.match;
+
 	case SCI_USERLISTSHOW:
 		listType = static_cast<int>(wParam);
 		AutoCompleteStart(0, ConstCharPtrFromSPtr(lParam));
@@ -6,6 +6,8 @@
 // The License.txt file describes the conditions under which this software may be distributed.
 
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
 
 #include <stdexcept>
 #include <string>
@@ -17,6 +19,24 @@ using namespace Scintilla;
 
 namespace Scintilla {
 
+// Return the number of ASCII bytes at the start of the text.
+// Text is examined 8 bytes at a time as most text in documents is ASCII.
+size_t UTF8AsciiLength(std::string_view svu8) noexcept {
+	constexpr uint64_t highBits = 0x8080808080808080ULL;
+	const size_t length = svu8.length();
+	size_t i = 0;
+	while (i + sizeof(uint64_t) <= length) {
+		uint64_t word;
+		memcpy(&word, svu8.data() + i, sizeof(word));
+		if (word & highBits)
+			break;
+		i += sizeof(word);
+	}
+	while ((i < length) && UTF8IsAscii(static_cast<unsigned char>(svu8[i])))
+		i++;
+	return i;
+}
+
 size_t UTF8Length(std::wstring_view wsv) noexcept {
 	size_t len = 0;
 	for (size_t i = 0; i < wsv.length() && wsv[i];) {
@@ -101,6 +121,11 @@ void UTF8FromUTF32Character(int uch, char *putf) noexcept {
 size_t UTF16Length(std::string_view svu8) noexcept {
 	size_t ulen = 0;
 	for (size_t i = 0; i< svu8.length();) {
+		const size_t lengthAscii = UTF8AsciiLength(svu8.substr(i));
+		ulen += lengthAscii;
+		i += lengthAscii;
+		if (i >= svu8.length())
+			break;
 		const unsigned char ch = svu8[i];
 		const unsigned int byteCount = UTF8BytesOfLead[ch];
 		const unsigned int utf16Len = UTF16LengthFromUTF8ByteCount(byteCount);
@@ -178,6 +203,11 @@ size_t UTF16FromUTF8(std::string_view svu8, wchar_t *tbuf, size_t tlen) {
 size_t UTF32Length(std::string_view svu8) noexcept {
 	size_t ulen = 0;
 	for (size_t i = 0; i < svu8.length();) {
+		const size_t lengthAscii = UTF8AsciiLength(svu8.substr(i));
+		ulen += lengthAscii;
+		i += lengthAscii;
+		if (i >= svu8.length())
+			break;
 		const unsigned char ch = svu8[i];
 		const unsigned int byteCount = UTF8BytesOfLead[ch];
 		i += byteCount;
@@ -366,19 +396,44 @@ int UTF8DrawBytes(const unsigned char *us, int len) noexcept {
 }
 
 bool UTF8IsValid(std::string_view svu8) noexcept {
-	const unsigned char *us = reinterpret_cast<const unsigned char *>(svu8.data());
-	size_t remaining = svu8.length();
-	while (remaining > 0) {
-		const int utf8Status = UTF8Classify(us, remaining);
+	while (!svu8.empty()) {
+		svu8.remove_prefix(UTF8AsciiLength(svu8));
+		if (svu8.empty())
+			break;
+		const int utf8Status = UTF8Classify(svu8);
 		if (utf8Status & UTF8MaskInvalid) {
 			return false;
 		} else {
 			const int lenChar = utf8Status & UTF8MaskWidth;
-			us += lenChar;
-			remaining -= lenChar;
+			svu8.remove_prefix(lenChar);
+		}
+	}
+	return true;
+}
+
+// Count characters in the same way as moving through a document with each byte of an
+// invalid sequence being a character.
+// When countUTF16 is true, characters outside the Basic Multilingual Plane count as 2
+// as they are represented by surrogate pairs.
+size_t UTF8CountCharacters(std::string_view svu8, bool countUTF16) noexcept {
+	size_t count = 0;
+	while (!svu8.empty()) {
+		const size_t lengthAscii = UTF8AsciiLength(svu8);
+		count += lengthAscii;
+		svu8.remove_prefix(lengthAscii);
+		if (svu8.empty())
+			break;
+		const int utf8Status = UTF8Classify(svu8);
+		if (utf8Status & UTF8MaskInvalid) {
+			count++;
+			svu8.remove_prefix(1);
+		} else {
+			const int lenChar = utf8Status & UTF8MaskWidth;
+			count += (countUTF16 && (lenChar == UTF8MaxBytes)) ? 2 : 1;
+			svu8.remove_prefix(lenChar);
 		}
 	}
-	return remaining == 0;
+	return count;
 }
 
 // Replace invalid bytes in UTF-8 with the replacement character
@@ -14,6 +14,7 @@ const int UTF8MaxBytes = 4;
 
 const int unicodeReplacementChar = 0xFFFD;
 
+size_t UTF8AsciiLength(std::string_view svu8) noexcept;
 size_t UTF8Length(std::wstring_view wsv) noexcept;
 size_t UTF8PositionFromUTF16Position(std::string_view u8Text, size_t positionUTF16) noexcept;
 void UTF8FromUTF16(std::wstring_view wsv, char *putf, size_t len);
@@ -27,6 +28,7 @@ size_t UTF32FromUTF8(std::string_view svu8, unsigned int *tbuf, size_t tlen);
 std::wstring WStringFromUTF8(std::string_view svu8);
 unsigned int UTF16FromUTF32Character(unsigned int val, wchar_t *tbuf) noexcept;
 bool UTF8IsValid(std::string_view svu8) noexcept;
+size_t UTF8CountCharacters(std::string_view svu8, bool countUTF16) noexcept;
 std::string FixInvalidUTF8(const std::string &text);
 
 extern const unsigned char UTF8BytesOfLead[256];
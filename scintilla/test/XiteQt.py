@@ -39,6 +39,10 @@ class XiteWin():
 			int(self.face.features["GetDirectPointer"]["Value"]), 0,0))
 
 		self.ed = ScintillaCallable.ScintillaCallable(self.face, scifn, sciptr)
+
+		# Set to a list to record (modificationType, position, length, text) for each SCN_MODIFIED
+		self.modifications = None
+		self.form.edit.modified.connect(self.OnModified)
 		self.form.show()
 
 	def DoStuff(self):
@@ -48,6 +52,15 @@ class XiteWin():
 	def DoEvents(self):
 		QApplication.processEvents()
 
+	def OnModified(self, modificationType, position, length, linesAdded, text, line, foldNow, foldPrev):
+		if self.modifications is not None:
+			self.modifications.append((modificationType, position, length, bytes(text)))
+
+	def Type(self, text):
+		# Send characters to Scintilla as if typed
+		for ch in text:
+			QApplication.sendEvent(self.form.edit, QKeyEvent(QEvent.KeyPress, 0, Qt.NoModifier, ch))
+
 	def CmdTest(self):
 		runner = unittest.TextTestRunner()
 		tests = unittest.defaultTestLoader.loadTestsFromName(self.test)
@@ -52,6 +52,19 @@ VK_SHIFT = 16
 VK_CONTROL = 17
 VK_MENU = 18
 
+class SCNotification(ctypes.Structure):
+	# Only the fields up to those used for SCN_MODIFIED
+	_fields_ = (("hwndFrom", HWND),
+		("idFrom", WPARAM),
+		("code", c_uint),
+		("position", LPARAM),
+		("ch", c_int),
+		("modifiers", c_int),
+		("modificationType", c_int),
+		("text", ctypes.c_void_p),
+		("length", LPARAM),
+		("linesAdded", LPARAM))
+
 class OPENFILENAME(ctypes.Structure):
 	_fields_ = (("lStructSize", c_int),
 		("hwndOwner", c_int),
@@ -150,6 +163,9 @@ class XiteWin():
 
 		self.appName = "xite"
 
+		# Set to a list to record (modificationType, position, length, text) for each SCN_MODIFIED
+		self.modifications = None
+
 		self.large = "-large" in sys.argv
 
 		self.cmds = {}
@@ -226,6 +242,9 @@ class XiteWin():
 			if w != 1:
 				self.OnSize()
 			return 0
+		elif ms == "WM_NOTIFY":
+			self.OnNotify(l)
+			return 0
 		elif ms == "WM_COMMAND":
 			cmdCode = w & 0xffff
 			if cmdCode in self.cmds:
@@ -239,6 +258,17 @@ class XiteWin():
 			return user32.DefWindowProcW(h, m, w, l)
 		return 0
 
+	def OnNotify(self, l):
+		scn = ctypes.cast(l, ctypes.POINTER(SCNotification)).contents
+		if self.modifications is not None and scn.code == self.ed.SCN_MODIFIED:
+			text = ctypes.string_at(scn.text, scn.length) if scn.text else b""
+			self.modifications.append((scn.modificationType, scn.position, scn.length, text))
+
+	def Type(self, text):
+		# Send characters to Scintilla as if typed
+		for ch in text:
+			user32.SendMessageW(self.sciHwnd, msgs["WM_CHAR"], ord(ch), 0)
+
 	def Command(self, name):
 		name = name.replace(" ", "")
 		method = "Cmd" + name
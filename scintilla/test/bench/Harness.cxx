@@ -0,0 +1,246 @@
+// Benchmarks for Scintilla internal data structures
+/** @file Harness.cxx
+ ** Timing harness, synthetic corpora and main for the benchmarks.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cstdarg>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <random>
+
+#include "Platform.h"
+
+#include "ElapsedPeriod.h"
+
+#include "Harness.h"
+
+using namespace Scintilla;
+
+// Needed for PLATFORM_ASSERT in code being measured
+
+void Platform::Assert(const char *c, const char *file, int line) {
+	fprintf(stderr, "Assertion [%s] failed at %s %d\n", c, file, line);
+	abort();
+}
+
+void Platform::DebugPrintf(const char *format, ...) {
+	char buffer[2000];
+	va_list pArguments;
+	va_start(pArguments, format);
+	vsprintf(buffer, format, pArguments);
+	va_end(pArguments);
+	fprintf(stderr, "%s", buffer);
+}
+
+namespace Bench {
+
+const std::vector<std::string> &Vocabulary() {
+	static const std::vector<std::string> words = {
+		"int", "char", "const", "return", "if", "else", "for", "while", "static", "void",
+		"size_t", "position", "length", "line", "style", "value", "count", "index", "buffer", "start",
+		"end", "width", "height", "document", "lexer", "styler", "caret", "anchor", "selection", "margin",
+		"Position", "LineStart", "InsertString", "DeleteChars", "FindText", "SetStyleAt", "ValueAt",
+		"maxLength", "lengthDocument", "startPos", "endPos", "lineDoc", "subLine", "posLineEnd",
+	};
+	return words;
+}
+
+namespace {
+
+const char *const unicodeWords[] = {
+	"na\xc3\xafve", "\xce\x95\xce\xbb\xce\xbb\xce\xb7\xce\xbd\xce\xb9\xce\xba\xce\xac",
+	"\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e", "\xd0\xa0\xd1\x83\xd1\x81\xd1\x81\xd0\xba\xd0\xb8\xd0\xb9",
+	"\xf0\x9f\x99\x82", "\xc3\x9c" "ber",
+};
+
+const char *const operators[] = {
+	" = ", " + ", " - ", " * ", " < ", " > ", " == ", " != ", " && ", " || ",
+};
+
+void AppendIdentifier(std::string &s, Random &random) {
+	const std::vector<std::string> &words = Vocabulary();
+	s += words[random.Below(words.size())];
+	if (random.Below(4) == 0) {
+		s += "_";
+		s += std::to_string(random.Below(100));
+	}
+}
+
+void AppendLine(std::string &s, Random &random, bool unicode) {
+	s.append(random.Below(4), '\t');
+	switch (random.Below(6)) {
+	case 0:
+		s += "// ";
+		for (size_t word = 0; word < 3 + random.Below(8); word++) {
+			if (unicode && (random.Below(5) == 0)) {
+				s += unicodeWords[random.Below(std::size(unicodeWords))];
+			} else {
+				AppendIdentifier(s, random);
+			}
+			s += " ";
+		}
+		break;
+	case 1:
+		s += "if (";
+		AppendIdentifier(s, random);
+		s += operators[random.Below(std::size(operators))];
+		s += std::to_string(random.Below(10000));
+		s += ") {";
+		break;
+	case 2:
+		s += "}";
+		break;
+	default:
+		AppendIdentifier(s, random);
+		s += operators[random.Below(std::size(operators))];
+		AppendIdentifier(s, random);
+		s += "(";
+		AppendIdentifier(s, random);
+		s += ", \"";
+		AppendIdentifier(s, random);
+		s += "\");";
+		break;
+	}
+	s += "\n";
+}
+
+}
+
+std::string Corpus(size_t length, unsigned int seed, bool unicode) {
+	Random random(seed);
+	std::string s;
+	s.reserve(length + 200);
+	while (s.length() < length) {
+		AppendLine(s, random, unicode);
+	}
+	return s;
+}
+
+Runner::Runner() : size(0x100000), repeat(5), seed(1) {
+}
+
+bool Runner::Selected(const char *name) const {
+	return filter.empty() || strstr(name, filter.c_str());
+}
+
+void Runner::Add(const char *name, size_t bytes, size_t operations, std::vector<double> times, size_t check) {
+	results.push_back({name, bytes, operations, std::move(times), check, {}});
+	fprintf(stderr, "%-40s %10.6f s\n", name, *std::min_element(results.back().times.begin(), results.back().times.end()));
+}
+
+void Runner::Note(const char *name, const char *key, double value) {
+	for (Result &result : results) {
+		if (result.name == name) {
+			result.notes.emplace_back(key, value);
+			fprintf(stderr, "    %-36s %10.6g\n", key, value);
+		}
+	}
+}
+
+void Runner::WriteJSON(FILE *fp) const {
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"size\": %zu,\n", size);
+	fprintf(fp, "  \"repeat\": %d,\n", repeat);
+	fprintf(fp, "  \"seed\": %u,\n", seed);
+	fprintf(fp, "  \"results\": [");
+	const char *separator = "\n";
+	for (const Result &result : results) {
+		std::vector<double> sorted = result.times;
+		std::sort(sorted.begin(), sorted.end());
+		const double best = sorted.front();
+		const double median = sorted[sorted.size() / 2];
+		fprintf(fp, "%s    {\"name\": \"%s\", \"bytes\": %zu, \"operations\": %zu, "
+			"\"best\": %.9g, \"median\": %.9g, \"bytesPerSecond\": %.6g, \"check\": %zu",
+			separator, result.name.c_str(), result.bytes, result.operations,
+			best, median, (best > 0.0) ? result.bytes / best : 0.0, result.check);
+		for (const std::pair<std::string, double> &note : result.notes) {
+			fprintf(fp, ", \"%s\": %.9g", note.first.c_str(), note.second);
+		}
+		fprintf(fp, "}");
+		separator = ",\n";
+	}
+	fprintf(fp, "\n  ]\n}\n");
+}
+
+}
+
+namespace {
+
+// Sizes may have a K, M, or G suffix for binary multiples.
+size_t ParseSize(const char *text) {
+	char *end = nullptr;
+	size_t value = strtoull(text, &end, 10);
+	switch (*end) {
+	case 'k': case 'K':
+		value *= 0x400;
+		break;
+	case 'm': case 'M':
+		value *= 0x100000;
+		break;
+	case 'g': case 'G':
+		value *= 0x40000000;
+		break;
+	}
+	return value;
+}
+
+void Usage() {
+	fprintf(stderr, "usage: bench [--size=N[K|M|G]] [--repeat=N] [--seed=N] [--filter=text] [--output=file]\n");
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	Bench::Runner runner;
+	const char *output = nullptr;
+	for (int arg = 1; arg < argc; arg++) {
+		const std::string_view option(argv[arg]);
+		const size_t equals = option.find('=');
+		const std::string_view key = option.substr(0, equals);
+		const char *value = (equals == std::string_view::npos) ? "" : argv[arg] + equals + 1;
+		if (key == "--size") {
+			runner.size = ParseSize(value);
+		} else if (key == "--repeat") {
+			runner.repeat = std::max(atoi(value), 1);
+		} else if (key == "--seed") {
+			runner.seed = static_cast<unsigned int>(strtoul(value, nullptr, 10));
+		} else if (key == "--filter") {
+			runner.filter = value;
+		} else if (key == "--output") {
+			output = value;
+		} else {
+			Usage();
+			return 1;
+		}
+	}
+
+	Bench::BenchStructures(runner);
+	Bench::BenchCellBuffer(runner);
+	Bench::BenchSearch(runner);
+	Bench::BenchLexlib(runner);
+	Bench::BenchStyling(runner);
+	Bench::BenchEditor(runner);
+	Bench::BenchAutoComplete(runner);
+
+	FILE *fp = output ? fopen(output, "w") : stdout;
+	if (!fp) {
+		fprintf(stderr, "Can not write %s\n", output);
+		return 1;
+	}
+	runner.WriteJSON(fp);
+	if (output)
+		fclose(fp);
+	return 0;
+}
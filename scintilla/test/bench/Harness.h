@@ -0,0 +1,109 @@
+// Benchmarks for Scintilla internal data structures
+/** @file Harness.h
+ ** Timing harness and synthetic corpora for the benchmarks.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef HARNESS_H
+#define HARNESS_H
+
+namespace Bench {
+
+// Deterministic pseudo-random numbers so corpora and edit sequences are the same on every run.
+// std::mt19937 output is fully specified by the standard, unlike the std distributions.
+class Random {
+	std::mt19937 engine;
+public:
+	explicit Random(unsigned int seed) : engine(seed) {
+	}
+	// Value in [0, limit)
+	size_t Below(size_t limit) {
+		if (limit == 0)
+			return 0;
+		// Separate statements as the order of evaluation within an expression is unspecified
+		const unsigned long long high = engine();
+		const unsigned long long value = (high << 32) | engine();
+		return static_cast<size_t>(value % limit);
+	}
+};
+
+// Generate text resembling source code of approximately length bytes with '\n' line ends.
+// When unicode is true some lines contain non-ASCII UTF-8 characters.
+std::string Corpus(size_t length, unsigned int seed, bool unicode);
+
+// A selection of identifiers that appear in Corpus so searches and keyword lookups find matches.
+const std::vector<std::string> &Vocabulary();
+
+struct Result {
+	std::string name;
+	size_t bytes;
+	size_t operations;
+	std::vector<double> times;
+	size_t check;
+	// Further measurements made by the benchmark such as cache hit rates
+	std::vector<std::pair<std::string, double>> notes;
+};
+
+class Runner {
+	std::vector<Result> results;
+	bool Selected(const char *name) const;
+	void Add(const char *name, size_t bytes, size_t operations, std::vector<double> times, size_t check);
+public:
+	size_t size;
+	int repeat;
+	unsigned int seed;
+	std::string filter;
+
+	Runner();
+
+	// Time run, which returns a value that depends on its work so it can not be optimized away.
+	// bytes is the amount of data processed and operations the number of calls made by one run.
+	template <typename Run>
+	void Measure(const char *name, size_t bytes, size_t operations, Run run) {
+		if (!Selected(name))
+			return;
+		std::vector<double> times;
+		size_t check = 0;
+		for (int r = 0; r < repeat; r++) {
+			Scintilla::ElapsedPeriod ep;
+			check = run();
+			times.push_back(ep.Duration());
+		}
+		Add(name, bytes, operations, times, check);
+	}
+
+	// Like Measure but setup, which returns a std::unique_ptr to the state used by run, is not timed.
+	template <typename Setup, typename Run>
+	void MeasureWithSetup(const char *name, size_t bytes, size_t operations, Setup setup, Run run) {
+		if (!Selected(name))
+			return;
+		std::vector<double> times;
+		size_t check = 0;
+		for (int r = 0; r < repeat; r++) {
+			auto state = setup();
+			Scintilla::ElapsedPeriod ep;
+			check = run(*state);
+			times.push_back(ep.Duration());
+		}
+		Add(name, bytes, operations, times, check);
+	}
+
+	// Attach a further measurement to the result called name if it was run.
+	void Note(const char *name, const char *key, double value);
+
+	void WriteJSON(FILE *fp) const;
+};
+
+// Each file of benchmarks provides one function that measures all of its cases.
+void BenchStructures(Runner &runner);
+void BenchCellBuffer(Runner &runner);
+void BenchSearch(Runner &runner);
+void BenchLexlib(Runner &runner);
+void BenchStyling(Runner &runner);
+void BenchEditor(Runner &runner);
+void BenchAutoComplete(Runner &runner);
+
+}
+
+#endif
@@ -0,0 +1,309 @@
+// Benchmarks for Scintilla internal data structures
+/** @file PlatHeadless.cxx
+ ** Platform layer that draws nothing so an Editor can be measured without a display.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "Platform.h"
+
+#include "UniConversion.h"
+
+#include "PlatHeadless.h"
+
+using namespace Scintilla;
+
+namespace Bench {
+
+namespace {
+
+std::atomic<size_t> drawCalls(0);
+
+void Drawn() noexcept {
+	drawCalls++;
+}
+
+struct FontHeadless {
+	XYPOSITION size;
+	explicit FontHeadless(XYPOSITION size_) noexcept : size(size_) {
+	}
+};
+
+XYPOSITION SizeOf(const Font &font_) noexcept {
+	const FontHeadless *pfh = static_cast<const FontHeadless *>(font_.GetID());
+	return pfh ? pfh->size : 10.0f;
+}
+
+class SurfaceHeadless : public Surface {
+	bool unicodeMode = false;
+public:
+	void Init(WindowID) override {}
+	void Init(SurfaceID, WindowID) override {}
+	void InitPixMap(int, int, Surface *, WindowID) override {}
+	void Release() override {}
+	bool Initialised() override { return true; }
+	void PenColour(ColourDesired) override {}
+	int LogPixelsY() override { return 72; }
+	int DeviceHeightFont(int points) override { return points; }
+	void MoveTo(int, int) override {}
+	void LineTo(int, int) override { Drawn(); }
+	void Polygon(Point *, size_t, ColourDesired, ColourDesired) override { Drawn(); }
+	void RectangleDraw(PRectangle, ColourDesired, ColourDesired) override { Drawn(); }
+	void FillRectangle(PRectangle, ColourDesired) override { Drawn(); }
+	void FillRectangle(PRectangle, Surface &) override { Drawn(); }
+	void RoundedRectangle(PRectangle, ColourDesired, ColourDesired) override { Drawn(); }
+	void AlphaRectangle(PRectangle, int, ColourDesired, int, ColourDesired, int, int) override { Drawn(); }
+	void GradientRectangle(PRectangle, const std::vector<ColourStop> &, GradientOptions) override { Drawn(); }
+	void DrawRGBAImage(PRectangle, int, int, const unsigned char *) override { Drawn(); }
+	void Ellipse(PRectangle, ColourDesired, ColourDesired) override { Drawn(); }
+	void Copy(PRectangle, Point, Surface &) override { Drawn(); }
+
+	std::unique_ptr<IScreenLineLayout> Layout(const IScreenLine *) override { return {}; }
+
+	void DrawTextNoClip(PRectangle, Font &, XYPOSITION, std::string_view, ColourDesired, ColourDesired) override { Drawn(); }
+	void DrawTextClipped(PRectangle, Font &, XYPOSITION, std::string_view, ColourDesired, ColourDesired) override { Drawn(); }
+	void DrawTextTransparent(PRectangle, Font &, XYPOSITION, std::string_view, ColourDesired) override { Drawn(); }
+	void MeasureWidths(Font &font_, std::string_view text, XYPOSITION *positions) override;
+	XYPOSITION WidthText(Font &font_, std::string_view text) override;
+	XYPOSITION Ascent(Font &font_) override { return SizeOf(font_) * 0.8f; }
+	XYPOSITION Descent(Font &font_) override { return SizeOf(font_) * 0.2f; }
+	XYPOSITION InternalLeading(Font &) override { return 0; }
+	XYPOSITION Height(Font &font_) override { return Ascent(font_) + Descent(font_); }
+	XYPOSITION AverageCharWidth(Font &font_) override { return SizeOf(font_) * 0.6f; }
+
+	void SetClip(PRectangle) override {}
+	void FlushCachedState() override {}
+
+	void SetUnicodeMode(bool unicodeMode_) override { unicodeMode = unicodeMode_; }
+	void SetDBCSMode(int) override {}
+	void SetBidiR2L(bool) override {}
+	bool ThreadSafeMeasureWidths() override { return true; }
+};
+
+// All bytes of a character are placed at its end as on Win32.
+void SurfaceHeadless::MeasureWidths(Font &font_, std::string_view text, XYPOSITION *positions) {
+	const XYPOSITION widthChar = SizeOf(font_) * 0.6f;
+	XYPOSITION position = 0;
+	size_t i = 0;
+	while (i < text.length()) {
+		size_t lenChar = 1;
+		XYPOSITION width = widthChar;
+		if (unicodeMode) {
+			const unsigned char *us = reinterpret_cast<const unsigned char *>(text.data() + i);
+			const int utf8Status = UTF8Classify(us, text.length() - i);
+			if (!(utf8Status & UTF8MaskInvalid)) {
+				lenChar = utf8Status & UTF8MaskWidth;
+				if (UnicodeFromUTF8(us) >= 0x1100) {
+					width = widthChar * 2;
+				}
+			}
+		}
+		position += width;
+		for (size_t b = 0; b < lenChar; b++) {
+			positions[i++] = position;
+		}
+	}
+}
+
+XYPOSITION SurfaceHeadless::WidthText(Font &font_, std::string_view text) {
+	if (text.empty())
+		return 0;
+	std::vector<XYPOSITION> positions(text.length());
+	MeasureWidths(font_, text, positions.data());
+	return positions.back();
+}
+
+HeadlessWindow *PWindow(WindowID wid) noexcept {
+	return static_cast<HeadlessWindow *>(wid);
+}
+
+// Holds the list text with the start of each item instead of creating a widget for each item.
+class ListBoxHeadless : public ListBox {
+	HeadlessWindow window;
+	std::string text;
+	std::vector<size_t> starts;
+	char separator = ' ';
+	char typesep = '?';
+	int selection = -1;
+public:
+	void SetFont(Font &) override {}
+	void Create(Window &, int, Point, int, bool, int) override {
+		wid = &window;
+	}
+	void SetAverageCharWidth(int) override {}
+	void SetVisibleRows(int) override {}
+	int GetVisibleRows() const override { return 9; }
+	PRectangle GetDesiredRect() override { return PRectangle(0, 0, 200, 100); }
+	int CaretFromEdge() override { return 0; }
+	void Clear() override {
+		text.clear();
+		starts.clear();
+		selection = -1;
+	}
+	void Append(char *s, int) override {
+		if (!starts.empty())
+			text.push_back(separator);
+		starts.push_back(text.length());
+		text += s;
+	}
+	int Length() override { return static_cast<int>(starts.size()); }
+	void Select(int n) override { selection = n; }
+	int GetSelection() override { return selection; }
+	int Find(const char *) override { return -1; }
+	void GetValue(int n, char *value, int len) override;
+	void RegisterImage(int, const char *) override {}
+	void RegisterRGBAImage(int, int, int, const unsigned char *) override {}
+	void ClearRegisteredImages() override {}
+	void SetDelegate(IListBoxDelegate *) override {}
+	void SetList(const char *list, char separator_, char typesep_) override;
+};
+
+void ListBoxHeadless::GetValue(int n, char *value, int len) {
+	if (len <= 0)
+		return;
+	value[0] = '\0';
+	if ((n < 0) || (n >= Length()))
+		return;
+	const size_t end = (n + 1 < Length()) ? starts[n + 1] - 1 : text.length();
+	std::string_view item(text.data() + starts[n], end - starts[n]);
+	item = item.substr(0, item.rfind(typesep));
+	const size_t length = std::min(item.length(), static_cast<size_t>(len - 1));
+	memcpy(value, item.data(), length);
+	value[length] = '\0';
+}
+
+void ListBoxHeadless::SetList(const char *list, char separator_, char typesep_) {
+	Clear();
+	separator = separator_;
+	typesep = typesep_;
+	text = list;
+	starts.push_back(0);
+	for (size_t i = 0; i < text.length(); i++) {
+		if (text[i] == separator)
+			starts.push_back(i + 1);
+	}
+}
+
+}
+
+size_t HeadlessDrawCalls() noexcept {
+	return drawCalls;
+}
+
+}
+
+using namespace Bench;
+
+Font::Font() noexcept : fid(nullptr) {
+}
+
+Font::~Font() {
+}
+
+void Font::Create(const FontParameters &fp) {
+	Release();
+	fid = new FontHeadless(fp.size);
+}
+
+void Font::Release() {
+	delete static_cast<FontHeadless *>(fid);
+	fid = nullptr;
+}
+
+Surface *Surface::Allocate(int) {
+	return new SurfaceHeadless();
+}
+
+Window::~Window() {
+}
+
+void Window::Destroy() {
+	wid = nullptr;
+}
+
+PRectangle Window::GetPosition() const {
+	return wid ? PWindow(wid)->position : PRectangle();
+}
+
+void Window::SetPosition(PRectangle rc) {
+	if (wid)
+		PWindow(wid)->position = rc;
+}
+
+void Window::SetPositionRelative(PRectangle rc, const Window *) {
+	SetPosition(rc);
+}
+
+PRectangle Window::GetClientPosition() const {
+	const PRectangle rc = GetPosition();
+	return PRectangle(0, 0, rc.Width(), rc.Height());
+}
+
+void Window::Show(bool) {
+}
+
+void Window::InvalidateAll() {
+}
+
+void Window::InvalidateRectangle(PRectangle) {
+}
+
+void Window::SetFont(Font &) {
+}
+
+void Window::SetCursor(Cursor curs) {
+	cursorLast = curs;
+}
+
+PRectangle Window::GetMonitorRect(Point) {
+	return GetPosition();
+}
+
+ListBox::ListBox() noexcept {
+}
+
+ListBox::~ListBox() {
+}
+
+ListBox *ListBox::Allocate() {
+	return new ListBoxHeadless();
+}
+
+ColourDesired Platform::Chrome() {
+	return ColourDesired(0xe0, 0xe0, 0xe0);
+}
+
+ColourDesired Platform::ChromeHighlight() {
+	return ColourDesired(0xff, 0xff, 0xff);
+}
+
+const char *Platform::DefaultFont() {
+	return "Headless";
+}
+
+int Platform::DefaultFontSize() {
+	return 10;
+}
+
+unsigned int Platform::DoubleClickTime() {
+	return 500;
+}
+
+void Platform::DebugDisplay(const char *s) {
+	fprintf(stderr, "%s", s);
+}
+
+bool Platform::ShowAssertionPopUps(bool) {
+	return false;
+}
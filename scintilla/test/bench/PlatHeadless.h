@@ -0,0 +1,26 @@
+// Benchmarks for Scintilla internal data structures
+/** @file PlatHeadless.h
+ ** Platform layer that draws nothing so an Editor can be measured without a display.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef PLATHEADLESS_H
+#define PLATHEADLESS_H
+
+namespace Bench {
+
+// A WindowID points to one of these so windows have a size without a windowing system.
+struct HeadlessWindow {
+	Scintilla::PRectangle position;
+};
+
+// Text metrics are derived only from the font size so results are the same on every machine:
+// each character is 0.6 of the size wide, except characters from U+1100 which are twice as wide.
+// Drawing calls are counted instead of being performed.
+// List boxes keep their items as text so autocompletion can be measured.
+size_t HeadlessDrawCalls() noexcept;
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+# Build the benchmarks with Microsoft Visual C++ using nmake
+
+DEL = del /q
+EXE = bench.exe
+
+INCLUDEDIRS = /I../../include /I../../src /I../../lexlib
+
+# Measure optimized code without assertions
+CXXFLAGS = /EHsc /std:c++latest /O2 /DNDEBUG /wd 4805 $(INCLUDEDIRS)
+
+SIZE=1M
+REPEAT=5
+
+# Files in this directory containing benchmarks
+BENCHSRC=bench*.cxx
+# Files being measured from the scintilla/src, lexlib, and lexers directories
+MEASUREDSRC=\
+ ../../lexers/LexCPP.cxx \
+ ../../lexlib/Accessor.cxx \
+ ../../lexlib/CharacterCategory.cxx \
+ ../../lexlib/CharacterSet.cxx \
+ ../../lexlib/DefaultLexer.cxx \
+ ../../lexlib/LexerBase.cxx \
+ ../../lexlib/LexerModule.cxx \
+ ../../lexlib/LexerSimple.cxx \
+ ../../lexlib/PropSetSimple.cxx \
+ ../../lexlib/StyleContext.cxx \
+ ../../lexlib/WordList.cxx \
+ ../../src/AutoComplete.cxx \
+ ../../src/BackgroundStyler.cxx \
+ ../../src/CaseConvert.cxx \
+ ../../src/CaseFolder.cxx \
+ ../../src/CellBuffer.cxx \
+ ../../src/CharClassify.cxx \
+ ../../src/ContractionState.cxx \
+ ../../src/DBCS.cxx \
+ ../../src/Decoration.cxx \
+ ../../src/Document.cxx \
+ ../../src/EditModel.cxx \
+ ../../src/Editor.cxx \
+ ../../src/EditView.cxx \
+ ../../src/Indicator.cxx \
+ ../../src/KeyMap.cxx \
+ ../../src/LineMarker.cxx \
+ ../../src/MarginView.cxx \
+ ../../src/PerLine.cxx \
+ ../../src/PositionCache.cxx \
+ ../../src/RESearch.cxx \
+ ../../src/RunStyles.cxx \
+ ../../src/Selection.cxx \
+ ../../src/Style.cxx \
+ ../../src/UniConversion.cxx \
+ ../../src/UniqueString.cxx \
+ ../../src/ViewStyle.cxx \
+ ../../src/XPM.cxx
+
+all: $(EXE)
+
+run: $(EXE)
+	$(EXE) --size=$(SIZE) --repeat=$(REPEAT)
+
+json: $(EXE)
+	$(EXE) --size=$(SIZE) --repeat=$(REPEAT) --output=bench-$(SIZE).json
+
+clean:
+	$(DEL) $(EXE) *.o *.obj *.exe *.json
+
+$(EXE): $(BENCHSRC) $(MEASUREDSRC) Harness.obj PlatHeadless.obj
+	$(CXX) $(CXXFLAGS) /Fe$@ $**
@@ -0,0 +1,172 @@
+// Benchmarks for Scintilla internal data structures
+/** @file benchAutoComplete.cxx
+ ** Benchmarks for sorting autocompletion lists and narrowing them as a word is typed.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <random>
+
+#include "Platform.h"
+
+#include "Scintilla.h"
+#include "Position.h"
+#include "AutoComplete.h"
+#include "ElapsedPeriod.h"
+
+#include "Harness.h"
+
+using namespace Scintilla;
+
+namespace Bench {
+
+namespace {
+
+constexpr size_t symbolCount = 100000;
+
+// Join words from the vocabulary into distinct identifiers like "lineStartPosition2",
+// returned in random order as an application might read them from an API file.
+std::vector<std::string> Symbols(unsigned int seed) {
+	Random random(seed);
+	const std::vector<std::string> &words = Vocabulary();
+	std::set<std::string> unique;
+	std::vector<std::string> symbols;
+	while (symbols.size() < symbolCount) {
+		std::string symbol = words[random.Below(words.size())];
+		const size_t parts = 1 + random.Below(3);
+		for (size_t part = 0; part < parts; part++) {
+			std::string word = words[random.Below(words.size())];
+			word[0] = static_cast<char>(toupper(static_cast<unsigned char>(word[0])));
+			symbol += word;
+		}
+		if (random.Below(3) == 0)
+			symbol += std::to_string(random.Below(10));
+		if (unique.insert(symbol).second)
+			symbols.push_back(symbol);
+	}
+	return symbols;
+}
+
+std::string Joined(const std::vector<std::string> &symbols) {
+	std::string list;
+	for (const std::string &symbol : symbols) {
+		if (!list.empty())
+			list += ' ';
+		list += symbol;
+	}
+	return list;
+}
+
+// The characters typed to find a symbol by its initials, such as "lsp" for "lineStartPosition".
+std::string Initials(const std::string &symbol) {
+	std::string initials(1, symbol[0]);
+	for (size_t i = 1; i < symbol.length(); i++) {
+		if (isupper(static_cast<unsigned char>(symbol[i])))
+			initials += static_cast<char>(tolower(static_cast<unsigned char>(symbol[i])));
+	}
+	return initials;
+}
+
+// The time of each keystroke is the fastest over the repetitions so the slowest keystroke
+// is not just the one interrupted by another process.
+struct Keystrokes {
+	std::vector<double> durations;
+	size_t count = 0;
+	double Slowest() const {
+		return durations.empty() ? 0.0 : *std::max_element(durations.begin(), durations.end());
+	}
+};
+
+// Type each target a character at a time, selecting after each, and return a sum of the selections.
+size_t TypeTargets(AutoComplete &ac, const std::vector<std::string> &typed, Keystrokes &keystrokes) {
+	size_t sum = 0;
+	keystrokes.count = 0;
+	for (const std::string &word : typed) {
+		for (size_t length = 1; length <= word.length(); length++) {
+			const std::string prefix = word.substr(0, length);
+			ElapsedPeriod ep;
+			ac.Select(prefix.c_str());
+			const double duration = ep.Duration();
+			if (keystrokes.count < keystrokes.durations.size())
+				keystrokes.durations[keystrokes.count] = std::min(keystrokes.durations[keystrokes.count], duration);
+			else
+				keystrokes.durations.push_back(duration);
+			sum += ac.GetSelection() + 1;
+			keystrokes.count++;
+		}
+	}
+	return sum;
+}
+
+void NoteKeystrokes(Runner &runner, const char *name, const Keystrokes &keystrokes) {
+	runner.Note(name, "keystrokes", static_cast<double>(keystrokes.count));
+	runner.Note(name, "slowestKeystroke", keystrokes.Slowest());
+}
+
+}
+
+void BenchAutoComplete(Runner &runner) {
+	const std::vector<std::string> symbols = Symbols(runner.seed);
+	const std::string unsorted = Joined(symbols);
+	std::vector<std::string> sorted = symbols;
+	std::sort(sorted.begin(), sorted.end());
+	const std::string list = Joined(sorted);
+
+	Window parent;
+	AutoComplete ac;
+	ac.autoHide = false;
+	ac.Start(parent, 0, 0, Point(), 0, 10, false, SC_TECHNOLOGY_DEFAULT);
+
+	runner.Measure("AutoComplete.Sort", unsorted.length(), 1, [&]() {
+		ac.autoSort = SC_ORDER_PERFORMSORT;
+		ac.SetList(unsorted.c_str());
+		return static_cast<size_t>(ac.lb->Length());
+	});
+
+	ac.autoSort = SC_ORDER_PRESORTED;
+	ac.SetList(list.c_str());
+
+	std::vector<std::string> typedPrefix;
+	std::vector<std::string> typedInitials;
+	Random random(runner.seed);
+	for (size_t target = 0; target < 1000; target++) {
+		const std::string &symbol = symbols[random.Below(symbols.size())];
+		typedPrefix.push_back(symbol);
+		typedInitials.push_back(Initials(symbol));
+	}
+
+	Keystrokes keystrokes;
+	runner.Measure("AutoComplete.Prefix", list.length(), 1, [&]() {
+		ac.match = SC_AUTOCMATCH_PREFIX;
+		return TypeTargets(ac, typedPrefix, keystrokes);
+	});
+	NoteKeystrokes(runner, "AutoComplete.Prefix", keystrokes);
+
+	// Applications choose subsequence matching before showing the list
+	runner.Measure("AutoComplete.SubsequenceList", list.length(), 1, [&]() {
+		ac.match = SC_AUTOCMATCH_SUBSEQUENCE;
+		ac.SetList(list.c_str());
+		return static_cast<size_t>(ac.lb->Length());
+	});
+
+	keystrokes = Keystrokes();
+	runner.Measure("AutoComplete.Subsequence", list.length(), 1, [&]() {
+		ac.match = SC_AUTOCMATCH_SUBSEQUENCE;
+		return TypeTargets(ac, typedInitials, keystrokes);
+	});
+	NoteKeystrokes(runner, "AutoComplete.Subsequence", keystrokes);
+}
+
+}
@@ -0,0 +1,122 @@
+// Benchmarks for Scintilla internal data structures
+/** @file benchCellBuffer.cxx
+ ** Benchmarks for CellBuffer insertion, deletion, and undo.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <random>
+
+#include "Platform.h"
+
+#include "Scintilla.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "ElapsedPeriod.h"
+
+#include "Harness.h"
+
+using namespace Scintilla;
+
+namespace Bench {
+
+namespace {
+
+constexpr int typedCharacters = 100000;
+constexpr size_t scatteredEdits = 10000;
+
+std::unique_ptr<CellBuffer> LoadedCellBuffer(const std::string &text, bool chunked) {
+	std::unique_ptr<CellBuffer> cb = std::make_unique<CellBuffer>(true, false, chunked);
+	cb->SetUndoCollection(false);
+	bool startSequence = false;
+	cb->InsertString(0, text.c_str(), text.length(), startSequence);
+	cb->SetUndoCollection(true);
+	return cb;
+}
+
+// Type characters and line ends at a moving position, producing a new undo step for each line.
+void Type(CellBuffer &cb) {
+	bool startSequence = false;
+	Sci::Position position = cb.Length() / 2;
+	for (int i = 0; i < typedCharacters; i++) {
+		const char ch = ((i % 60) == 59) ? '\n' : static_cast<char>('a' + i % 26);
+		cb.InsertString(position, &ch, 1, startSequence);
+		position++;
+	}
+}
+
+void BenchLoadAndEdit(Runner &runner, const std::string &corpus, bool chunked) {
+	const size_t length = corpus.length();
+	const std::string prefix = chunked ? "CellBufferChunked." : "CellBuffer.";
+
+	runner.Measure((prefix + "Load").c_str(), length, 1, [&]() {
+		return static_cast<size_t>(LoadedCellBuffer(corpus, chunked)->Lines());
+	});
+
+	runner.MeasureWithSetup((prefix + "Typing").c_str(), length, typedCharacters,
+		[&]() { return LoadedCellBuffer(corpus, chunked); },
+		[&](CellBuffer &cb) {
+		Type(cb);
+		return static_cast<size_t>(cb.Lines());
+	});
+
+	runner.MeasureWithSetup((prefix + "DeleteScattered").c_str(), length, scatteredEdits,
+		[&]() { return LoadedCellBuffer(corpus, chunked); },
+		[&](CellBuffer &cb) {
+		Random random(runner.seed);
+		bool startSequence = false;
+		for (size_t i = 0; i < scatteredEdits && cb.Length() > 10; i++) {
+			cb.DeleteChars(random.Below(cb.Length() - 10), 10, startSequence);
+		}
+		return static_cast<size_t>(cb.Lines());
+	});
+
+	runner.MeasureWithSetup((prefix + "UndoRedo").c_str(), length, typedCharacters * 2,
+		[&]() {
+			std::unique_ptr<CellBuffer> cb = LoadedCellBuffer(corpus, chunked);
+			Type(*cb);
+			return cb;
+		},
+		[&](CellBuffer &cb) {
+		size_t steps = 0;
+		while (cb.CanUndo()) {
+			const int stepsUndo = cb.StartUndo();
+			for (int step = 0; step < stepsUndo; step++) {
+				cb.PerformUndoStep();
+			}
+			steps += stepsUndo;
+		}
+		while (cb.CanRedo()) {
+			const int stepsRedo = cb.StartRedo();
+			for (int step = 0; step < stepsRedo; step++) {
+				cb.PerformRedoStep();
+			}
+			steps += stepsRedo;
+		}
+		return steps;
+	});
+}
+
+}
+
+void BenchCellBuffer(Runner &runner) {
+	const std::string corpus = Corpus(runner.size, runner.seed, true);
+	BenchLoadAndEdit(runner, corpus, false);
+	BenchLoadAndEdit(runner, corpus, true);
+}
+
+}
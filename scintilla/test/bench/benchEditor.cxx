@@ -0,0 +1,333 @@
+// Benchmarks for Scintilla internal data structures
+/** @file benchEditor.cxx
+ ** Benchmarks for laying out, wrapping, and painting with an Editor on the headless platform.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <set>
+#include <forward_list>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <random>
+
+#include "Platform.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Scintilla.h"
+#include "SciLexer.h"
+
+#include "LexerModule.h"
+#include "CharacterCategory.h"
+#include "Position.h"
+#include "UniqueString.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "ContractionState.h"
+#include "CellBuffer.h"
+#include "KeyMap.h"
+#include "Indicator.h"
+#include "LineMarker.h"
+#include "Style.h"
+#include "ViewStyle.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "UniConversion.h"
+#include "Selection.h"
+#include "PositionCache.h"
+#include "EditModel.h"
+#include "MarginView.h"
+#include "EditView.h"
+#include "Editor.h"
+#include "ElapsedPeriod.h"
+
+#include "Harness.h"
+#include "PlatHeadless.h"
+
+extern Scintilla::LexerModule lmCPP;
+
+using namespace Scintilla;
+
+namespace Bench {
+
+namespace {
+
+class BenchLexInterface : public LexInterface {
+public:
+	BenchLexInterface(Document *pdoc_, ILexer4 *instance_) : LexInterface(pdoc_) {
+		instance = instance_;
+	}
+	~BenchLexInterface() override {
+		instance->Release();
+	}
+};
+
+// An Editor in a headless window that exposes the steps of scrolling and painting.
+class HeadlessEditor : public Editor {
+	HeadlessWindow window;
+public:
+	explicit HeadlessEditor(PRectangle rc) {
+		window.position = rc;
+		wMain = &window;
+	}
+	~HeadlessEditor() override {
+		wMain = nullptr;
+	}
+	void Initialise() override {}
+	void SetVerticalScrollPos() override {}
+	void SetHorizontalScrollPos() override {}
+	bool ModifyScrollBars(Sci::Line, Sci::Line) override { return false; }
+	void Copy() override {}
+	void Paste() override {}
+	void ClaimSelection() override {}
+	void NotifyChange() override {}
+	void NotifyParent(SCNotification) override {}
+	void CopyToClipboard(const SelectionText &) override {}
+	void SetMouseCapture(bool) override {}
+	bool HaveMouseCapture() override { return false; }
+	bool FineTickerRunning(TickReason) override { return false; }
+	void FineTickerStart(TickReason, int, int) override {}
+	void FineTickerCancel(TickReason) override {}
+	// Wrapping is performed by the benchmarks instead of in idle time.
+	bool SetIdle(bool) override { return true; }
+	sptr_t DefWndProc(unsigned int, uptr_t, sptr_t) override { return 0; }
+
+	sptr_t Send(unsigned int iMessage, uptr_t wParam = 0, sptr_t lParam = 0) {
+		return WndProc(iMessage, wParam, lParam);
+	}
+	void SetLexer(ILexer4 *lexer) {
+		pdoc->SetLexInterface(new BenchLexInterface(pdoc, lexer));
+	}
+	void ClearCaches() {
+		view.posCache.Clear();
+		view.llc.Invalidate(LineLayout::llInvalid);
+	}
+	size_t CacheStatistic(int statistic) const noexcept {
+		return view.posCache.GetStatistic(statistic);
+	}
+	Sci::Line PageLines() const {
+		return LinesOnScreen();
+	}
+	Sci::Line LastTopLine() const {
+		return MaxScrollPos();
+	}
+	Sci::Line DisplayLines() const {
+		return pcs->LinesDisplayed();
+	}
+	void Scroll(Sci::Line line) {
+		ScrollTo(line);
+	}
+	// Lay out every line of the document as if it was unwrapped and return the total width.
+	size_t LayoutDocument() {
+		AutoSurface surface(this);
+		RefreshStyleData();
+		size_t width = 0;
+		for (Sci::Line line = 0; line < pdoc->LinesTotal(); line++) {
+			AutoLineLayout ll(view.llc, view.RetrieveLineLayout(line, *this));
+			view.LayoutLine(*this, line, surface, vs, ll);
+			width += static_cast<size_t>(ll->positions[ll->numCharsInLine]);
+		}
+		return width;
+	}
+	// Lay out the lines that will be shown so they are in the line layout cache when painting.
+	size_t LayoutVisible() {
+		AutoSurface surface(this);
+		RefreshStyleData();
+		size_t lines = 0;
+		Sci::Line linePrevious = -1;
+		for (Sci::Line visible = topLine; visible <= topLine + LinesOnScreen(); visible++) {
+			const Sci::Line line = pcs->DocFromDisplay(visible);
+			if ((line != linePrevious) && (line < pdoc->LinesTotal())) {
+				AutoLineLayout ll(view.llc, view.RetrieveLineLayout(line, *this));
+				view.LayoutLine(*this, line, surface, vs, ll, wrapWidth);
+				lines += ll->lines;
+				linePrevious = line;
+			}
+		}
+		return lines;
+	}
+	// Paint the whole window as a platform layer would for an expose event.
+	void PaintWindow() {
+		paintState = painting;
+		rcPaint = GetClientRectangle();
+		paintingAllText = true;
+		AutoSurface surfaceWindow(this);
+		Paint(surfaceWindow, rcPaint);
+		if (paintState == paintAbandoned) {
+			paintState = painting;
+			Paint(surfaceWindow, rcPaint);
+		}
+		paintState = notPainting;
+	}
+	void WrapDocument() {
+		NeedWrapping();
+		WrapLines(WrapScope::wsAll);
+	}
+};
+
+std::unique_ptr<HeadlessEditor> CreateEditor(const std::string &text, int width, int wrapMode) {
+	auto editor = std::make_unique<HeadlessEditor>(PRectangle(0, 0, static_cast<XYPOSITION>(width), 800));
+	editor->Send(SCI_SETCODEPAGE, SC_CP_UTF8);
+	editor->Send(SCI_SETUNDOCOLLECTION, 0);
+	editor->Send(SCI_SETLAYOUTCACHE, SC_CACHE_PAGE);
+	editor->Send(SCI_SETMARGINWIDTHN, 0, 40);
+	// Styles of different sizes and weights so runs are split and measured separately
+	editor->Send(SCI_STYLESETSIZE, STYLE_DEFAULT, 10);
+	editor->Send(SCI_STYLECLEARALL);
+	editor->Send(SCI_STYLESETBOLD, SCE_C_WORD, 1);
+	editor->Send(SCI_STYLESETITALIC, SCE_C_COMMENTLINE, 1);
+	editor->Send(SCI_STYLESETSIZE, SCE_C_STRING, 9);
+	editor->Send(SCI_SETWRAPMODE, wrapMode);
+	ILexer4 *lexer = lmCPP.Create();
+	lexer->WordListSet(0, "break case char const else for if int return static struct void while");
+	editor->SetLexer(lexer);
+	editor->Send(SCI_APPENDTEXT, text.length(), reinterpret_cast<sptr_t>(text.c_str()));
+	editor->Send(SCI_COLOURISE, 0, -1);
+	return editor;
+}
+
+// Mark many short ranges with each of many indicators as lint, search, and spelling
+// features would, with some indicators changing the text colour.
+void AddIndicators(HeadlessEditor &editor, int indicators, unsigned int seed) {
+	Random random(seed);
+	const Sci::Position length = editor.Send(SCI_GETLENGTH);
+	for (int indicator = 0; indicator < indicators; indicator++) {
+		const int style = (indicator % 4 == 3) ? INDIC_TEXTFORE : (INDIC_SQUIGGLE + indicator % 6);
+		editor.Send(SCI_INDICSETSTYLE, indicator, style);
+		editor.Send(SCI_INDICSETUNDER, indicator, indicator % 2);
+		editor.Send(SCI_SETINDICATORCURRENT, indicator);
+		Sci::Position position = 20 + random.Below(380);
+		while (position < length) {
+			const Sci::Position fill = std::min<Sci::Position>(1 + random.Below(12), length - position);
+			editor.Send(SCI_INDICATORFILLRANGE, position, fill);
+			position += fill + 20 + random.Below(380);
+		}
+	}
+}
+
+struct FrameTimes {
+	size_t frames = 0;
+	double layout = 0.0;
+	double paint = 0.0;
+	size_t hits = 0;
+	size_t misses = 0;
+};
+
+// Scroll from the start to the end of the document a page at a time, laying out the newly
+// visible lines then painting them, as happens when paging through a file.
+size_t ScrollThrough(HeadlessEditor &editor, FrameTimes &times) {
+	times = FrameTimes();
+	editor.ClearCaches();
+	const size_t hitsStart = editor.CacheStatistic(SC_POSITIONCACHE_HITS);
+	const size_t missesStart = editor.CacheStatistic(SC_POSITIONCACHE_MISSES);
+	const size_t drawCallsStart = HeadlessDrawCalls();
+	const Sci::Line page = std::max<Sci::Line>(editor.PageLines(), 1);
+	size_t lines = 0;
+	for (Sci::Line top = 0; top <= editor.LastTopLine(); top += page) {
+		editor.Scroll(top);
+		ElapsedPeriod epLayout;
+		lines += editor.LayoutVisible();
+		times.layout += epLayout.Duration();
+		ElapsedPeriod epPaint;
+		editor.PaintWindow();
+		times.paint += epPaint.Duration();
+		times.frames++;
+	}
+	times.hits = editor.CacheStatistic(SC_POSITIONCACHE_HITS) - hitsStart;
+	times.misses = editor.CacheStatistic(SC_POSITIONCACHE_MISSES) - missesStart;
+	return lines + HeadlessDrawCalls() - drawCallsStart;
+}
+
+double HitRate(size_t hits, size_t misses) noexcept {
+	return (hits + misses) ? static_cast<double>(hits) / (hits + misses) : 0.0;
+}
+
+void NoteFrames(Runner &runner, const char *name, const FrameTimes &times) {
+	if (times.frames) {
+		runner.Note(name, "frames", static_cast<double>(times.frames));
+		runner.Note(name, "layoutPerFrame", times.layout / times.frames);
+		runner.Note(name, "paintPerFrame", times.paint / times.frames);
+		runner.Note(name, "positionCacheHitRate", HitRate(times.hits, times.misses));
+	}
+}
+
+}
+
+void BenchEditor(Runner &runner) {
+	const std::string corpus = Corpus(runner.size, runner.seed, true);
+
+	std::unique_ptr<HeadlessEditor> editor = CreateEditor(corpus, 1000, SC_WRAP_NONE);
+	size_t hits = 0;
+	size_t misses = 0;
+
+	runner.Measure("Editor.Layout", corpus.length(), editor->Send(SCI_GETLINECOUNT), [&]() {
+		editor->ClearCaches();
+		const size_t hitsStart = editor->CacheStatistic(SC_POSITIONCACHE_HITS);
+		const size_t missesStart = editor->CacheStatistic(SC_POSITIONCACHE_MISSES);
+		const size_t width = editor->LayoutDocument();
+		hits = editor->CacheStatistic(SC_POSITIONCACHE_HITS) - hitsStart;
+		misses = editor->CacheStatistic(SC_POSITIONCACHE_MISSES) - missesStart;
+		return width;
+	});
+	runner.Note("Editor.Layout", "positionCacheHitRate", HitRate(hits, misses));
+
+	FrameTimes times;
+	runner.Measure("Editor.Scroll", corpus.length(), editor->Send(SCI_GETLINECOUNT), [&]() {
+		return ScrollThrough(*editor, times);
+	});
+	NoteFrames(runner, "Editor.Scroll", times);
+
+	// Painting cost should follow the indicators on the visible lines rather than the number of indicators.
+	std::unique_ptr<HeadlessEditor> editorIndicators = CreateEditor(corpus, 1000, SC_WRAP_NONE);
+	AddIndicators(*editorIndicators, 32, runner.seed);
+	runner.Measure("Editor.ScrollIndicators", corpus.length(), editor->Send(SCI_GETLINECOUNT), [&]() {
+		return ScrollThrough(*editorIndicators, times);
+	});
+	NoteFrames(runner, "Editor.ScrollIndicators", times);
+
+	// Narrow enough that many lines wrap
+	std::unique_ptr<HeadlessEditor> editorWrapped = CreateEditor(corpus, 300, SC_WRAP_WORD);
+	Sci::Line displayLines = 0;
+
+	runner.Measure("Editor.Wrap", corpus.length(), editor->Send(SCI_GETLINECOUNT), [&]() {
+		editorWrapped->ClearCaches();
+		editorWrapped->Send(SCI_SETLAYOUTTHREADS, 1);
+		editorWrapped->WrapDocument();
+		displayLines = editorWrapped->DisplayLines();
+		return static_cast<size_t>(displayLines);
+	});
+	runner.Note("Editor.Wrap", "displayLines", static_cast<double>(displayLines));
+
+	// The check matches Editor.Wrap as the lines must be wrapped the same on each thread.
+	runner.Measure("Editor.WrapThreads", corpus.length(), editor->Send(SCI_GETLINECOUNT), [&]() {
+		editorWrapped->ClearCaches();
+		editorWrapped->Send(SCI_SETLAYOUTTHREADS, std::max(std::thread::hardware_concurrency(), 2U));
+		editorWrapped->WrapDocument();
+		return static_cast<size_t>(editorWrapped->DisplayLines());
+	});
+
+	runner.Measure("Editor.ScrollWrapped", corpus.length(), editor->Send(SCI_GETLINECOUNT), [&]() {
+		return ScrollThrough(*editorWrapped, times);
+	});
+	NoteFrames(runner, "Editor.ScrollWrapped", times);
+}
+
+}
@@ -0,0 +1,269 @@
+// Benchmarks for Scintilla internal data structures
+/** @file benchLexlib.cxx
+ ** Benchmarks for WordList, CharacterCategory and LexAccessor used by lexers.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <forward_list>
+#include <chrono>
+#include <random>
+
+#include "Platform.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include "WordList.h"
+#include "LexAccessor.h"
+#include "CharacterCategory.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "PerLine.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "UniConversion.h"
+#include "ElapsedPeriod.h"
+
+#include "Harness.h"
+
+using namespace Scintilla;
+
+namespace Bench {
+
+namespace {
+
+const char cppKeywords[] =
+	"alignas alignof and and_eq asm auto bitand bitor bool break case catch char char16_t char32_t "
+	"class compl const constexpr const_cast continue decltype default delete do double dynamic_cast "
+	"else enum explicit export extern false float for friend goto if inline int long mutable namespace "
+	"new noexcept not not_eq nullptr operator or or_eq private protected public register "
+	"reinterpret_cast return short signed sizeof static static_assert static_cast struct switch "
+	"template this thread_local throw true try typedef typeid typename union unsigned using virtual "
+	"void volatile wchar_t while xor xor_eq";
+
+bool IsIdentifierByte(char ch) noexcept {
+	return ((ch >= 'a') && (ch <= 'z')) || ((ch >= 'A') && (ch <= 'Z')) ||
+		((ch >= '0') && (ch <= '9')) || (ch == '_');
+}
+
+std::vector<std::string> Identifiers(const std::string &text) {
+	std::vector<std::string> identifiers;
+	size_t start = 0;
+	while (start < text.length()) {
+		if (IsIdentifierByte(text[start])) {
+			size_t end = start + 1;
+			while ((end < text.length()) && IsIdentifierByte(text[end]))
+				end++;
+			identifiers.push_back(text.substr(start, end - start));
+			start = end;
+		} else {
+			start++;
+		}
+	}
+	return identifiers;
+}
+
+// Read every character and style each run of identifier and other bytes as lexers do.
+size_t LexForward(Document &doc) {
+	LexAccessor styler(&doc);
+	const Sci_Position length = styler.Length();
+	styler.StartAt(0);
+	styler.StartSegment(0);
+	size_t runs = 0;
+	for (Sci_Position position = 0; position < length; position++) {
+		const bool identifier = IsIdentifierByte(styler[position]);
+		if (identifier != IsIdentifierByte(styler.SafeGetCharAt(position + 1))) {
+			styler.ColourTo(position, identifier ? 1 : 0);
+			runs++;
+		}
+	}
+	styler.ColourTo(length - 1, 0);
+	styler.Flush();
+	return runs;
+}
+
+// Look back from each line start as lexers for embedded languages do to find the enclosing context.
+size_t LexLookBack(Document &doc) {
+	LexAccessor styler(&doc);
+	const Sci::Line lines = doc.LinesTotal();
+	size_t sum = 0;
+	for (Sci::Line line = 0; line < lines; line++) {
+		const Sci_Position position = doc.LineStart(line);
+		sum += static_cast<unsigned char>(styler.SafeGetCharAt(position - 6000));
+		sum += static_cast<unsigned char>(styler.SafeGetCharAt(position));
+	}
+	return sum;
+}
+
+std::vector<int> CodePoints(const std::string &text) {
+	std::vector<int> codePoints;
+	size_t position = 0;
+	while (position < text.length()) {
+		const int width = UTF8Classify(reinterpret_cast<const unsigned char *>(text.c_str() + position),
+			text.length() - position) & UTF8MaskWidth;
+		codePoints.push_back(UnicodeFromUTF8(reinterpret_cast<const unsigned char *>(text.c_str() + position)));
+		position += width;
+	}
+	return codePoints;
+}
+
+}
+
+void BenchLexlib(Runner &runner) {
+	const std::string corpus = Corpus(runner.size, runner.seed, true);
+
+	const std::vector<std::string> identifiers = Identifiers(corpus);
+	WordList keywords;
+	keywords.Set(cppKeywords);
+
+	runner.Measure("WordList.InList", corpus.length(), identifiers.size(), [&]() {
+		size_t found = 0;
+		for (const std::string &identifier : identifiers) {
+			if (keywords.InList(identifier.c_str()))
+				found++;
+		}
+		return found;
+	});
+
+	// Lists like those for SQL and Verilog with thousands of words spread over the
+	// identifiers in the text
+	std::vector<std::string> distinct = identifiers;
+	std::sort(distinct.begin(), distinct.end());
+	distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+	const size_t stride = std::max<size_t>(distinct.size() / 4000, 2);
+	std::string largeList;
+	for (size_t i = 0; i < distinct.size(); i += stride) {
+		largeList += distinct[i];
+		largeList += " ";
+	}
+	WordList largeKeywords;
+	largeKeywords.Set(largeList.c_str());
+
+	runner.Measure("WordList.InListLarge", corpus.length(), identifiers.size(), [&]() {
+		size_t found = 0;
+		for (const std::string &identifier : identifiers) {
+			if (largeKeywords.InList(identifier.c_str()))
+				found++;
+		}
+		return found;
+	});
+
+	runner.Measure("WordList.Set", largeList.length() * 100, 100, [&]() {
+		size_t words = 0;
+		for (int i = 0; i < 100; i++) {
+			WordList reloaded;
+			reloaded.Set(largeList.c_str());
+			words += reloaded.Length();
+		}
+		return words;
+	});
+
+	Document doc(SC_DOCUMENTOPTION_DEFAULT);
+	doc.SetUndoCollection(false);
+	doc.InsertString(0, corpus.c_str(), corpus.length());
+
+	runner.Measure("LexAccessor.Forward", corpus.length(), 1, [&]() {
+		return LexForward(doc);
+	});
+
+	runner.Measure("LexAccessor.LookBack", corpus.length(), doc.LinesTotal(), [&]() {
+		return LexLookBack(doc);
+	});
+
+	runner.Measure("UniConversion.UTF8IsValid", corpus.length(), 1, [&]() {
+		return UTF8IsValid(corpus) ? 1U : 0U;
+	});
+
+	runner.Measure("UniConversion.UTF16Length", corpus.length(), 1, [&]() {
+		return UTF16Length(corpus);
+	});
+
+	runner.Measure("UniConversion.UTF8CountCharacters", corpus.length(), 1, [&]() {
+		return UTF8CountCharacters(corpus, true);
+	});
+
+	// Text code points are mostly ASCII so also measure a uniform spread over all of Unicode
+	const std::vector<int> codePoints = CodePoints(corpus);
+	std::vector<int> spread(codePoints.size());
+	Random random(runner.seed);
+	for (int &ch : spread) {
+		ch = static_cast<int>(random.Below(0x110000));
+	}
+
+	// CJK, Hangul, and emoji text that is not covered by the CharacterCategoryMap prefix
+	const int nonLatinRanges[][2] = {
+		{ 0x3040, 0x30FF }, { 0x4E00, 0x9FFF }, { 0xAC00, 0xD7A3 }, { 0x1F300, 0x1FAFF },
+	};
+	std::vector<int> nonLatin(codePoints.size());
+	for (int &ch : nonLatin) {
+		const int *range = nonLatinRanges[random.Below(std::size(nonLatinRanges))];
+		ch = range[0] + static_cast<int>(random.Below(range[1] - range[0] + 1));
+	}
+
+	runner.Measure("CharacterCategory.Text", corpus.length(), codePoints.size(), [&]() {
+		size_t letters = 0;
+		for (const int ch : codePoints) {
+			if (CategoriseCharacter(ch) <= ccLo)
+				letters++;
+		}
+		return letters;
+	});
+
+	runner.Measure("CharacterCategory.Spread", spread.size() * 4, spread.size(), [&]() {
+		size_t letters = 0;
+		for (const int ch : spread) {
+			if (CategoriseCharacter(ch) <= ccLo)
+				letters++;
+		}
+		return letters;
+	});
+
+	runner.Measure("CharacterCategory.NonLatin", nonLatin.size() * 4, nonLatin.size(), [&]() {
+		size_t letters = 0;
+		for (const int ch : nonLatin) {
+			if (CategoriseCharacter(ch) <= ccLo)
+				letters++;
+		}
+		return letters;
+	});
+
+	runner.Measure("CharacterCategory.IsXidContinue", nonLatin.size() * 4, nonLatin.size(), [&]() {
+		size_t identifiers = 0;
+		for (const int ch : nonLatin) {
+			if (IsXidContinue(ch))
+				identifiers++;
+		}
+		return identifiers;
+	});
+
+	runner.Measure("CharacterCategoryMap.Spread", spread.size() * 4, spread.size(), [&]() {
+		CharacterCategoryMap categoryMap;
+		size_t letters = 0;
+		for (const int ch : spread) {
+			if (categoryMap.CategoryFor(ch) <= ccLo)
+				letters++;
+		}
+		return letters;
+	});
+}
+
+}
@@ -0,0 +1,115 @@
+// Benchmarks for Scintilla internal data structures
+/** @file benchSearch.cxx
+ ** Benchmarks for Document::FindText with each search mode and regular expression engine.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <forward_list>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <random>
+
+#include "Platform.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include "CharacterCategory.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "PerLine.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "ElapsedPeriod.h"
+
+#include "Harness.h"
+
+using namespace Scintilla;
+
+namespace Bench {
+
+namespace {
+
+struct SearchCase {
+	const char *name;
+	const char *pattern;
+	int flags;
+};
+
+// Patterns are chosen to match many times in the corpus so each search restarts frequently
+const SearchCase searchCases[] = {
+	{ "FindText.MatchCase", "FindText", SCFIND_MATCHCASE },
+	{ "FindText.CaseInsensitive", "findtext", 0 },
+	{ "FindText.CaseInsensitiveUnicode", "\xce\xb5\xce\xbb\xce\xbb\xce\xb7\xce\xbd", 0 },
+	{ "FindText.WholeWord", "position", SCFIND_MATCHCASE | SCFIND_WHOLEWORD },
+	{ "FindText.WordStart", "line", SCFIND_MATCHCASE | SCFIND_WORDSTART },
+	{ "FindText.RESearch", "[a-z]+_9[0-9]", SCFIND_MATCHCASE | SCFIND_REGEXP },
+	{ "FindText.RESearchCaseInsensitive", "start[a-z]*_1", SCFIND_REGEXP },
+	{ "FindText.Cxx11Regex", "[a-z]+_9[0-9]", SCFIND_MATCHCASE | SCFIND_REGEXP | SCFIND_CXX11REGEX },
+	{ "FindText.Cxx11RegexCaseInsensitive", "start[a-z]*_1", SCFIND_REGEXP | SCFIND_CXX11REGEX },
+};
+
+std::unique_ptr<Document> LoadedDocument(const std::string &text) {
+	std::unique_ptr<Document> doc = std::make_unique<Document>(SC_DOCUMENTOPTION_DEFAULT);
+	doc->SetDBCSCodePage(SC_CP_UTF8);
+	doc->SetCaseFolder(new CaseFolderUnicode());
+	doc->SetUndoCollection(false);
+	doc->InsertString(0, text.c_str(), text.length());
+	return doc;
+}
+
+// Find each match in turn, forwards or backwards, as is done by replace all or highlighting.
+size_t FindAll(Document &doc, const char *pattern, int flags, bool forward) {
+	const Sci::Position length = doc.Length();
+	const Sci::Position lengthPattern = strlen(pattern);
+	size_t matches = 0;
+	Sci::Position position = forward ? 0 : length;
+	while (forward ? (position < length) : (position > 0)) {
+		Sci::Position lengthFound = lengthPattern;
+		const Sci::Position found = doc.FindText(position, forward ? length : 0, pattern, flags, &lengthFound);
+		if (found < 0)
+			break;
+		matches++;
+		position = forward ? found + std::max<Sci::Position>(lengthFound, 1) : found;
+	}
+	return matches;
+}
+
+}
+
+void BenchSearch(Runner &runner) {
+	const std::string corpus = Corpus(runner.size, runner.seed, true);
+	const std::unique_ptr<Document> doc = LoadedDocument(corpus);
+
+	for (const SearchCase &searchCase : searchCases) {
+		runner.Measure(searchCase.name, corpus.length(), 1, [&]() {
+			return FindAll(*doc, searchCase.pattern, searchCase.flags, true);
+		});
+	}
+
+	runner.Measure("FindText.MatchCaseBackward", corpus.length(), 1, [&]() {
+		return FindAll(*doc, "FindText", SCFIND_MATCHCASE, false);
+	});
+
+	runner.Measure("FindText.CaseInsensitiveBackward", corpus.length(), 1, [&]() {
+		return FindAll(*doc, "findtext", 0, false);
+	});
+}
+
+}
@@ -0,0 +1,198 @@
+// Benchmarks for Scintilla internal data structures
+/** @file benchStructures.cxx
+ ** Benchmarks for SplitVector, Partitioning, and RunStyles.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <random>
+
+#include "Platform.h"
+
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "ElapsedPeriod.h"
+
+#include "Harness.h"
+
+using namespace Scintilla;
+
+namespace Bench {
+
+namespace {
+
+// Edits at random positions move the gap so are limited to keep large sizes practical
+constexpr size_t scatteredEdits = 10000;
+
+std::unique_ptr<SplitVector<char>> FilledSplitVector(const std::string &text) {
+	std::unique_ptr<SplitVector<char>> sv = std::make_unique<SplitVector<char>>();
+	sv->InsertFromArray(0, text.c_str(), 0, text.length());
+	return sv;
+}
+
+}
+
+void BenchStructures(Runner &runner) {
+	const size_t size = runner.size;
+	const std::string corpus = Corpus(size, runner.seed, false);
+	const ptrdiff_t length = corpus.length();
+
+	runner.Measure("SplitVector.Append", length, length / 100 + 1, [&]() {
+		SplitVector<char> sv;
+		for (ptrdiff_t position = 0; position < length; position += 100) {
+			const ptrdiff_t lengthPiece = std::min<ptrdiff_t>(100, length - position);
+			sv.InsertFromArray(sv.Length(), corpus.c_str(), position, lengthPiece);
+		}
+		return static_cast<size_t>(sv.Length());
+	});
+
+	runner.MeasureWithSetup("SplitVector.Typing", length, 100000,
+		[&]() { return FilledSplitVector(corpus); },
+		[&](SplitVector<char> &sv) {
+		// Insert characters at a moving position as if typing in the middle of the text
+		ptrdiff_t position = length / 2;
+		for (int i = 0; i < 100000; i++) {
+			sv.Insert(position, static_cast<char>('a' + i % 26));
+			position++;
+			if ((i % 80) == 79) {
+				position = (position + 997) % sv.Length();
+			}
+		}
+		return static_cast<size_t>(sv.Length());
+	});
+
+	runner.MeasureWithSetup("SplitVector.InsertScattered", length, scatteredEdits,
+		[&]() { return FilledSplitVector(corpus); },
+		[&](SplitVector<char> &sv) {
+		Random random(runner.seed);
+		for (size_t i = 0; i < scatteredEdits; i++) {
+			sv.InsertFromArray(random.Below(sv.Length() + 1), "inserted", 0, 8);
+		}
+		return static_cast<size_t>(sv.Length());
+	});
+
+	runner.MeasureWithSetup("SplitVector.ValueAt", length, length,
+		[&]() { return FilledSplitVector(corpus); },
+		[&](SplitVector<char> &sv) {
+		size_t sum = 0;
+		for (ptrdiff_t position = 0; position < length; position++) {
+			sum += sv.ValueAt(position);
+		}
+		return sum;
+	});
+
+	// Partitioning as used for line starts
+	std::vector<ptrdiff_t> lineEnds;
+	for (ptrdiff_t position = 0; position < length; position++) {
+		if (corpus[position] == '\n')
+			lineEnds.push_back(position + 1);
+	}
+	const ptrdiff_t lines = lineEnds.size();
+	auto filledPartitioning = [&]() {
+		std::unique_ptr<Partitioning<ptrdiff_t>> partitioning = std::make_unique<Partitioning<ptrdiff_t>>(8);
+		partitioning->InsertText(0, length);
+		for (ptrdiff_t line = 0; line < lines; line++) {
+			partitioning->InsertPartition(line + 1, lineEnds[line]);
+		}
+		return partitioning;
+	};
+
+	runner.Measure("Partitioning.InsertPartition", length, lines, [&]() {
+		return static_cast<size_t>(filledPartitioning()->Partitions());
+	});
+
+	runner.MeasureWithSetup("Partitioning.PartitionFromPosition", length, 1000000,
+		filledPartitioning,
+		[&](Partitioning<ptrdiff_t> &partitioning) {
+		Random random(runner.seed);
+		size_t sum = 0;
+		for (int i = 0; i < 1000000; i++) {
+			sum += partitioning.PartitionFromPosition(random.Below(length));
+		}
+		return sum;
+	});
+
+	runner.MeasureWithSetup("Partitioning.InsertTextScattered", length, scatteredEdits,
+		filledPartitioning,
+		[&](Partitioning<ptrdiff_t> &partitioning) {
+		// Each insertion away from the previous one moves the step
+		Random random(runner.seed);
+		for (size_t i = 0; i < scatteredEdits; i++) {
+			partitioning.InsertText(random.Below(partitioning.Partitions()), 1);
+		}
+		return static_cast<size_t>(partitioning.PositionFromPartition(partitioning.Partitions()));
+	});
+
+	// RunStyles as used for styles of indicators
+	const size_t fills = length / 20 + 1;
+	auto emptyRunStyles = [&]() {
+		std::unique_ptr<RunStyles<ptrdiff_t, int>> rs = std::make_unique<RunStyles<ptrdiff_t, int>>();
+		rs->InsertSpace(0, length);
+		return rs;
+	};
+	auto filledRunStyles = [&]() {
+		std::unique_ptr<RunStyles<ptrdiff_t, int>> rs = emptyRunStyles();
+		for (ptrdiff_t position = 0; position < length; position += 20) {
+			rs->FillRange(position, 1 + (position / 20) % 7, 10);
+		}
+		return rs;
+	};
+
+	runner.MeasureWithSetup("RunStyles.FillRangeSequential", length, fills,
+		emptyRunStyles,
+		[&](RunStyles<ptrdiff_t, int> &rs) {
+		for (ptrdiff_t position = 0; position < length; position += 20) {
+			rs.FillRange(position, 1 + (position / 20) % 7, 10);
+		}
+		return static_cast<size_t>(rs.Runs());
+	});
+
+	runner.MeasureWithSetup("RunStyles.FillRangeScattered", length, scatteredEdits,
+		filledRunStyles,
+		[&](RunStyles<ptrdiff_t, int> &rs) {
+		Random random(runner.seed);
+		for (size_t i = 0; i < scatteredEdits; i++) {
+			const ptrdiff_t position = random.Below(length);
+			rs.FillRange(position, static_cast<int>(random.Below(8)), std::min<ptrdiff_t>(50, length - position));
+		}
+		return static_cast<size_t>(rs.Runs());
+	});
+
+	runner.MeasureWithSetup("RunStyles.FindNextChange", length, fills * 2,
+		filledRunStyles,
+		[&](RunStyles<ptrdiff_t, int> &rs) {
+		size_t changes = 0;
+		ptrdiff_t position = 0;
+		while (position < length) {
+			position = rs.FindNextChange(position, length);
+			changes++;
+		}
+		return changes;
+	});
+
+	runner.MeasureWithSetup("RunStyles.ValueAt", length, 1000000,
+		filledRunStyles,
+		[&](RunStyles<ptrdiff_t, int> &rs) {
+		Random random(runner.seed);
+		size_t sum = 0;
+		for (int i = 0; i < 1000000; i++) {
+			sum += rs.ValueAt(random.Below(length));
+		}
+		return sum;
+	});
+}
+
+}
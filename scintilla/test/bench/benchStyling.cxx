@@ -0,0 +1,103 @@
+// Benchmarks for Scintilla internal data structures
+/** @file benchStyling.cxx
+ ** Benchmarks for styling a whole document with a lexer on one or several threads.
+ **/
+// Copyright 2019 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <forward_list>
+#include <thread>
+#include <chrono>
+#include <random>
+
+#include "Platform.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include "LexerModule.h"
+#include "CharacterCategory.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "PerLine.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "ElapsedPeriod.h"
+
+#include "Harness.h"
+
+extern Scintilla::LexerModule lmCPP;
+
+using namespace Scintilla;
+
+namespace Bench {
+
+namespace {
+
+// Owns a lexer created from a module as the platform layer would.
+class BenchLexInterface : public LexInterface {
+public:
+	BenchLexInterface(Document *pdoc_, ILexer4 *instance_) : LexInterface(pdoc_) {
+		instance = instance_;
+	}
+	~BenchLexInterface() override {
+		instance->Release();
+	}
+};
+
+// Restyle the whole document from the start and return a sum of the styles and levels.
+size_t Restyle(Document &doc) {
+	doc.ModifiedAt(0);
+	doc.EnsureStyledTo(doc.Length());
+	size_t sum = 0;
+	const Sci::Line lines = doc.LinesTotal();
+	for (Sci::Line line = 0; line < lines; line++) {
+		sum += doc.StyleAt(doc.LineStart(line));
+		sum += doc.GetLevel(line) & SC_FOLDLEVELNUMBERMASK;
+	}
+	return sum;
+}
+
+}
+
+void BenchStyling(Runner &runner) {
+	const std::string corpus = Corpus(runner.size, runner.seed, true);
+
+	Document doc(SC_DOCUMENTOPTION_DEFAULT);
+	doc.SetUndoCollection(false);
+	doc.InsertString(0, corpus.c_str(), corpus.length());
+	ILexer4 *lexer = lmCPP.Create();
+	lexer->PropertySet("fold", "1");
+	lexer->WordListSet(0, "break case char const else for if int return static struct void while");
+	doc.SetLexInterface(new BenchLexInterface(&doc, lexer));
+
+	runner.Measure("Styling.CPP", corpus.length(), 1, [&]() {
+		doc.stylingThreads = 1;
+		return Restyle(doc);
+	});
+
+	// The check matches Styling.CPP as the results must be the same as for one thread.
+	runner.Measure("Styling.CPPThreads", corpus.length(), 1, [&]() {
+		doc.stylingThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 2);
+		return Restyle(doc);
+	});
+}
+
+}
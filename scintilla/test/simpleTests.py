@@ -4,7 +4,7 @@
 from __future__ import with_statement
 from __future__ import unicode_literals
 
-import codecs, ctypes, os, sys, unittest
+import codecs, ctypes, os, sys, time, unittest
 
 if sys.platform == "win32":
 	import XiteWin as Xite
@@ -597,6 +597,86 @@ class TestSimple(unittest.TestCase):
 		self.ed.ReplaceTargetRE(len(rep), rep)
 		self.assertEquals(self.ed.Contents(), b"a\\nd")
 
+	def testReplaceAllInTarget(self):
+		self.ed.SetContents(b"a cat, a cat and a dog")
+		self.ed.TargetWholeDocument()
+		self.ed.SearchFlags = 0
+		self.assertEquals(self.ed.ReplaceAllInTarget(b"cat", b"horse"), 2)
+		self.assertEquals(self.ed.Contents(), b"a horse, a horse and a dog")
+		# Target is set to the last replacement
+		self.assertEquals(self.ed.TargetStart, 11)
+		self.assertEquals(self.ed.TargetEnd, 16)
+		self.ed.TargetWholeDocument()
+		self.assertEquals(self.ed.ReplaceAllInTarget(b"cow", b"horse"), 0)
+		self.assertEquals(self.ed.Contents(), b"a horse, a horse and a dog")
+		# Only matches within the target are replaced
+		self.ed.SetContents(b"aaaa")
+		self.ed.TargetStart = 1
+		self.ed.TargetEnd = 3
+		self.assertEquals(self.ed.ReplaceAllInTarget(b"a", b"b"), 2)
+		self.assertEquals(self.ed.Contents(), b"abba")
+
+	def testReplaceAllInTargetRE(self):
+		self.ed.SetContents(b"x=1; y=22;")
+		self.ed.TargetWholeDocument()
+		self.ed.SearchFlags = self.ed.SCFIND_REGEXP
+		self.assertEquals(self.ed.ReplaceAllInTarget(b"\\([a-z]\\)=\\([0-9]+\\)", b"\\2=\\1"), 2)
+		self.assertEquals(self.ed.Contents(), b"1=x; 22=y;")
+		self.assertEquals(self.ed.TargetStart, 5)
+		self.assertEquals(self.ed.TargetEnd, 9)
+
+	def testReplaceAllInTargetEmptyMatches(self):
+		self.ed.SetContents(b"a\nb\nc")
+		self.ed.TargetWholeDocument()
+		self.ed.SearchFlags = self.ed.SCFIND_REGEXP
+		self.assertEquals(self.ed.ReplaceAllInTarget(b"^", b"> "), 3)
+		self.assertEquals(self.ed.Contents(), b"> a\n> b\n> c")
+
+	def testReplaceAllInTargetAtEnd(self):
+		self.ed.SetContents(b"one two one")
+		self.ed.SearchFlags = 0
+		self.ed.TargetStart = 8
+		self.ed.TargetEnd = 11
+		self.assertEquals(self.ed.ReplaceAllInTarget(b"one", b"1"), 1)
+		self.assertEquals(self.ed.Contents(), b"one two 1")
+		self.assertEquals(self.ed.TargetStart, 8)
+		self.assertEquals(self.ed.TargetEnd, 9)
+		# An empty target at the end finds nothing
+		self.ed.TargetStart = 9
+		self.ed.TargetEnd = 9
+		self.assertEquals(self.ed.ReplaceAllInTarget(b"1", b"one"), 0)
+		self.assertEquals(self.ed.Contents(), b"one two 1")
+
+	def testReplaceAllInTargetNotifications(self):
+		# Each replacement is notified separately with its text
+		self.ed.SetContents(b"a cat\nthe cat")
+		self.ed.TargetWholeDocument()
+		self.ed.SearchFlags = 0
+		self.xite.modifications = []
+		self.assertEquals(self.ed.ReplaceAllInTarget(b"cat", b"dog\n"), 2)
+		modifications = self.xite.modifications
+		self.xite.modifications = None
+		self.assertEquals(self.ed.Contents(), b"a dog\n\nthe dog\n")
+		changes = [(modificationType & self.ed.SC_MOD_INSERTTEXT != 0, position, length, text)
+			for (modificationType, position, length, text) in modifications
+			if modificationType & (self.ed.SC_MOD_INSERTTEXT | self.ed.SC_MOD_DELETETEXT)]
+		self.assertEquals(changes, [(False, 2, 3, b"cat"), (True, 2, 4, b"dog\n"),
+			(False, 11, 3, b"cat"), (True, 11, 4, b"dog\n")])
+
+	def testReplaceAllInTargetUndo(self):
+		self.ed.SetContents(b"ab ab ab")
+		self.ed.EmptyUndoBuffer()
+		self.ed.TargetWholeDocument()
+		self.ed.SearchFlags = 0
+		self.assertEquals(self.ed.ReplaceAllInTarget(b"ab", b"xyz"), 3)
+		self.assertEquals(self.ed.Contents(), b"xyz xyz xyz")
+		self.assertEquals(self.ed.CanUndo(), 1)
+		self.ed.Undo()
+		self.assertEquals(self.ed.Contents(), b"ab ab ab")
+		self.assertEquals(self.ed.CanUndo(), 0)
+		self.ed.Redo()
+		self.assertEquals(self.ed.Contents(), b"xyz xyz xyz")
+
 	def testPointsAndPositions(self):
 		self.ed.AddText(1, b"x")
 		# Start of text
@@ -1017,6 +1097,106 @@ class TestIndicators(unittest.TestCase):
 		self.assertEquals(self.ed.IndicatorStart(3, 1), 0)
 		self.assertEquals(self.ed.IndicatorEnd(3, 1), 0)
 
+class TestHighlightMatches(unittest.TestCase):
+
+	def setUp(self):
+		self.xite = Xite.xiteFrame
+		self.ed = self.xite.ed
+		self.ed.ClearAll()
+		self.ed.EmptyUndoBuffer()
+		self.ed.SearchFlags = 0
+		self.indicator = 10
+
+	def tearDown(self):
+		self.ed.HighlightMatchesClear(self.indicator)
+		self.ed.HighlightMatchesStyle = -1
+
+	def Ranges(self):
+		# Return the (start, end) ranges where the indicator is set
+		ranges = []
+		pos = 0
+		while pos < self.ed.Length:
+			end = self.ed.IndicatorEnd(self.indicator, pos)
+			if end <= pos:
+				break
+			if self.ed.IndicatorValueAt(self.indicator, pos):
+				ranges.append((pos, end))
+			pos = end
+		return ranges
+
+	def WaitForHighlights(self):
+		# Changed lines are searched again in idle time
+		for i in range(100):
+			if self.ed.HighlightMatchesComplete:
+				break
+			self.xite.DoEvents()
+			time.sleep(0.01)
+		self.assertEquals(self.ed.HighlightMatchesComplete, 1)
+
+	def testHighlight(self):
+		self.ed.SetContents(b"one two one\nthree one\n")
+		self.assertEquals(self.ed.HighlightMatchesComplete, 1)
+		self.ed.HighlightMatches(self.indicator, b"one")
+		self.WaitForHighlights()
+		self.assertEquals(self.Ranges(), [(0, 3), (8, 11), (18, 21)])
+
+	def testEditInsideMatch(self):
+		self.ed.SetContents(b"one two one\nthree one\n")
+		self.ed.HighlightMatches(self.indicator, b"one")
+		self.WaitForHighlights()
+		self.ed.InsertText(9, b"X")
+		self.assertEquals(self.ed.Contents(), b"one two oXne\nthree one\n")
+		self.assertEquals(self.ed.HighlightMatchesComplete, 0)
+		self.WaitForHighlights()
+		self.assertEquals(self.Ranges(), [(0, 3), (19, 22)])
+		self.ed.DeleteRange(9, 1)
+		self.WaitForHighlights()
+		self.assertEquals(self.Ranges(), [(0, 3), (8, 11), (18, 21)])
+
+	def testEditOutsideMatch(self):
+		self.ed.SetContents(b"one two one\nthree one\n")
+		self.ed.HighlightMatches(self.indicator, b"one")
+		self.WaitForHighlights()
+		self.ed.DeleteRange(3, 4)
+		self.assertEquals(self.ed.Contents(), b"one one\nthree one\n")
+		self.WaitForHighlights()
+		self.assertEquals(self.Ranges(), [(0, 3), (4, 7), (14, 17)])
+		self.ed.InsertText(0, b"two ")
+		self.WaitForHighlights()
+		self.assertEquals(self.Ranges(), [(4, 7), (8, 11), (18, 21)])
+
+	def testClear(self):
+		self.ed.SetContents(b"one two one")
+		self.ed.HighlightMatches(self.indicator, b"one")
+		self.WaitForHighlights()
+		self.assertEquals(self.Ranges(), [(0, 3), (8, 11)])
+		self.ed.HighlightMatchesClear(self.indicator)
+		self.assertEquals(self.Ranges(), [])
+		self.assertEquals(self.ed.HighlightMatchesComplete, 1)
+		# Edits after clearing do not highlight
+		self.ed.InsertText(0, b"one ")
+		self.WaitForHighlights()
+		self.assertEquals(self.Ranges(), [])
+		# An empty string also clears
+		self.ed.HighlightMatches(self.indicator, b"one")
+		self.WaitForHighlights()
+		self.assertEquals(self.Ranges(), [(0, 3), (4, 7), (12, 15)])
+		self.ed.HighlightMatches(self.indicator, b"")
+		self.assertEquals(self.Ranges(), [])
+
+	def testStyle(self):
+		self.assertEquals(self.ed.HighlightMatchesStyle, -1)
+		self.ed.HighlightMatchesStyle = 5
+		self.assertEquals(self.ed.HighlightMatchesStyle, 5)
+		# Container styling so the styles set here remain
+		self.ed.Lexer = self.ed.SCLEX_CONTAINER
+		self.ed.SetContents(b"one one")
+		self.ed.StartStyling(4, 0)
+		self.ed.SetStyling(3, 5)
+		self.ed.HighlightMatches(self.indicator, b"one")
+		self.WaitForHighlights()
+		self.assertEquals(self.Ranges(), [(4, 7)])
+
 class TestScrolling(unittest.TestCase):
 
 	def setUp(self):
@@ -1469,6 +1649,106 @@ class TestMultiSelection(unittest.TestCase):
 		self.ed.DropSelectionN(0)
 		self.assertEquals(self.ed.MainSelection, 2)
 
+	def Changes(self, action):
+		# Perform action and return each insertion and deletion notified as (inserted, position, text)
+		self.xite.modifications = []
+		action()
+		modifications = self.xite.modifications
+		self.xite.modifications = None
+		changes = []
+		for (modificationType, position, length, text) in modifications:
+			if modificationType & (self.ed.SC_MOD_INSERTTEXT | self.ed.SC_MOD_DELETETEXT):
+				self.assertEquals(len(text), length)
+				changes.append((modificationType & self.ed.SC_MOD_INSERTTEXT != 0, position, text))
+		return changes
+
+	def testClearMultipleSelections(self):
+		# Each selection is deleted with its own notification and all are undone in one step
+		self.ed.AdditionalSelectionTyping = 1
+		self.ed.SetSelection(1, 2)
+		self.ed.AddSelection(5, 7)
+		self.ed.AddSelection(10, 9)
+		changes = self.Changes(self.ed.Clear)
+		self.assertEquals(self.ed.Contents(), b"xx\nx\nxx")
+		self.assertEquals(changes, [(False, 1, b"x"), (False, 4, b"xx"), (False, 6, b"x")])
+		self.assertEquals(self.ed.Selections, 3)
+		self.assertEquals(self.ed.GetSelectionNCaret(0), 1)
+		self.assertEquals(self.ed.GetSelectionNCaret(1), 4)
+		self.assertEquals(self.ed.GetSelectionNCaret(2), 6)
+		self.assertEquals(self.ed.GetSelectionNAnchor(2), 6)
+		self.ed.Undo()
+		self.assertEquals(self.ed.Contents(), b"xxx\nxxx\nxxx")
+		self.ed.AdditionalSelectionTyping = 0
+
+	def testTypeMultipleSelections(self):
+		self.ed.AdditionalSelectionTyping = 1
+		self.ed.SetSelection(1, 1)
+		self.ed.AddSelection(6, 5)
+		self.ed.AddSelection(9, 9)
+		changes = self.Changes(lambda: self.xite.Type("a"))
+		self.assertEquals(self.ed.Contents(), b"xaxx\nxax\nxaxx")
+		self.assertEquals(changes, [(True, 1, b"a"), (False, 6, b"x"), (True, 6, b"a"), (True, 10, b"a")])
+		self.assertEquals(self.ed.Selections, 3)
+		self.assertEquals(self.ed.GetSelectionNCaret(0), 2)
+		self.assertEquals(self.ed.GetSelectionNCaret(1), 7)
+		self.assertEquals(self.ed.GetSelectionNAnchor(1), 7)
+		self.assertEquals(self.ed.GetSelectionNCaret(2), 11)
+		self.ed.Undo()
+		self.assertEquals(self.ed.Contents(), b"xxx\nxxx\nxxx")
+		self.ed.AdditionalSelectionTyping = 0
+
+	def testOvertypeMultipleSelections(self):
+		# Overtyping at the end of the document inserts
+		self.ed.AdditionalSelectionTyping = 1
+		self.ed.Overtype = 1
+		self.ed.SetSelection(1, 1)
+		self.ed.AddSelection(5, 5)
+		self.ed.AddSelection(11, 11)
+		changes = self.Changes(lambda: self.xite.Type("a"))
+		self.assertEquals(self.ed.Contents(), b"xax\nxax\nxxxa")
+		self.assertEquals(changes, [(False, 1, b"x"), (True, 1, b"a"), (False, 5, b"x"), (True, 5, b"a"),
+			(True, 11, b"a")])
+		self.assertEquals(self.ed.GetSelectionNCaret(0), 2)
+		self.assertEquals(self.ed.GetSelectionNCaret(1), 6)
+		self.assertEquals(self.ed.GetSelectionNCaret(2), 12)
+		self.ed.Overtype = 0
+		self.ed.AdditionalSelectionTyping = 0
+
+	def testTypeMultipleSelectionsVirtualSpace(self):
+		# Virtual space is realized as its own insertion before the typed text
+		self.ed.AdditionalSelectionTyping = 1
+		self.ed.SetSelection(3, 3)
+		self.ed.SetSelectionNCaretVirtualSpace(0, 2)
+		self.ed.SetSelectionNAnchorVirtualSpace(0, 2)
+		self.ed.AddSelection(7, 7)
+		self.ed.SetSelectionNCaretVirtualSpace(1, 1)
+		self.ed.SetSelectionNAnchorVirtualSpace(1, 1)
+		changes = self.Changes(lambda: self.xite.Type("a"))
+		self.assertEquals(self.ed.Contents(), b"xxx  a\nxxx a\nxxx")
+		self.assertEquals(changes, [(True, 3, b"  "), (True, 5, b"a"), (True, 10, b" "), (True, 11, b"a")])
+		self.assertEquals(self.ed.GetSelectionNCaret(0), 6)
+		self.assertEquals(self.ed.GetSelectionNCaretVirtualSpace(0), 0)
+		self.assertEquals(self.ed.GetSelectionNCaret(1), 12)
+		self.assertEquals(self.ed.GetSelectionNCaretVirtualSpace(1), 0)
+		self.ed.AdditionalSelectionTyping = 0
+
+	def testPasteMultipleSelections(self):
+		self.ed.MultiPaste = self.ed.SC_MULTIPASTE_EACH
+		self.ed.CopyText(2, b"ab")
+		self.ed.SetSelection(1, 1)
+		self.ed.AddSelection(6, 5)
+		self.ed.AddSelection(9, 9)
+		changes = self.Changes(self.ed.Paste)
+		self.assertEquals(self.ed.Contents(), b"xabxx\nxabx\nxabxx")
+		# Selected text is cleared before pasting at each selection
+		self.assertEquals(changes, [(False, 5, b"x"), (True, 1, b"ab"), (True, 7, b"ab"), (True, 12, b"ab")])
+		self.assertEquals(self.ed.GetSelectionNCaret(0), 3)
+		self.assertEquals(self.ed.GetSelectionNCaret(1), 9)
+		self.assertEquals(self.ed.GetSelectionNCaret(2), 14)
+		self.ed.Undo()
+		self.assertEquals(self.ed.Contents(), b"xxx\nxxx\nxxx")
+		self.ed.MultiPaste = self.ed.SC_MULTIPASTE_ONCE
+
 class TestModalSelection(unittest.TestCase):
 
 	def setUp(self):
@@ -1577,6 +1857,23 @@ class TestStyleAttributes(unittest.TestCase):
 		self.ed.StyleSetSizeFractional(self.ed.STYLE_DEFAULT, 1234)
 		self.assertEquals(self.ed.StyleGetSizeFractional(self.ed.STYLE_DEFAULT), 1234)
 
+	def testMeasureASCIIAsShaped(self):
+		# ASCII runs may be measured from glyph advances while runs with other
+		# characters are shaped so the two must agree up to the first other character.
+		# A monospaced font and text without kerning pairs ensure the ASCII line is
+		# measured from the advances where that is implemented, as on GTK.
+		self.ed.StyleSetFont(self.ed.STYLE_DEFAULT, b"Monospace")
+		self.ed.StyleClearAll()
+		self.ed.SetCodePage(65001)
+		self.ed.SetContents(b"mnopqrs uvwxyz")
+		ascii = [self.ed.PointXFromPosition(0, i) for i in range(15)]
+		self.ed.SetContents(b"mnopqrs uvwxyz\xc3\xa9")
+		shaped = [self.ed.PointXFromPosition(0, i) for i in range(15)]
+		self.assertEquals(ascii, shaped)
+		self.ed.SetCodePage(0)
+		self.ed.StyleResetDefault()
+		self.ed.StyleClearAll()
+
 	def testBold(self):
 		self.ed.StyleSetBold(self.ed.STYLE_DEFAULT, 1)
 		self.assertEquals(self.ed.StyleGetBold(self.ed.STYLE_DEFAULT), 1)
@@ -2155,6 +2452,23 @@ class TestAutoComplete(unittest.TestCase):
 
 		self.assertEquals(self.ed.AutoCActive(), 0)
 
+	def testAutoShowSubsequence(self):
+		self.assertEquals(self.ed.AutoCGetMatch(), self.ed.SC_AUTOCMATCH_PREFIX)
+		self.ed.AutoCSetMatch(self.ed.SC_AUTOCMATCH_SUBSEQUENCE)
+		self.assertEquals(self.ed.AutoCGetMatch(), self.ed.SC_AUTOCMATCH_SUBSEQUENCE)
+		self.ed.SetSel(0, 0)
+
+		self.ed.AutoCShow(0, b"getName getValue setValue")
+		self.ed.AutoCSelect(0, b"gv")
+		self.assertEquals(self.ed.AutoCGetCurrentText(0), b"getValue")
+		self.ed.AutoCSelect(0, b"sv")
+		self.assertEquals(self.ed.AutoCGetCurrentText(0), b"setValue")
+		self.ed.AutoCComplete()
+		self.assertEquals(self.ed.Contents(), b"setValuexxx\n")
+
+		self.assertEquals(self.ed.AutoCActive(), 0)
+		self.ed.AutoCSetMatch(self.ed.SC_AUTOCMATCH_PREFIX)
+
 	def testWriteOnly(self):
 		""" Checks that setting attributes doesn't crash or change tested behaviour
 		but does not check that the changed attributes are effective. """
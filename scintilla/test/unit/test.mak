@@ -12,11 +12,20 @@ CXXFLAGS = /EHsc /std:c++latest /D_HAS_AUTO_PTR_ETC=1 /wd 4805 $(INCLUDEDIRS)
 TESTSRC=test*.cxx
 # Files being tested from scintilla/src directory
 TESTEDSRC=\
+ ../../lexlib/CharacterCategory.cxx \
+ ../../lexlib/CharacterSet.cxx \
+ ../../lexlib/DefaultLexer.cxx \
  ../../lexlib/WordList.cxx \
+ ../../src/BackgroundStyler.cxx \
+ ../../src/CaseConvert.cxx \
+ ../../src/CaseFolder.cxx \
  ../../src/CellBuffer.cxx \
  ../../src/CharClassify.cxx \
  ../../src/ContractionState.cxx \
  ../../src/Decoration.cxx \
+ ../../src/Document.cxx \
+ ../../src/PerLine.cxx \
+ ../../src/RESearch.cxx \
  ../../src/RunStyles.cxx \
  ../../src/UniConversion.cxx \
  ../../src/UniqueString.cxx
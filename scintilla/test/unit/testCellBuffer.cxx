@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstring>
 #include <stdexcept>
+#include <string>
 #include <string_view>
 #include <vector>
 #include <algorithm>
@@ -14,6 +15,7 @@
 #include "Position.h"
 #include "SplitVector.h"
 #include "Partitioning.h"
+#include "ChunkVector.h"
 #include "RunStyles.h"
 #include "CellBuffer.h"
 
@@ -28,7 +30,7 @@ TEST_CASE("CellBuffer") {
 	const char sText[] = "Scintilla";
 	const Sci::Position sLength = static_cast<Sci::Position>(strlen(sText));
 
-	CellBuffer cb(true, false);
+	CellBuffer cb(true, false, false);
 
 	SECTION("InsertOneLine") {
 		bool startSequence = false;
@@ -147,9 +149,171 @@ TEST_CASE("CellBuffer") {
 
 }
 
+namespace {
+
+void InsertOperation(CellBuffer &cb, const std::string &text) {
+	bool startSequence = false;
+	cb.BeginUndoAction();
+	cb.InsertString(cb.Length(), text.c_str(), text.length(), startSequence);
+	cb.EndUndoAction();
+}
+
+int UndoAll(CellBuffer &cb) {
+	int operations = 0;
+	while (cb.CanUndo()) {
+		const int steps = cb.StartUndo();
+		for (int step = 0; step < steps; step++) {
+			cb.PerformUndoStep();
+		}
+		operations++;
+	}
+	return operations;
+}
+
+std::string Contents(const CellBuffer &cb) {
+	std::string contents(cb.Length(), '\0');
+	cb.GetCharRange(&contents[0], 0, cb.Length());
+	return contents;
+}
+
+}
+
+TEST_CASE("UndoHistory") {
+
+	CellBuffer cb(true, false, false);
+
+	SECTION("TextSpansBlocks") {
+		// Operations larger than half an arena block force text into several blocks
+		std::string all;
+		for (int operation = 0; operation < 10; operation++) {
+			const std::string text(UndoArena::blockSize / 2 + 99, static_cast<char>('a' + operation));
+			InsertOperation(cb, text);
+			all += text;
+		}
+		REQUIRE(10 == UndoAll(cb));
+		REQUIRE(0 == cb.Length());
+		int operations = 0;
+		while (cb.CanRedo()) {
+			const int steps = cb.StartRedo();
+			for (int step = 0; step < steps; step++) {
+				cb.PerformRedoStep();
+			}
+			operations++;
+		}
+		REQUIRE(10 == operations);
+		REQUIRE(all == Contents(cb));
+	}
+
+	SECTION("RedoDiscarded") {
+		InsertOperation(cb, "abc");
+		InsertOperation(cb, "def");
+		const int steps = cb.StartUndo();
+		for (int step = 0; step < steps; step++) {
+			cb.PerformUndoStep();
+		}
+		InsertOperation(cb, "xyz");
+		REQUIRE(!cb.CanRedo());
+		REQUIRE("abcxyz" == Contents(cb));
+		REQUIRE(2 == UndoAll(cb));
+		REQUIRE(0 == cb.Length());
+	}
+
+	SECTION("MemoryLimit") {
+		const Sci::Position limit = 2000;
+		cb.SetUndoMemoryLimit(limit);
+		REQUIRE(limit == cb.GetUndoMemoryLimit());
+		const std::string text(50, 'x');
+		for (int operation = 0; operation < 100; operation++) {
+			InsertOperation(cb, text);
+			REQUIRE(cb.UndoMemoryUse() <= limit);
+		}
+		const int operations = UndoAll(cb);
+		REQUIRE(operations > 0);
+		REQUIRE(operations < 100);
+		// Only the most recent operations remain
+		REQUIRE(static_cast<Sci::Position>((100 - operations) * text.length()) == cb.Length());
+	}
+
+	SECTION("SavePointDropped") {
+		const std::string text(50, 'x');
+		InsertOperation(cb, text);
+		cb.SetSavePoint();
+		for (int operation = 0; operation < 100; operation++) {
+			InsertOperation(cb, text);
+		}
+		cb.SetUndoMemoryLimit(2000);
+		REQUIRE(!cb.IsSavePoint());
+		UndoAll(cb);
+		REQUIRE(!cb.IsSavePoint());
+	}
+
+	SECTION("SavePointKept") {
+		cb.SetUndoMemoryLimit(2000);
+		const std::string text(50, 'x');
+		for (int operation = 0; operation < 100; operation++) {
+			InsertOperation(cb, text);
+		}
+		cb.SetSavePoint();
+		InsertOperation(cb, text);
+		REQUIRE(!cb.IsSavePoint());
+		const int steps = cb.StartUndo();
+		for (int step = 0; step < steps; step++) {
+			cb.PerformUndoStep();
+		}
+		REQUIRE(cb.IsSavePoint());
+	}
+
+}
+
+TEST_CASE("CellBufferChunked") {
+
+	CellBuffer cb(true, false, true);
+
+	SECTION("SmallStaysGapped") {
+		bool startSequence = false;
+		cb.InsertString(0, "abc\n", 4, startSequence);
+		REQUIRE(cb.IsChunkable());
+		REQUIRE(!cb.IsChunked());
+	}
+
+	SECTION("InsertDeleteUndo") {
+		std::string text;
+		for (int line = 0; text.length() <= CellStore::lengthChunked; line++) {
+			text += "Line of text " + std::to_string(line) + "\n";
+		}
+		const Sci::Line lines = std::count(text.begin(), text.end(), '\n') + 1;
+		bool startSequence = false;
+		cb.InsertString(0, text.c_str(), text.length(), startSequence);
+		REQUIRE(cb.IsChunked());
+		REQUIRE(static_cast<Sci::Position>(text.length()) == cb.Length());
+		REQUIRE(lines == cb.Lines());
+		const Sci::Position middle = cb.LineStart(lines / 2);
+		REQUIRE('L' == cb.CharAt(middle));
+		cb.SetStyleAt(middle, 3);
+		REQUIRE(3 == cb.StyleAt(middle));
+		REQUIRE(0 == cb.StyleAt(middle + 1));
+
+		// Delete across a chunk boundary so undo has to copy the text
+		const Sci::Position boundary = ChunkVector<char>::chunkLengthFill * 3 - 2;
+		cb.DeleteChars(boundary, 5, startSequence);
+		std::string expected = text;
+		expected.erase(boundary, 5);
+		REQUIRE(expected == Contents(cb));
+
+		const int steps = cb.StartUndo();
+		REQUIRE(1 == steps);
+		cb.PerformUndoStep();
+		REQUIRE(text == Contents(cb));
+		REQUIRE(nullptr == cb.BufferPointer());
+		const Sci::Position inChunk = ChunkVector<char>::chunkLengthFill * 5 + 100;
+		REQUIRE(text.substr(inChunk, 10) == std::string(cb.RangePointer(inChunk, 10), 10));
+	}
+
+}
+
 TEST_CASE("CharacterIndex") {
 
-	CellBuffer cb(true, false);
+	CellBuffer cb(true, false, false);
 
 	SECTION("Setup") {
 		REQUIRE(cb.LineCharacterIndex() == SC_LINECHARACTERINDEX_NONE);
@@ -0,0 +1,68 @@
+// Unit Tests for Scintilla internal data structures
+
+#include <cstddef>
+
+#include <vector>
+
+#include "CharacterCategory.h"
+
+#include "catch.hpp"
+
+using namespace Scintilla;
+
+// Test CharacterCategory.
+
+TEST_CASE("CharacterCategory") {
+
+	SECTION("Categorise") {
+		REQUIRE(ccLu == CategoriseCharacter('A'));
+		REQUIRE(ccLl == CategoriseCharacter('a'));
+		REQUIRE(ccNd == CategoriseCharacter('0'));
+		REQUIRE(ccZs == CategoriseCharacter(' '));
+		REQUIRE(ccCc == CategoriseCharacter('\n'));
+		REQUIRE(ccLo == CategoriseCharacter(0x4E00));	// CJK UNIFIED IDEOGRAPH-4E00
+		REQUIRE(ccLo == CategoriseCharacter(0xAC00));	// HANGUL SYLLABLE GA
+		REQUIRE(ccSo == CategoriseCharacter(0x1F600));	// GRINNING FACE
+		REQUIRE(ccCs == CategoriseCharacter(0xD800));
+		REQUIRE(ccCo == CategoriseCharacter(0xE000));
+		REQUIRE(ccCn == CategoriseCharacter(0x50000));
+		REQUIRE(ccCo == CategoriseCharacter(0x100000));
+	}
+
+	SECTION("OutOfRange") {
+		REQUIRE(ccCn == CategoriseCharacter(-1));
+		REQUIRE(ccCn == CategoriseCharacter(0x110000));
+	}
+
+	SECTION("Identifiers") {
+		REQUIRE(IsIdStart('a'));
+		REQUIRE(!IsIdStart('1'));
+		REQUIRE(IsIdContinue('1'));
+		REQUIRE(IsIdStart(0x4E00));
+		REQUIRE(!IsIdContinue(0x1F600));
+		// Other_ID_Start and Other_ID_Continue
+		REQUIRE(IsIdStart(0x2118));	// SCRIPT CAPITAL P
+		REQUIRE(!IsIdStart(0x00B7));	// MIDDLE DOT
+		REQUIRE(IsIdContinue(0x00B7));
+		// Pattern_Syntax
+		REQUIRE(!IsIdStart(0x2E2F));	// VERTICAL TILDE
+		REQUIRE(!IsIdContinue(0x2E2F));
+		// Modified for NFKC
+		REQUIRE(IsIdStart(0x037A));	// GREEK YPOGEGRAMMENI
+		REQUIRE(!IsXidStart(0x037A));
+		REQUIRE(!IsXidContinue(0x037A));
+		REQUIRE(IsXidContinue(0x0E33));	// THAI CHARACTER SARA AM
+		REQUIRE(!IsXidStart(0x0E33));
+	}
+
+	SECTION("Map") {
+		CharacterCategoryMap categoryMap;
+		REQUIRE(256 == categoryMap.Size());
+		categoryMap.Optimize(0x10000);
+		REQUIRE(0x10000 == categoryMap.Size());
+		for (int ch = 0; ch < 0x11000; ch += 7) {
+			REQUIRE(CategoriseCharacter(ch) == categoryMap.CategoryFor(ch));
+		}
+	}
+
+}
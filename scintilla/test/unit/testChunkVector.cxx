@@ -0,0 +1,189 @@
+// Unit Tests for Scintilla internal data structures
+
+#include <cstddef>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <random>
+
+#include "Platform.h"
+
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "ChunkVector.h"
+
+#include "catch.hpp"
+
+using namespace Scintilla;
+
+// Test ChunkVector.
+
+namespace {
+
+std::string Contents(const ChunkVector<char> &cv) {
+	std::string s(cv.Length(), '\0');
+	cv.GetRange(&s[0], 0, cv.Length());
+	return s;
+}
+
+std::string Pattern(size_t length, char start) {
+	std::string s(length, '\0');
+	for (size_t i = 0; i < length; i++) {
+		s[i] = static_cast<char>(start + i % 23);
+	}
+	return s;
+}
+
+}
+
+TEST_CASE("ChunkVector") {
+
+	ChunkVector<char> cv;
+
+	SECTION("IsEmptyInitially") {
+		REQUIRE(0 == cv.Length());
+		REQUIRE(1 == cv.Chunks());
+		REQUIRE(0 == cv.ValueAt(0));
+	}
+
+	SECTION("InsertFromArray") {
+		cv.InsertFromArray(0, "abcd", 1, 2);
+		REQUIRE(2 == cv.Length());
+		REQUIRE('b' == cv.ValueAt(0));
+		REQUIRE('c' == cv.ValueAt(1));
+		cv.InsertFromArray(1, "xy", 0, 2);
+		REQUIRE("bxyc" == Contents(cv));
+	}
+
+	SECTION("InsertValue") {
+		cv.InsertValue(0, 3, 'z');
+		REQUIRE("zzz" == Contents(cv));
+	}
+
+	SECTION("SetValue") {
+		cv.InsertValue(0, 3, 'a');
+		cv.SetValueAt(1, 'b');
+		REQUIRE("aba" == Contents(cv));
+		REQUIRE(cv.SetRange(0, 3, 'b'));
+		REQUIRE(!cv.SetRange(0, 3, 'b'));
+		REQUIRE("bbb" == Contents(cv));
+	}
+
+	SECTION("LargeInsertionDivides") {
+		const std::string large = Pattern(ChunkVector<char>::chunkLengthMax * 3 + 17, 'a');
+		cv.InsertFromArray(0, large.c_str(), 0, large.length());
+		REQUIRE(static_cast<ptrdiff_t>(large.length()) == cv.Length());
+		REQUIRE(cv.Chunks() > 3);
+		REQUIRE(large == Contents(cv));
+		REQUIRE(large[ChunkVector<char>::chunkLengthFill] == cv.ValueAt(ChunkVector<char>::chunkLengthFill));
+		// Insert into middle of large chunked contents
+		const std::string middle = Pattern(ChunkVector<char>::chunkLengthMax + 5, 'A');
+		const ptrdiff_t position = ChunkVector<char>::chunkLengthFill + 7;
+		cv.InsertFromArray(position, middle.c_str(), 0, middle.length());
+		std::string expected = large;
+		expected.insert(position, middle);
+		REQUIRE(expected == Contents(cv));
+	}
+
+	SECTION("DeleteRange") {
+		const std::string large = Pattern(ChunkVector<char>::chunkLengthMax * 2, 'a');
+		cv.InsertFromArray(0, large.c_str(), 0, large.length());
+		cv.DeleteRange(10, ChunkVector<char>::chunkLengthMax);
+		std::string expected = large;
+		expected.erase(10, ChunkVector<char>::chunkLengthMax);
+		REQUIRE(expected == Contents(cv));
+		cv.DeleteRange(0, cv.Length());
+		REQUIRE(0 == cv.Length());
+		REQUIRE(1 == cv.Chunks());
+	}
+
+	SECTION("BufferPointer") {
+		cv.InsertFromArray(0, "abc", 0, 3);
+		const char *data = cv.BufferPointer();
+		REQUIRE("abc" == std::string(data, 3));
+		REQUIRE(0 == data[3]);
+		// Multiple chunks are not combined as that would move the whole document
+		const std::string large = Pattern(ChunkVector<char>::chunkLengthMax * 2 + 3, 'a');
+		cv.InsertFromArray(0, large.c_str(), 0, large.length());
+		const ptrdiff_t chunks = cv.Chunks();
+		REQUIRE(chunks > 1);
+		REQUIRE(nullptr == cv.BufferPointer());
+		REQUIRE(chunks == cv.Chunks());
+	}
+
+	SECTION("RangePointer") {
+		const std::string large = Pattern(ChunkVector<char>::chunkLengthMax * 2, 'a');
+		cv.InsertFromArray(0, large.c_str(), 0, large.length());
+		cv.InsertFromArray(10, "xyz", 0, 3);
+		std::string expected = large;
+		expected.insert(10, "xyz");
+		// Range around the gap within the first chunk
+		const char *data = cv.RangePointer(5, 20);
+		REQUIRE(expected.substr(5, 20) == std::string(data, 20));
+		// Range across a chunk boundary is not available
+		const ptrdiff_t chunks = cv.Chunks();
+		REQUIRE(nullptr == cv.RangePointer(ChunkVector<char>::chunkLengthFill - 5, 10));
+		REQUIRE(chunks == cv.Chunks());
+		REQUIRE(nullptr == cv.RangePointer(cv.Length() - 5, 10));
+		REQUIRE(expected == Contents(cv));
+	}
+
+	SECTION("Typing") {
+		// Insert single elements in the middle as when typing
+		const std::string large = Pattern(ChunkVector<char>::chunkLengthMax * 2, 'a');
+		cv.InsertFromArray(0, large.c_str(), 0, large.length());
+		std::string expected = large;
+		ptrdiff_t position = large.length() / 2 + 3;
+		for (int i = 0; i < ChunkVector<char>::chunkLengthMax + 100; i++) {
+			const char ch = static_cast<char>('A' + i % 26);
+			cv.InsertFromArray(position, &ch, 0, 1);
+			expected.insert(expected.begin() + position, ch);
+			position++;
+		}
+		REQUIRE(expected == Contents(cv));
+		for (int i = 0; i < 200; i++) {
+			position--;
+			cv.DeleteRange(position, 1);
+			expected.erase(position, 1);
+		}
+		REQUIRE(expected == Contents(cv));
+	}
+
+	SECTION("RandomEdits") {
+		// Compare with std::string over many insertions and deletions of varied sizes
+		std::mt19937 rng(7);
+		std::string expected;
+		for (int i = 0; i < 2000; i++) {
+			const ptrdiff_t position = expected.empty() ? 0 : rng() % (expected.length() + 1);
+			if ((rng() % 3) || expected.empty()) {
+				const size_t length = (rng() % 10 == 0) ? rng() % (ChunkVector<char>::chunkLengthMax * 2) : rng() % 100;
+				const std::string insertion = Pattern(length, static_cast<char>('a' + i % 20));
+				cv.InsertFromArray(position, insertion.c_str(), 0, insertion.length());
+				expected.insert(position, insertion);
+			} else {
+				const ptrdiff_t length = rng() % (expected.length() - position + 1);
+				cv.DeleteRange(position, length);
+				expected.erase(position, length);
+			}
+			if (i % 97 == 0) {
+				const ptrdiff_t start = expected.empty() ? 0 : rng() % expected.length();
+				const ptrdiff_t length = std::min<ptrdiff_t>(rng() % 1000, expected.length() - start);
+				const char *data = cv.RangePointer(start, length);
+				if (data) {
+					REQUIRE(expected.substr(start, length) == std::string(data, length));
+				}
+			}
+			REQUIRE(static_cast<ptrdiff_t>(expected.length()) == cv.Length());
+		}
+		REQUIRE(expected == Contents(cv));
+		for (size_t i = 0; i < expected.length(); i += 101) {
+			REQUIRE(expected[i] == cv.ValueAt(i));
+		}
+	}
+}
@@ -92,4 +92,57 @@ TEST_CASE("DecorationList") {
 		REQUIRE(decol->End(indicatorB, 5) == 6);
 	}
 
+	SECTION("SpansIntersecting") {
+		decol->InsertSpace(0, 20);
+		decol->SetCurrentIndicator(indicator);
+		decol->FillRange(2, 1, 3);
+		decol->FillRange(10, 1, 5);
+		decol->SetCurrentValue(2);
+		decol->FillRange(15, 2, 2);
+		const int indicatorB=6;
+		decol->SetCurrentIndicator(indicatorB);
+		decol->FillRange(0, 7, 12);
+		std::vector<DecorationSpan> spans;
+		decol->SpansIntersecting(4, 16, spans);
+		// Ordered by indicator then position and not clipped to the range
+		REQUIRE(spans.size() == 4);
+		REQUIRE(spans[0].indicator == indicator);
+		REQUIRE(spans[0].value == 1);
+		REQUIRE(spans[0].start == 2);
+		REQUIRE(spans[0].end == 5);
+		REQUIRE(spans[1].start == 10);
+		REQUIRE(spans[1].end == 15);
+		REQUIRE(spans[2].value == 2);
+		REQUIRE(spans[2].start == 15);
+		REQUIRE(spans[2].end == 17);
+		REQUIRE(spans[3].indicator == indicatorB);
+		REQUIRE(spans[3].value == 7);
+		REQUIRE(spans[3].start == 0);
+		REQUIRE(spans[3].end == 12);
+		spans.clear();
+		decol->SpansIntersecting(5, 10, spans);
+		REQUIRE(spans.size() == 1);
+		REQUIRE(spans[0].indicator == indicatorB);
+		spans.clear();
+		decol->SpansIntersecting(17, 40, spans);
+		REQUIRE(spans.empty());
+	}
+
+	SECTION("VersionChanges") {
+		decol->InsertSpace(0, 10);
+		decol->SetCurrentIndicator(indicator);
+		size_t version = decol->Version();
+		decol->FillRange(2, 1, 3);
+		REQUIRE(decol->Version() != version);
+		version = decol->Version();
+		// Filling with the same value changes nothing
+		decol->FillRange(2, 1, 3);
+		REQUIRE(decol->Version() == version);
+		decol->InsertSpace(1, 1);
+		REQUIRE(decol->Version() != version);
+		version = decol->Version();
+		decol->DeleteRange(1, 1);
+		REQUIRE(decol->Version() != version);
+	}
+
 }
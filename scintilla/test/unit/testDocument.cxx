@@ -0,0 +1,383 @@
+// Unit Tests for Scintilla internal data structures
+
+#include <cstddef>
+#include <cassert>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <forward_list>
+#include <algorithm>
+#include <memory>
+#include <future>
+
+#include "Platform.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include "CharacterCategory.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "BackgroundStyler.h"
+
+#include "LexAccessor.h"
+#include "DefaultLexer.h"
+
+#include "catch.hpp"
+
+using namespace Scintilla;
+
+namespace {
+
+// Styles text between '[' and ']' as 1 and everything else as 0.
+// When backtracking, ignores the initial style and scans back to the nearest bracket
+// then restyles from there as some lexers do to find the start of a construct.
+class LexerBrackets : public DefaultLexer {
+	bool backtrack;
+public:
+	explicit LexerBrackets(bool backtrack_) : backtrack(backtrack_) {
+	}
+	void SCI_METHOD Lex(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle, IDocument *pAccess) override {
+		Sci_Position position = startPos;
+		int style = initStyle;
+		char ch = 0;
+		if (backtrack) {
+			while (position > 0) {
+				pAccess->GetCharRange(&ch, position - 1, 1);
+				if ((ch == '[') || (ch == ']'))
+					break;
+				position--;
+			}
+			style = ((position > 0) && (ch == '[')) ? 1 : 0;
+		}
+		pAccess->StartStyling(position);
+		const Sci_Position end = startPos + lengthDoc;
+		for (; position < end; position++) {
+			pAccess->GetCharRange(&ch, position, 1);
+			if (ch == '[')
+				style = 1;
+			pAccess->SetStyleFor(1, static_cast<char>(style));
+			if (ch == ']')
+				style = 0;
+		}
+	}
+};
+
+class TestLexInterface : public LexInterface {
+public:
+	TestLexInterface(Document *pdoc_, ILexer4 *instance_) : LexInterface(pdoc_) {
+		instance = instance_;
+	}
+	~TestLexInterface() override {
+		instance->Release();
+	}
+};
+
+// Asks for a pointer to the whole document whenever styles change, as an application
+// handling SCN_MODIFIED with SCI_GETCHARACTERPOINTER may, moving the gap.
+class WatcherCharacterPointer : public DocWatcher {
+public:
+	int styleChanges = 0;
+	void NotifyModifyAttempt(Document *, void *) override {}
+	void NotifySavePoint(Document *, void *, bool) override {}
+	void NotifyModified(Document *doc, DocModification mh, void *) override {
+		if (mh.modificationType & SC_MOD_CHANGESTYLE) {
+			styleChanges++;
+			doc->BufferPointer();
+		}
+	}
+	void NotifyDeleted(Document *, void *) noexcept override {}
+	void NotifyStyleNeeded(Document *, void *, Sci::Position) override {}
+	void NotifyLexerChanged(Document *, void *) override {}
+	void NotifyErrorOccurred(Document *, void *, int) override {}
+};
+
+// A bracketed block much longer than the window copied around background styling jobs.
+std::string LongBlock() {
+	std::string text = "start\n[\n";
+	for (int line = 0; line < 60000; line++) {
+		text += "abcd\n";
+	}
+	text += "]\n";
+	for (int line = 0; line < 1000; line++) {
+		text += "xy\n";
+	}
+	return text;
+}
+
+// Style the start of the document synchronously then the rest in the background
+// the way Editor::IdleStyling does.
+void StyleInBackground(Document &doc, Sci::Position styledSynchronously) {
+	doc.EnsureStyledTo(styledSynchronously);
+	while (doc.GetEndStyled() < doc.Length()) {
+		if (doc.StyleInBackground(doc.Length(), 10.0))
+			doc.FinishBackgroundStyling();
+		else
+			doc.EnsureStyledTo(doc.Length());
+	}
+}
+
+Sci::Position FindRegex(Document &doc, const char *pattern, int flags, bool forward = true) {
+	Sci::Position length = strlen(pattern);
+	if (forward)
+		return doc.FindText(0, doc.Length(), pattern, flags | SCFIND_REGEXP, &length);
+	else
+		return doc.FindText(doc.Length(), 0, pattern, flags | SCFIND_REGEXP, &length);
+}
+
+// A line of characters of 1, 2, 3 and 4 bytes in UTF-8.
+std::string MixedLine(int characters) {
+	const char *pieces[] = { "a", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80" };
+	std::string line;
+	for (int i = 0; i < characters; i++) {
+		line += pieces[(i * 7 / 3) % 4];
+	}
+	return line + "\n";
+}
+
+// Count the characters of the line that do not convert the same through the cache as by counting.
+Sci::Position CacheDifferences(LineCharacterCache &cache, const Document &doc, Sci::Line line) {
+	const Sci::Position lineStart = doc.LineStart(line);
+	const Sci::Position lineEnd = doc.LineStart(line + 1);
+	Sci::Position differences = 0;
+	Sci::Position character = 0;
+	for (Sci::Position pos = lineStart; pos < lineEnd; pos = doc.NextPosition(pos, 1)) {
+		if (cache.CharactersBefore(&doc, line, pos) != character)
+			differences++;
+		if (cache.PositionOfCharacter(&doc, line, character) != pos)
+			differences++;
+		character++;
+	}
+	return differences;
+}
+
+Sci::Position DifferentStyles(const Document &doc, const Document &docExpected) {
+	Sci::Position differences = 0;
+	for (Sci::Position position = 0; position < docExpected.Length(); position++) {
+		if (doc.StyleIndexAt(position) != docExpected.StyleIndexAt(position))
+			differences++;
+	}
+	return differences;
+}
+
+}
+
+// Test Document.
+
+TEST_CASE("Document") {
+
+	const std::string text = LongBlock();
+	Document doc(SC_DOCUMENTOPTION_DEFAULT);
+	doc.InsertString(0, text.c_str(), text.length());
+	// Deep enough into the block that its start is outside the window of a background job
+	const Sci::Position styledSynchronously = doc.LineStart(40000);
+
+	SECTION("BackgroundStylingMatchesSynchronous") {
+		for (const bool backtrack : { false, true }) {
+			Document docSynchronous(SC_DOCUMENTOPTION_DEFAULT);
+			docSynchronous.InsertString(0, text.c_str(), text.length());
+			docSynchronous.SetLexInterface(new TestLexInterface(&docSynchronous, new LexerBrackets(backtrack)));
+			docSynchronous.EnsureStyledTo(docSynchronous.Length());
+			REQUIRE(docSynchronous.StyleIndexAt(styledSynchronously) == 1);
+
+			Document docBackground(SC_DOCUMENTOPTION_DEFAULT);
+			docBackground.InsertString(0, text.c_str(), text.length());
+			docBackground.SetLexInterface(new TestLexInterface(&docBackground, new LexerBrackets(backtrack)));
+			StyleInBackground(docBackground, styledSynchronously);
+			REQUIRE(DifferentStyles(docBackground, docSynchronous) == 0);
+		}
+	}
+
+	SECTION("LexAccessorRefetchesAfterStyling") {
+		// Move the gap near the start so the lexer's borrowed window is made contiguous
+		// by moving the gap to its start and the watcher then moves it to the end.
+		doc.InsertString(100, "x", 1);
+		const std::string textNow = text.substr(0, 100) + "x" + text.substr(100);
+		WatcherCharacterPointer watcher;
+		doc.AddWatcher(&watcher, nullptr);
+		LexAccessor styler(&doc);
+		styler.StartAt(0);
+		styler.StartSegment(0);
+		const Sci::Position lengthLexed = 20000;
+		Sci::Position differences = 0;
+		for (Sci::Position position = 0; position < lengthLexed; position++) {
+			if (styler[position] != textNow[position])
+				differences++;
+			styler.ColourTo(position, 1);
+		}
+		styler.Flush();
+		doc.RemoveWatcher(&watcher, nullptr);
+		REQUIRE(watcher.styleChanges > 1);
+		REQUIRE(differences == 0);
+	}
+
+	SECTION("SnapshotNoticesAccessOutside") {
+		doc.SetLexInterface(new TestLexInterface(&doc, new LexerBrackets(false)));
+		doc.EnsureStyledTo(styledSynchronously);
+		const Sci::Position end = doc.LineStart(41000);
+		const int styleStart = doc.StyleIndexAt(styledSynchronously - 1);
+
+		LexerBrackets lexerForward(false);
+		StyleSnapshot snapshotForward(&doc, styledSynchronously, end, 0x10000);
+		lexerForward.Lex(styledSynchronously, end - styledSynchronously, styleStart, &snapshotForward);
+		REQUIRE(!snapshotForward.Outside());
+		REQUIRE(snapshotForward.StyleAt(styledSynchronously) == 1);
+
+		LexerBrackets lexerBacktrack(true);
+		StyleSnapshot snapshotBacktrack(&doc, styledSynchronously, end, 0x10000);
+		lexerBacktrack.Lex(styledSynchronously, end - styledSynchronously, styleStart, &snapshotBacktrack);
+		REQUIRE(snapshotBacktrack.Outside());
+	}
+
+}
+
+TEST_CASE("DocumentFindText") {
+
+	Document doc(SC_DOCUMENTOPTION_DEFAULT);
+	doc.SetDBCSCodePage(SC_CP_UTF8);
+
+	SECTION("PrefixCaseSensitive") {
+		const std::string text = "abc\nxAbcd Abc\nAbc\n";
+		doc.InsertString(0, text.c_str(), text.length());
+		for (const int flags : { SCFIND_MATCHCASE, SCFIND_MATCHCASE | SCFIND_CXX11REGEX }) {
+			REQUIRE(FindRegex(doc, "Abc", flags) == 5);
+			REQUIRE(FindRegex(doc, "Abc", flags, false) == 14);
+			REQUIRE(FindRegex(doc, "Abcd", flags) == 5);
+			REQUIRE(FindRegex(doc, "abc", flags, false) == 0);
+			REQUIRE(FindRegex(doc, "Abx", flags) == -1);
+		}
+	}
+
+	SECTION("PrefixCaseInsensitive") {
+		const std::string text = "xyz\nxAbcd ABC\naBc\n";
+		doc.InsertString(0, text.c_str(), text.length());
+		for (const int flags : { 0, SCFIND_CXX11REGEX }) {
+			REQUIRE(FindRegex(doc, "abc", flags) == 5);
+			REQUIRE(FindRegex(doc, "ABC", flags, false) == 14);
+			REQUIRE(FindRegex(doc, "bCD", flags) == 6);
+			REQUIRE(FindRegex(doc, "abx", flags) == -1);
+		}
+	}
+
+	SECTION("PrefixNonASCII") {
+		const std::string text = "l\xc3\xadnea\n\xce\xb1 \xce\xb2\xce\xb3\n\xce\xb2\xce\xb3\n";
+		doc.InsertString(0, text.c_str(), text.length());
+		const Sci::Position first = text.find("\xce\xb2\xce\xb3");
+		const Sci::Position last = text.rfind("\xce\xb2\xce\xb3");
+		for (const int flags : { 0, SCFIND_MATCHCASE, SCFIND_CXX11REGEX, SCFIND_MATCHCASE | SCFIND_CXX11REGEX }) {
+			REQUIRE(FindRegex(doc, "\xce\xb2\xce\xb3", flags) == first);
+			REQUIRE(FindRegex(doc, "\xce\xb2\xce\xb3", flags, false) == last);
+			REQUIRE(FindRegex(doc, "nea", flags) == 3);
+		}
+	}
+
+	SECTION("PrefixDoesNotSkipFolding") {
+		// KELVIN SIGN may match 'k' case-insensitively depending on the regular expression
+		// library so the prefix check must give the same result as a pattern without a prefix.
+		const std::string text = "one\ntwo \xe2\x84\xaa\nok\n";
+		doc.InsertString(0, text.c_str(), text.length());
+		for (const int flags : { 0, SCFIND_CXX11REGEX }) {
+			REQUIRE(FindRegex(doc, "k", flags) == FindRegex(doc, "[k]", flags));
+			REQUIRE(FindRegex(doc, "k", flags, false) == FindRegex(doc, "[k]", flags, false));
+			REQUIRE(FindRegex(doc, "ok", flags) == FindRegex(doc, "[o]k", flags));
+		}
+	}
+
+	SECTION("CompiledPatternFollowsWordCharacters") {
+		const std::string text = "one-two three\n";
+		doc.InsertString(0, text.c_str(), text.length());
+		Sci::Position length = 3;
+		REQUIRE(doc.FindText(0, doc.Length(), "\\w+", SCFIND_REGEXP, &length) == 0);
+		REQUIRE(length == 3);
+		// Changing the word characters must not reuse the previously compiled pattern
+		doc.SetCharClasses(reinterpret_cast<const unsigned char *>("-"), CharClassify::ccWord);
+		length = 3;
+		REQUIRE(doc.FindText(0, doc.Length(), "\\w+", SCFIND_REGEXP, &length) == 0);
+		REQUIRE(length == 7);
+		doc.SetDefaultCharClasses(true);
+		length = 3;
+		REQUIRE(doc.FindText(0, doc.Length(), "\\w+", SCFIND_REGEXP, &length) == 0);
+		REQUIRE(length == 3);
+	}
+
+}
+
+TEST_CASE("LineCharacterCache") {
+
+	Document doc(SC_DOCUMENTOPTION_DEFAULT);
+	doc.SetDBCSCodePage(SC_CP_UTF8);
+	const std::string longLine = MixedLine(1000);
+	const std::string text = "short\n" + longLine + "mid\n" + longLine + "end";
+	doc.InsertString(0, text.c_str(), text.length());
+	LineCharacterCache cache;
+
+	SECTION("Conversions") {
+		for (Sci::Line line = 0; line < doc.LinesTotal(); line++) {
+			REQUIRE(CacheDifferences(cache, doc, line) == 0);
+		}
+		// Only the long lines are cached
+		REQUIRE(cache.LinesCached() == 2);
+		// Offsets past the end of the document are clamped
+		REQUIRE(cache.PositionOfCharacter(&doc, 3, 100000) == doc.Length());
+	}
+
+	SECTION("ModifyCachedLine") {
+		REQUIRE(CacheDifferences(cache, doc, 1) == 0);
+		REQUIRE(CacheDifferences(cache, doc, 3) == 0);
+		const Sci::Position position = doc.LineStart(1) + 10;
+		doc.InsertString(position, "\xe2\x82\xac", 3);
+		cache.Modified(1, 0);
+		REQUIRE(CacheDifferences(cache, doc, 1) == 0);
+		doc.DeleteChars(position, 4);
+		cache.Modified(1, 0);
+		REQUIRE(CacheDifferences(cache, doc, 1) == 0);
+		REQUIRE(CacheDifferences(cache, doc, 3) == 0);
+	}
+
+	SECTION("LinesInsertedBefore") {
+		REQUIRE(CacheDifferences(cache, doc, 1) == 0);
+		REQUIRE(CacheDifferences(cache, doc, 3) == 0);
+		doc.InsertString(2, "\n\n", 2);
+		cache.Modified(0, 2);
+		REQUIRE(cache.LinesCached() == 2);
+		REQUIRE(CacheDifferences(cache, doc, 3) == 0);
+		REQUIRE(CacheDifferences(cache, doc, 5) == 0);
+		REQUIRE(cache.LinesCached() == 2);
+	}
+
+	SECTION("LinesDeletedBefore") {
+		REQUIRE(CacheDifferences(cache, doc, 1) == 0);
+		REQUIRE(CacheDifferences(cache, doc, 3) == 0);
+		// Join the first long line to the middle line
+		const Sci::Position position = doc.LineStart(2) - 1;
+		doc.DeleteChars(position, 1);
+		cache.Modified(1, -1);
+		REQUIRE(cache.LinesCached() == 1);
+		REQUIRE(CacheDifferences(cache, doc, 1) == 0);
+		REQUIRE(CacheDifferences(cache, doc, 2) == 0);
+	}
+
+	SECTION("LeastRecentlyUsedDropped") {
+		std::string lines;
+		for (size_t line = 0; line < LineCharacterCache::linesCached + 2; line++) {
+			lines += longLine;
+		}
+		doc.InsertString(0, lines.c_str(), lines.length());
+		for (Sci::Line line = 0; line < doc.LinesTotal(); line++) {
+			REQUIRE(CacheDifferences(cache, doc, line) == 0);
+		}
+		REQUIRE(cache.LinesCached() == LineCharacterCache::linesCached);
+	}
+
+}
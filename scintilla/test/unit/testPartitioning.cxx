@@ -106,6 +106,28 @@ TEST_CASE("Partitioning") {
 		REQUIRE(8 == part.PositionFromPartition(2));
 	}
 
+	SECTION("InsertMultiple") {
+		part.InsertText(0, 10);
+		const Sci::Position positions[] = {2, 4, 6};
+		part.InsertPartitions(1, positions, 3);
+		REQUIRE(4 == part.Partitions());
+		REQUIRE(2 == part.PositionFromPartition(1));
+		REQUIRE(4 == part.PositionFromPartition(2));
+		REQUIRE(6 == part.PositionFromPartition(3));
+		REQUIRE(10 == part.PositionFromPartition(4));
+		// Pending step before the insertion point
+		part.InsertText(1, 2);
+		const Sci::Position positionsAfterStep[] = {7, 8};
+		part.InsertPartitions(3, positionsAfterStep, 2);
+		REQUIRE(6 == part.Partitions());
+		REQUIRE(2 == part.PositionFromPartition(1));
+		REQUIRE(6 == part.PositionFromPartition(2));
+		REQUIRE(7 == part.PositionFromPartition(3));
+		REQUIRE(8 == part.PositionFromPartition(4));
+		REQUIRE(8 == part.PositionFromPartition(5));
+		REQUIRE(12 == part.PositionFromPartition(6));
+	}
+
 	SECTION("InverseSearch") {
 		part.InsertText(0, 3);
 		part.InsertPartition(1, 2);
@@ -356,3 +356,32 @@ TEST_CASE("UTF8Classify") {
 		REQUIRE(UTFClass("\xF0\x9F\x9Fq") == (1 | UTF8MaskInvalid));
 	}
 }
+
+TEST_CASE("UTF8Counting") {
+
+	SECTION("UTF8AsciiLength") {
+		REQUIRE(UTF8AsciiLength("") == 0U);
+		REQUIRE(UTF8AsciiLength("abc") == 3U);
+		REQUIRE(UTF8AsciiLength("abcdefghijklmnopqrstuvwxyz") == 26U);
+		REQUIRE(UTF8AsciiLength("abcdefghijk\xE2\x82\xACz") == 11U);
+		REQUIRE(UTF8AsciiLength("\xC2\xA2z") == 0U);
+	}
+
+	SECTION("UTF8CountCharacters") {
+		// Dollar, Cent, Euro, Hwair
+		const std::string_view s = "$\xC2\xA2\xE2\x82\xAC\xF0\x90\x8D\x88" "abcdefghij";
+		REQUIRE(UTF8CountCharacters(s, false) == 14U);
+		REQUIRE(UTF8CountCharacters(s, true) == 15U);
+	}
+
+	SECTION("UTF8CountCharacters Invalid") {
+		// Each byte of an invalid sequence is a character
+		REQUIRE(UTF8CountCharacters("\xE2\x82q", false) == 3U);
+		REQUIRE(UTF8CountCharacters("a\xF4\x90\x80\x80", true) == 5U);
+	}
+
+	SECTION("UTF8IsValid") {
+		REQUIRE(UTF8IsValid("abcdefghijklmnop\xE2\x82\xAC"));
+		REQUIRE(!UTF8IsValid("abcdefghijklmnop\xE2\x82"));
+	}
+}
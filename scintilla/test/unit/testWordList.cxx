@@ -2,6 +2,8 @@
 
 #include <string.h>
 
+#include <string>
+
 #include "WordList.h"
 
 #include "catch.hpp"
@@ -31,6 +33,50 @@ TEST_CASE("WordList") {
 		REQUIRE(0 == strcmp(wl.WordAt(0), "else"));
 	}
 
+	SECTION("InListPrefix") {
+		wl.Set("else ^GTK_ struct");
+		REQUIRE(wl.InList("GTK_X"));
+		REQUIRE(wl.InList("GTK_"));
+		REQUIRE(!wl.InList("GTK"));
+		REQUIRE(wl.InListAbbreviated("GTK_MAJOR_VERSION", '~'));
+		REQUIRE(!wl.InListAbridged("GTK_X", '~'));
+	}
+
+	SECTION("InListMany") {
+		// Enough words to fill many hash slots, all longer than 8 bytes and with a common prefix
+		std::string words;
+		for (int i = 0; i < 5000; i++) {
+			words += "identifier_" + std::to_string(i * 3) + " ";
+		}
+		wl.Set(words.c_str());
+		REQUIRE(5000 == wl.Length());
+		for (int i = 0; i < 15000; i++) {
+			const std::string word = "identifier_" + std::to_string(i);
+			REQUIRE(wl.InList(word.c_str()) == (i % 3 == 0));
+		}
+		REQUIRE(!wl.InList("identifier_"));
+		REQUIRE(!wl.InList(""));
+	}
+
+	SECTION("Copy") {
+		wl.Set("else ^GTK_ struct de~fine");
+		WordList copy(wl);
+		wl.Set("class");
+		REQUIRE(4 == copy.Length());
+		REQUIRE(copy.InList("struct"));
+		REQUIRE(copy.InList("GTK_X"));
+		REQUIRE(copy.InListAbbreviated("def", '~'));
+		REQUIRE(!copy.InList("class"));
+		copy = wl;
+		REQUIRE(1 == copy.Length());
+		REQUIRE(copy.InList("class"));
+		REQUIRE(!copy.InList("struct"));
+		WordList empty;
+		copy = empty;
+		REQUIRE(0 == copy.Length());
+		REQUIRE(!copy.InList("class"));
+	}
+
 	SECTION("InListAbbreviated") {
 		wl.Set("else stru~ct w~hile");
 		REQUIRE(wl.InListAbbreviated("else", '~'));
@@ -11,6 +11,7 @@
         DecorationList
         CellBuffer
         UniConversion
+        Document: background styling, regular expression search, LineCharacterCache
 
     To do:
         PerLine *
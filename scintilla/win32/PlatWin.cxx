@@ -490,6 +490,7 @@ public:
 	void SetUnicodeMode(bool unicodeMode_) override;
 	void SetDBCSMode(int codePage_) override;
 	void SetBidiR2L(bool bidiR2L_) override;
+	bool ThreadSafeMeasureWidths() override;
 };
 
 SurfaceGDI::SurfaceGDI() noexcept {
@@ -975,6 +976,10 @@ void SurfaceGDI::SetDBCSMode(int codePage_) {
 void SurfaceGDI::SetBidiR2L(bool) {
 }
 
+bool SurfaceGDI::ThreadSafeMeasureWidths() {
+	return false;
+}
+
 #if defined(USE_D2D)
 
 class BlobInline;
@@ -1061,6 +1066,7 @@ public:
 	void SetUnicodeMode(bool unicodeMode_) override;
 	void SetDBCSMode(int codePage_) override;
 	void SetBidiR2L(bool bidiR2L_) override;
+	bool ThreadSafeMeasureWidths() override;
 };
 
 SurfaceD2D::SurfaceD2D() noexcept :
@@ -2109,6 +2115,12 @@ void SurfaceD2D::SetDBCSMode(int codePage_) {
 void SurfaceD2D::SetBidiR2L(bool) {
 }
 
+bool SurfaceD2D::ThreadSafeMeasureWidths() {
+	// Text layouts are created for each measurement from the shared DirectWrite factory
+	// which is thread safe.
+	return true;
+}
+
 #endif
 
 Surface *Surface::Allocate(int technology) {
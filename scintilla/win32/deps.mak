@@ -108,6 +108,26 @@ AutoComplete.o: \
 	../lexlib/CharacterSet.h \
 	../src/Position.h \
 	../src/AutoComplete.h
+BackgroundStyler.o: \
+	../src/BackgroundStyler.cxx \
+	../include/Platform.h \
+	../include/ILoader.h \
+	../include/Sci_Position.h \
+	../include/ILexer.h \
+	../include/Scintilla.h \
+	../lexlib/CharacterCategory.h \
+	../src/Position.h \
+	../src/SplitVector.h \
+	../src/Partitioning.h \
+	../src/RunStyles.h \
+	../src/CellBuffer.h \
+	../src/CharClassify.h \
+	../src/Decoration.h \
+	../src/CaseFolder.h \
+	../src/Document.h \
+	../src/BackgroundStyler.h \
+	../src/UniConversion.h \
+	../src/ElapsedPeriod.h
 CallTip.o: \
 	../src/CallTip.cxx \
 	../include/Platform.h \
@@ -140,6 +160,7 @@ CellBuffer.o: \
 	../src/Position.h \
 	../src/SplitVector.h \
 	../src/Partitioning.h \
+	../src/ChunkVector.h \
 	../src/CellBuffer.h \
 	../src/UniConversion.h
 CharClassify.o: \
@@ -188,6 +209,7 @@ Document.o: \
 	../src/Decoration.h \
 	../src/CaseFolder.h \
 	../src/Document.h \
+	../src/BackgroundStyler.h \
 	../src/RESearch.h \
 	../src/UniConversion.h \
 	../src/ElapsedPeriod.h
@@ -66,6 +66,7 @@ depend:
 # Required for base Scintilla
 BASEOBJS=\
 	$(DIR_O)\AutoComplete.obj \
+	$(DIR_O)\BackgroundStyler.obj \
 	$(DIR_O)\CallTip.obj \
 	$(DIR_O)\CaseConvert.obj \
 	$(DIR_O)\CaseFolder.obj \
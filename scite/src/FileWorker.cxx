@@ -40,8 +40,13 @@ double FileWorker::Duration() {
 }
 
 FileLoader::FileLoader(WorkerListener *pListener_, ILoader *pLoader_, const FilePath &path_, size_t size_, FILE *fp_) :
-	FileWorker(pListener_, path_, size_, fp_), pLoader(pLoader_), readSoFar(0), unicodeMode(uni8Bit) {
+	FileWorker(pListener_, path_, size_, fp_), mutexStreamed(Mutex::Create()),
+	pLoader(pLoader_), readSoFar(0), unicodeMode(uni8Bit), streaming(pLoader_ == nullptr) {
 	SetSizeJob(size);
+	if (streaming) {
+		// Show the first block as soon as it is read
+		nextProgress = 0.0;
+	}
 }
 
 FileLoader::~FileLoader() {
@@ -57,7 +62,11 @@ void FileLoader::Execute() {
 			GUI::SleepMilliseconds(sleepTime);
 			lenFile = convert.convert(&data[0], lenFile);
 			const char *dataBlock = convert.getNewBuf();
-			err = pLoader->AddData(dataBlock, static_cast<int>(lenFile));
+			if (streaming) {
+				AddStreamed(dataBlock, lenFile);
+			} else {
+				err = pLoader->AddData(dataBlock, static_cast<int>(lenFile));
+			}
 			IncrementProgress(static_cast<int>(lenFile));
 			if (et.Duration() > nextProgress) {
 				nextProgress = et.Duration() + timeBetweenProgress;
@@ -69,7 +78,11 @@ void FileLoader::Execute() {
 				const size_t lenFileTrail = convert.convert(nullptr, lenFile);
 				if (lenFileTrail) {
 					const char *dataTrail = convert.getNewBuf();
-					err = pLoader->AddData(dataTrail, static_cast<int>(lenFileTrail));
+					if (streaming) {
+						AddStreamed(dataTrail, lenFileTrail);
+					} else {
+						err = pLoader->AddData(dataTrail, static_cast<int>(lenFileTrail));
+					}
 				}
 			}
 		}
@@ -88,8 +101,22 @@ void FileLoader::Execute() {
 
 void FileLoader::Cancel() {
 	FileWorker::Cancel();
-	pLoader->Release();
-	pLoader = nullptr;
+	if (pLoader) {
+		pLoader->Release();
+		pLoader = nullptr;
+	}
+}
+
+void FileLoader::AddStreamed(const char *data, size_t length) {
+	Lock lock(mutexStreamed.get());
+	streamed.append(data, length);
+}
+
+std::string FileLoader::TakeStreamed() {
+	Lock lock(mutexStreamed.get());
+	std::string taken;
+	taken.swap(streamed);
+	return taken;
 }
 
 FileStorer::FileStorer(WorkerListener *pListener_, const char *documentBytes_, const FilePath &path_,
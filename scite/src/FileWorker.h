@@ -28,15 +28,22 @@ struct FileWorker : public Worker {
 };
 
 class FileLoader : public FileWorker {
+	// Text read but not yet taken by the main thread when streaming.
+	std::unique_ptr<Mutex> mutexStreamed;
+	std::string streamed;
+	void AddStreamed(const char *data, size_t length);
 public:
 	ILoader *pLoader;
 	size_t readSoFar;
 	UniMode unicodeMode;
+	// Without a loader, text is handed over in pieces to be appended to a visible document.
+	bool streaming;
 
 	FileLoader(WorkerListener *pListener_, ILoader *pLoader_, const FilePath &path_, size_t size_, FILE *fp_);
 	~FileLoader() override;
 	void Execute() override;
 	void Cancel() override;
+	std::string TakeStreamed();
 	bool IsLoading() const override {
 		return true;
 	}
@@ -2109,6 +2109,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_AUTOCGETCURRENTTEXT",2610},
 	{"SCI_AUTOCGETDROPRESTOFWORD",2271},
 	{"SCI_AUTOCGETIGNORECASE",2116},
+	{"SCI_AUTOCGETMATCH",2740},
 	{"SCI_AUTOCGETMAXHEIGHT",2211},
 	{"SCI_AUTOCGETMAXWIDTH",2209},
 	{"SCI_AUTOCGETMULTI",2637},
@@ -2122,6 +2123,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_AUTOCSETDROPRESTOFWORD",2270},
 	{"SCI_AUTOCSETFILLUPS",2112},
 	{"SCI_AUTOCSETIGNORECASE",2115},
+	{"SCI_AUTOCSETMATCH",2739},
 	{"SCI_AUTOCSETMAXHEIGHT",2210},
 	{"SCI_AUTOCSETMAXWIDTH",2208},
 	{"SCI_AUTOCSETMULTI",2636},
@@ -2188,17 +2190,21 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_GETFONTQUALITY",2612},
 	{"SCI_GETGAPPOSITION",2644},
 	{"SCI_GETHIGHLIGHTGUIDE",2135},
+	{"SCI_GETHIGHLIGHTMATCHESCOMPLETE",2736},
+	{"SCI_GETHIGHLIGHTMATCHESSTYLE",2735},
 	{"SCI_GETHOTSPOTACTIVEUNDERLINE",2496},
 	{"SCI_GETHOTSPOTSINGLELINE",2497},
 	{"SCI_GETHSCROLLBAR",2131},
 	{"SCI_GETIDENTIFIER",2623},
 	{"SCI_GETIDLESTYLING",2693},
+	{"SCI_GETIDLESTYLINGTHREADED",2725},
 	{"SCI_GETIMEINTERACTION",2678},
 	{"SCI_GETINDENT",2123},
 	{"SCI_GETINDENTATIONGUIDES",2133},
 	{"SCI_GETINDICATORCURRENT",2501},
 	{"SCI_GETINDICATORVALUE",2503},
 	{"SCI_GETLAYOUTCACHE",2273},
+	{"SCI_GETLAYOUTTHREADS",2727},
 	{"SCI_GETLENGTH",2006},
 	{"SCI_GETLEXER",4002},
 	{"SCI_GETLEXERLANGUAGE",4012},
@@ -2238,6 +2244,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_GETPASTECONVERTENDINGS",2468},
 	{"SCI_GETPHASESDRAW",2673},
 	{"SCI_GETPOSITIONCACHE",2515},
+	{"SCI_GETPOSITIONCACHESTATISTIC",2728},
 	{"SCI_GETPRIMARYSTYLEFROMSTYLE",4028},
 	{"SCI_GETPRINTCOLOURMODE",2149},
 	{"SCI_GETPRINTMAGNIFICATION",2147},
@@ -2271,6 +2278,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_GETSTATUS",2383},
 	{"SCI_GETSTYLEAT",2010},
 	{"SCI_GETSTYLEFROMSUBSTYLE",4027},
+	{"SCI_GETSTYLINGTHREADS",2738},
 	{"SCI_GETSUBSTYLEBASES",4026},
 	{"SCI_GETSUBSTYLESLENGTH",4022},
 	{"SCI_GETSUBSTYLESSTART",4021},
@@ -2284,6 +2292,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_GETTECHNOLOGY",2631},
 	{"SCI_GETTEXTLENGTH",2183},
 	{"SCI_GETUNDOCOLLECTION",2019},
+	{"SCI_GETUNDOMEMORYLIMIT",2730},
 	{"SCI_GETUSETABS",2125},
 	{"SCI_GETVIEWEOL",2355},
 	{"SCI_GETVIEWWS",2020},
@@ -2378,12 +2387,14 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_SETFOLDLEVEL",2222},
 	{"SCI_SETFONTQUALITY",2611},
 	{"SCI_SETHIGHLIGHTGUIDE",2134},
+	{"SCI_SETHIGHLIGHTMATCHESSTYLE",2734},
 	{"SCI_SETHOTSPOTACTIVEUNDERLINE",2412},
 	{"SCI_SETHOTSPOTSINGLELINE",2421},
 	{"SCI_SETHSCROLLBAR",2130},
 	{"SCI_SETIDENTIFIER",2622},
 	{"SCI_SETIDENTIFIERS",4024},
 	{"SCI_SETIDLESTYLING",2692},
+	{"SCI_SETIDLESTYLINGTHREADED",2724},
 	{"SCI_SETIMEINTERACTION",2679},
 	{"SCI_SETINDENT",2122},
 	{"SCI_SETINDENTATIONGUIDES",2132},
@@ -2391,6 +2402,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_SETINDICATORVALUE",2502},
 	{"SCI_SETKEYWORDS",4005},
 	{"SCI_SETLAYOUTCACHE",2272},
+	{"SCI_SETLAYOUTTHREADS",2726},
 	{"SCI_SETLEXER",4001},
 	{"SCI_SETLEXERLANGUAGE",4006},
 	{"SCI_SETLINEENDTYPESALLOWED",2656},
@@ -2445,6 +2457,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_SETSELECTIONSTART",2142},
 	{"SCI_SETSELEOLFILLED",2480},
 	{"SCI_SETSTATUS",2382},
+	{"SCI_SETSTYLINGTHREADS",2737},
 	{"SCI_SETTABDRAWMODE",2699},
 	{"SCI_SETTABINDENTS",2260},
 	{"SCI_SETTABWIDTH",2036},
@@ -2452,6 +2465,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_SETTARGETSTART",2190},
 	{"SCI_SETTECHNOLOGY",2630},
 	{"SCI_SETUNDOCOLLECTION",2012},
+	{"SCI_SETUNDOMEMORYLIMIT",2729},
 	{"SCI_SETUSETABS",2124},
 	{"SCI_SETVIEWEOL",2356},
 	{"SCI_SETVIEWWS",2021},
@@ -2672,6 +2686,8 @@ static IFaceConstant ifaceConstants[] = {
 	{"SC_ALPHA_NOALPHA",256},
 	{"SC_ALPHA_OPAQUE",255},
 	{"SC_ALPHA_TRANSPARENT",0},
+	{"SC_AUTOCMATCH_PREFIX",0},
+	{"SC_AUTOCMATCH_SUBSEQUENCE",1},
 	{"SC_AUTOMATICFOLD_CHANGE",0x0004},
 	{"SC_AUTOMATICFOLD_CLICK",0x0002},
 	{"SC_AUTOMATICFOLD_SHOW",0x0001},
@@ -2720,6 +2736,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SC_CURSORWAIT",4},
 	{"SC_DOCUMENTOPTION_DEFAULT",0},
 	{"SC_DOCUMENTOPTION_STYLES_NONE",0x1},
+	{"SC_DOCUMENTOPTION_TEXT_CHUNKED",0x200},
 	{"SC_DOCUMENTOPTION_TEXT_LARGE",0x100},
 	{"SC_EFF_QUALITY_ANTIALIASED",2},
 	{"SC_EFF_QUALITY_DEFAULT",0},
@@ -2851,6 +2868,9 @@ static IFaceConstant ifaceConstants[] = {
 	{"SC_POPUP_ALL",1},
 	{"SC_POPUP_NEVER",0},
 	{"SC_POPUP_TEXT",2},
+	{"SC_POSITIONCACHE_EVICTIONS",2},
+	{"SC_POSITIONCACHE_HITS",0},
+	{"SC_POSITIONCACHE_MISSES",1},
 	{"SC_PRINT_BLACKONWHITE",2},
 	{"SC_PRINT_COLOURONWHITE",3},
 	{"SC_PRINT_COLOURONWHITEDEFAULTBG",4},
@@ -3036,6 +3056,8 @@ static IFaceFunction ifaceFunctions[] = {
 	{"GrabFocus", 2400, iface_void, {iface_void, iface_void}},
 	{"HideLines", 2227, iface_void, {iface_int, iface_int}},
 	{"HideSelection", 2163, iface_void, {iface_bool, iface_void}},
+	{"HighlightMatches", 2732, iface_void, {iface_int, iface_string}},
+	{"HighlightMatchesClear", 2733, iface_void, {iface_int, iface_void}},
 	{"Home", 2312, iface_void, {iface_void, iface_void}},
 	{"HomeDisplay", 2345, iface_void, {iface_void, iface_void}},
 	{"HomeDisplayExtend", 2346, iface_void, {iface_void, iface_void}},
@@ -3135,6 +3157,7 @@ static IFaceFunction ifaceFunctions[] = {
 	{"ReleaseAllExtendedStyles", 2552, iface_void, {iface_void, iface_void}},
 	{"ReleaseDocument", 2377, iface_void, {iface_void, iface_int}},
 	{"ReleaseLineCharacterIndex", 2712, iface_void, {iface_int, iface_void}},
+	{"ReplaceAllInTarget", 2731, iface_position, {iface_string, iface_string}},
 	{"ReplaceSel", 2170, iface_void, {iface_void, iface_string}},
 	{"ReplaceTarget", 2194, iface_int, {iface_length, iface_string}},
 	{"ReplaceTargetRE", 2195, iface_int, {iface_length, iface_string}},
@@ -3250,6 +3273,7 @@ static IFaceProperty ifaceProperties[] = {
 	{"AutoCDropRestOfWord", 2271, 2270, iface_bool, iface_void},
 	{"AutoCFillUps", 0, 2112, iface_string, iface_void},
 	{"AutoCIgnoreCase", 2116, 2115, iface_bool, iface_void},
+	{"AutoCMatch", 2740, 2739, iface_int, iface_void},
 	{"AutoCMaxHeight", 2211, 2210, iface_int, iface_void},
 	{"AutoCMaxWidth", 2209, 2208, iface_int, iface_void},
 	{"AutoCMulti", 2637, 2636, iface_int, iface_void},
@@ -3309,12 +3333,15 @@ static IFaceProperty ifaceProperties[] = {
 	{"GapPosition", 2644, 0, iface_position, iface_void},
 	{"HScrollBar", 2131, 2130, iface_bool, iface_void},
 	{"HighlightGuide", 2135, 2134, iface_int, iface_void},
+	{"HighlightMatchesComplete", 2736, 0, iface_bool, iface_void},
+	{"HighlightMatchesStyle", 2735, 2734, iface_int, iface_void},
 	{"HotspotActiveUnderline", 2496, 2412, iface_bool, iface_void},
 	{"HotspotSingleLine", 2497, 2421, iface_bool, iface_void},
 	{"IMEInteraction", 2678, 2679, iface_int, iface_void},
 	{"Identifier", 2623, 2622, iface_int, iface_void},
 	{"Identifiers", 0, 4024, iface_string, iface_int},
 	{"IdleStyling", 2693, 2692, iface_int, iface_void},
+	{"IdleStylingThreaded", 2725, 2724, iface_bool, iface_void},
 	{"Indent", 2123, 2122, iface_int, iface_void},
 	{"IndentationGuides", 2133, 2132, iface_int, iface_void},
 	{"IndicAlpha", 2524, 2523, iface_int, iface_int},
@@ -3329,6 +3356,7 @@ static IFaceProperty ifaceProperties[] = {
 	{"IndicatorValue", 2503, 2502, iface_int, iface_void},
 	{"KeyWords", 0, 4005, iface_string, iface_int},
 	{"LayoutCache", 2273, 2272, iface_int, iface_void},
+	{"LayoutThreads", 2727, 2726, iface_int, iface_void},
 	{"Length", 2006, 0, iface_int, iface_void},
 	{"Lexer", 4002, 4001, iface_int, iface_void},
 	{"LexerLanguage", 4012, 4006, iface_stringresult, iface_void},
@@ -3377,6 +3405,7 @@ static IFaceProperty ifaceProperties[] = {
 	{"PasteConvertEndings", 2468, 2467, iface_bool, iface_void},
 	{"PhasesDraw", 2673, 2674, iface_int, iface_void},
 	{"PositionCache", 2515, 2514, iface_int, iface_void},
+	{"PositionCacheStatistic", 2728, 0, iface_int, iface_int},
 	{"PrimaryStyleFromStyle", 4028, 0, iface_int, iface_int},
 	{"PrintColourMode", 2149, 2148, iface_int, iface_void},
 	{"PrintMagnification", 2147, 2146, iface_int, iface_void},
@@ -3429,6 +3458,7 @@ static IFaceProperty ifaceProperties[] = {
 	{"StyleUnderline", 2488, 2059, iface_bool, iface_int},
 	{"StyleVisible", 2491, 2074, iface_bool, iface_int},
 	{"StyleWeight", 2064, 2063, iface_int, iface_int},
+	{"StylingThreads", 2738, 2737, iface_int, iface_void},
 	{"SubStyleBases", 4026, 0, iface_stringresult, iface_void},
 	{"SubStylesLength", 4022, 0, iface_int, iface_int},
 	{"SubStylesStart", 4021, 0, iface_int, iface_int},
@@ -3442,6 +3472,7 @@ static IFaceProperty ifaceProperties[] = {
 	{"Technology", 2631, 2630, iface_int, iface_void},
 	{"TextLength", 2183, 0, iface_int, iface_void},
 	{"UndoCollection", 2019, 2012, iface_bool, iface_void},
+	{"UndoMemoryLimit", 2730, 2729, iface_position, iface_void},
 	{"UseTabs", 2125, 2124, iface_bool, iface_void},
 	{"VScrollBar", 2281, 2280, iface_bool, iface_void},
 	{"ViewEOL", 2355, 2356, iface_bool, iface_void},
@@ -3460,9 +3491,9 @@ static IFaceProperty ifaceProperties[] = {
 };
 
 enum {
-	ifaceFunctionCount = 309,
-	ifaceConstantCount = 2787,
-	ifacePropertyCount = 232
+	ifaceFunctionCount = 312,
+	ifaceConstantCount = 2807,
+	ifacePropertyCount = 240
 };
 
 //--Autogenerated
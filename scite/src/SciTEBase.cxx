@@ -220,6 +220,7 @@ void SciTEBase::WorkerCommand(int cmd, Worker *pWorker) {
 		UpdateProgress(pWorker);
 		break;
 	case WORK_FILEPROGRESS:
+		AppendStreamed();
  		UpdateProgress(pWorker);
 		break;
 	}
@@ -735,9 +736,7 @@ void SciTEBase::HighlightCurrentWord(bool highlight) {
 	}
 	GUI::ScintillaWindow &wCurrent = wOutput.HasFocus() ? wOutput : wEditor;
 	// Remove old indicators if any exist.
-	wCurrent.Call(SCI_SETINDICATORCURRENT, indicatorHighlightCurrentWord);
-	const int lenDoc = wCurrent.Call(SCI_GETLENGTH);
-	wCurrent.Call(SCI_INDICATORCLEARRANGE, 0, lenDoc);
+	wCurrent.Call(SCI_HIGHLIGHTMATCHESCLEAR, indicatorHighlightCurrentWord);
 	if (!highlight)
 		return;
 	// Get start & end selection.
@@ -763,10 +762,10 @@ void SciTEBase::HighlightCurrentWord(bool highlight) {
 	// Manage word with DBCS.
 	const std::string wordToFind = EncodeString(sWordToFind);
 
-	matchMarker.StartMatch(&wCurrent, wordToFind,
-		SCFIND_MATCHCASE | SCFIND_WHOLEWORD, selectedStyle,
-		indicatorHighlightCurrentWord, -1);
-	SetIdler(true);
+	// Scintilla marks the matches in idle time and keeps them up to date as the text changes.
+	wCurrent.Call(SCI_SETSEARCHFLAGS, SCFIND_MATCHCASE | SCFIND_WHOLEWORD);
+	wCurrent.Call(SCI_SETHIGHLIGHTMATCHESSTYLE, selectedStyle);
+	wCurrent.CallString(SCI_HIGHLIGHTMATCHES, indicatorHighlightCurrentWord, wordToFind.c_str());
 }
 
 std::string SciTEBase::GetRangeString(GUI::ScintillaWindow &win, int selStart, int selEnd) {
@@ -1188,6 +1187,27 @@ int SciTEBase::DoReplaceAll(bool inSelection) {
 
 	const std::string replaceTarget = UnSlashAsNeeded(EncodeString(replaceWhat), unSlash, regExp);
 	wEditor.Call(SCI_SETSEARCHFLAGS, SearchFlags(regExp));
+
+	// Replace all matches in one operation unless matches have to be checked individually
+	// or the strings contain NULs which can not be passed to SCI_REPLACEALLINTARGET.
+	const bool checkEachMatch = findInStyle || (inSelection && countSelections > 1);
+	if (!checkEachMatch &&
+		(findTarget.find('\0') == std::string::npos) && (replaceTarget.find('\0') == std::string::npos)) {
+		const int lengthBefore = LengthDocument();
+		wEditor.Call(SCI_SETTARGETRANGE, startPosition, endPosition);
+		const int replacements = wEditor.CallString(SCI_REPLACEALLINTARGET,
+			UptrFromString(findTarget.c_str()), replaceTarget.c_str());
+		if (replacements > 0) {
+			if (inSelection) {
+				SetSelection(startPosition, endPosition + LengthDocument() - lengthBefore);
+			} else {
+				const int lastMatch = wEditor.Call(SCI_GETTARGETEND);
+				SetSelection(lastMatch, lastMatch);
+			}
+		}
+		return Maximum(replacements, 0);
+	}
+
 	int posFind = FindInTarget(findTarget, startPosition, endPosition);
 	if ((posFind != -1) && (posFind <= endPosition)) {
 		int lastMatch = posFind;
@@ -4248,10 +4268,6 @@ void SciTEBase::OnIdle() {
 		findMarker.Continue();
 		return;
 	}
-	if (!matchMarker.Complete()) {
-		matchMarker.Continue();
-		return;
-	}
 	SetIdler(false);
 }
 
@@ -141,6 +141,7 @@ public:
 
 	void DocumentModified();
 	bool NeedsSave(int delayBeforeSave) const;
+	bool Streaming() const;
 
 	void CompleteLoading();
 	void CompleteStoring();
@@ -641,7 +642,8 @@ protected:
 	void TextWritten(FileWorker *pFileWorker);
 	void UpdateProgress(Worker *pWorker);
 	void PerformDeferredTasks();
-	enum OpenCompletion { ocSynchronous, ocCompleteCurrent, ocCompleteSwitch };
+	void AppendStreamed();
+	enum OpenCompletion { ocSynchronous, ocCompleteCurrent, ocCompleteSwitch, ocCompleteStreamed };
 	void CompleteOpen(OpenCompletion oc);
 	virtual bool PreOpenCheck(const GUI::gui_char *file);
 	bool Open(const FilePath &file, OpenFlags of = ofNone);
@@ -974,7 +976,6 @@ protected:
 
 	CurrentWordHighlight currentWordHighlight;
 	void HighlightCurrentWord(bool highlight);
-	MatchMarker matchMarker;
 	MatchMarker findMarker;
 public:
 
@@ -53,6 +53,10 @@ bool Buffer::NeedsSave(int delayBeforeSave) const {
 	return now && documentModTime && isDirty && !pFileWorker && (now-documentModTime > delayBeforeSave) && !file.IsUntitled() && !failedSave;
 }
 
+bool Buffer::Streaming() const {
+	return pFileWorker && pFileWorker->IsLoading() && static_cast<const FileLoader *>(pFileWorker)->streaming;
+}
+
 void Buffer::CompleteLoading() {
 	lifeState = open;
 	if (pFileWorker && pFileWorker->IsLoading()) {
@@ -18,8 +18,15 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <deque>
 #include <algorithm>
 #include <memory>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 #include <fcntl.h>
 
@@ -275,7 +282,9 @@ void SciTEBase::OpenCurrentFile(long long fileSize, bool suppressMessage, bool a
 		wEditor.Call(SCI_STYLESETBACK, STYLE_DEFAULT, 0xEEEEEE);
 		wEditor.Call(SCI_SETREADONLY, 1);
 		assert(CurrentBufferConst()->pFileWorker == nullptr);
-		ILoader *pdocLoad;
+		const long long sizeStreaming = props.GetLongLong("file.size.streaming");
+		const bool streaming = sizeStreaming && (fileSize > sizeStreaming);
+		ILoader *pdocLoad = nullptr;
 		try {
 			sptr_t docOptions = SC_DOCUMENTOPTION_DEFAULT;
 
@@ -283,13 +292,27 @@ void SciTEBase::OpenCurrentFile(long long fileSize, bool suppressMessage, bool a
 			if (sizeLarge && (fileSize > sizeLarge))
 				docOptions |= SC_DOCUMENTOPTION_TEXT_LARGE;
 
+			const long long sizeChunked = props.GetLongLong("file.size.chunked");
+			if (sizeChunked && (fileSize > sizeChunked))
+				docOptions |= SC_DOCUMENTOPTION_TEXT_CHUNKED;
+
 			const long long sizeNoStyles = props.GetLongLong("file.size.no.styles");
 			if (sizeNoStyles && (fileSize > sizeNoStyles))
 				docOptions |= SC_DOCUMENTOPTION_STYLES_NONE;
 
-			pdocLoad = reinterpret_cast<ILoader *>(
-				wEditor.CallReturnPointer(SCI_CREATELOADER, static_cast<uptr_t>(fileSize) + 1000,
-					docOptions));
+			if (streaming) {
+				// Display the document straight away and append text to it as it is read
+				const sptr_t pdocStreaming = wEditor.CallReturnPointer(SCI_CREATEDOCUMENT,
+					static_cast<uptr_t>(fileSize) + 1000, docOptions);
+				SwitchDocumentAt(buffers.Current(), pdocStreaming);
+				ReadProperties();
+				wEditor.Call(SCI_SETUNDOCOLLECTION, 0);
+				wEditor.Call(SCI_SETREADONLY, 1);
+			} else {
+				pdocLoad = reinterpret_cast<ILoader *>(
+					wEditor.CallReturnPointer(SCI_CREATELOADER, static_cast<uptr_t>(fileSize) + 1000,
+						docOptions));
+			}
 		} catch (...) {
 			wEditor.Call(SCI_SETSTATUS, 0);
 			return;
@@ -345,17 +368,24 @@ void SciTEBase::TextRead(FileWorker *pFileWorker) {
 			// Should refuse to save when failure occurs
 			buffers.buffers[iBuffer].lifeState = Buffer::empty;
 		}
-		// Switch documents
-		const sptr_t pdocLoading = reinterpret_cast<sptr_t>(pFileLoader->pLoader->ConvertToDocument());
-		pFileLoader->pLoader = nullptr;
-		SwitchDocumentAt(iBuffer, pdocLoading);
+		// A streamed document is already in place and CompleteOpen appends the remaining text
+		const bool streaming = pFileLoader->streaming;
+		if (!streaming) {
+			// Switch documents
+			const sptr_t pdocLoading = reinterpret_cast<sptr_t>(pFileLoader->pLoader->ConvertToDocument());
+			pFileLoader->pLoader = nullptr;
+			SwitchDocumentAt(iBuffer, pdocLoading);
+		}
 		if (iBuffer == buffers.Current()) {
-			CompleteOpen(ocCompleteCurrent);
+			CompleteOpen(streaming ? ocCompleteStreamed : ocCompleteCurrent);
 			if (extender)
 				extender->OnOpen(buffers.buffers[iBuffer].file.AsUTF8().c_str());
-			RestoreState(buffers.buffers[iBuffer], true);
-			DisplayAround(buffers.buffers[iBuffer].file);
-			wEditor.Call(SCI_SCROLLCARET);
+			if (!streaming) {
+				// The user may already have moved around a streamed document so leave it be
+				RestoreState(buffers.buffers[iBuffer], true);
+				DisplayAround(buffers.buffers[iBuffer].file);
+				wEditor.Call(SCI_SCROLLCARET);
+			}
 		}
 	}
 }
@@ -368,7 +398,25 @@ void SciTEBase::PerformDeferredTasks() {
 	}
 }
 
+void SciTEBase::AppendStreamed() {
+	if (CurrentBufferConst()->Streaming()) {
+		FileLoader *pFileLoader = static_cast<FileLoader *>(CurrentBuffer()->pFileWorker);
+		const std::string text = pFileLoader->TakeStreamed();
+		if (text.length()) {
+			// Undo collection is off so appending does not leave the save point
+			const sptr_t readOnly = wEditor.Call(SCI_GETREADONLY);
+			wEditor.Call(SCI_SETREADONLY, 0);
+			wEditor.CallString(SCI_APPENDTEXT, text.length(), text.c_str());
+			wEditor.Call(SCI_SETREADONLY, readOnly);
+			if (lineNumbers && lineNumbersExpand)
+				SetLineNumberWidth();
+		}
+	}
+}
+
 void SciTEBase::CompleteOpen(OpenCompletion oc) {
+	AppendStreamed();
+
 	wEditor.Call(SCI_SETREADONLY, CurrentBuffer()->isReadOnly);
 
 	if (oc != ocSynchronous) {
@@ -413,7 +461,9 @@ void SciTEBase::CompleteOpen(OpenCompletion oc) {
 	if (props.GetInt("fold.on.open") > 0) {
 		FoldAll();
 	}
-	wEditor.Call(SCI_GOTOPOS, 0);
+	if (oc != ocCompleteStreamed) {
+		wEditor.Call(SCI_GOTOPOS, 0);
+	}
 
 	CurrentBuffer()->CompleteLoading();
 
@@ -613,7 +663,8 @@ bool SciTEBase::Open(const FilePath &file, OpenFlags of) {
 			wEditor.Call(SCI_EMPTYUNDOBUFFER);
 		}
 		CurrentBuffer()->isReadOnly = props.GetInt("read.only");
-		wEditor.Call(SCI_SETREADONLY, CurrentBuffer()->isReadOnly);
+		// Streamed documents stay read-only until completely read
+		wEditor.Call(SCI_SETREADONLY, CurrentBuffer()->isReadOnly || CurrentBufferConst()->Streaming());
 	}
 	RemoveFileFromStack(filePath);
 	DeleteFileStackMenu();
@@ -1085,9 +1136,11 @@ bool SciTEBase::SaveBuffer(const FilePath &saveName, SaveFlags sf) {
 		FILE *fp = saveName.Open(fileWrite);
 		if (fp) {
 			const size_t lengthDoc = LengthDocument();
-			if (!(sf & sfSynchronous)) {
+			// Chunked documents may not be contiguous so are written synchronously.
+			const char *documentBytes = (sf & sfSynchronous) ? nullptr :
+				reinterpret_cast<const char *>(wEditor.CallReturnPointer(SCI_GETCHARACTERPOINTER));
+			if (documentBytes) {
 				wEditor.Call(SCI_SETREADONLY, 1);
-				const char *documentBytes = reinterpret_cast<const char *>(wEditor.CallReturnPointer(SCI_GETCHARACTERPOINTER));
 				CurrentBuffer()->pFileWorker = new FileStorer(this, documentBytes, saveName, lengthDoc, fp, CurrentBuffer()->unicodeMode, (sf & sfProgressVisible));
 				CurrentBuffer()->pFileWorker->sleepTime = props.GetInt("asynchronous.sleep");
 				if (PerformOnNewThread(CurrentBuffer()->pFileWorker)) {
@@ -1345,115 +1398,451 @@ void SciTEBase::OpenFilesFromStdin() {
 		Open(FilePath());
 }
 
-class BufferedFile {
+static constexpr bool IsLineEndChar(char ch) noexcept {
+	return (ch == '\r') || (ch == '\n');
+}
+
+// Count the line ends in a range where a "\r\n" pair counts once.
+// A '\r' at the end of the range is counted as the range always ends at a line end.
+static size_t CountLineEnds(const char *start, const char *end) noexcept {
+	size_t count = 0;
+	for (const char *p = start; (p = static_cast<const char *>(memchr(p, '\n', end - p))) != nullptr; p++) {
+		count++;
+	}
+	for (const char *p = start; (p = static_cast<const char *>(memchr(p, '\r', end - p))) != nullptr; p++) {
+		if ((p + 1 == end) || (p[1] != '\n')) {
+			count++;
+		}
+	}
+	return count;
+}
+
+/**
+ * Reads a file in large blocks. Each block returned ends at a line end, or at the end
+ * of the file, with any incomplete final line carried over to the start of the next block.
+ */
+class BlockReader {
 	FILE *fp;
-	bool readAll;
-	bool exhausted;
-	enum {bufLen = 64 * 1024};
-	char buffer[bufLen];
-	size_t pos;
+	bool atEnd;
+	enum {blockSize = 1024 * 1024};
+	std::vector<char> buffer;
 	size_t valid;
-	void EnsureData() {
-		if (pos >= valid) {
-			if (readAll || !fp) {
-				exhausted = true;
-			} else {
-				valid = fread(buffer, 1, bufLen, fp);
-				if (valid < bufLen) {
-					readAll = true;
-				}
-				pos = 0;
+	size_t returned;
+	void Fill() {
+		if (!atEnd && (valid < buffer.size())) {
+			const size_t lenRead = fread(buffer.data() + valid, 1, buffer.size() - valid, fp);
+			valid += lenRead;
+			if (valid < buffer.size()) {
+				atEnd = true;
 			}
 		}
 	}
 public:
-	explicit BufferedFile(const FilePath &fPath) {
-		fp = fPath.Open(fileRead);
-		readAll = false;
-		exhausted = fp == nullptr;
-		buffer[0] = 0;
-		pos = 0;
-		valid = 0;
-	}
-	~BufferedFile() {
+	explicit BlockReader(const FilePath &fPath) : fp(fPath.Open(fileRead)), atEnd(fp == nullptr),
+		buffer(blockSize), valid(0), returned(0) {
+	}
+	// Deleted so BlockReader objects can not be copied.
+	BlockReader(const BlockReader &) = delete;
+	BlockReader &operator=(const BlockReader &) = delete;
+	~BlockReader() {
 		if (fp) {
 			fclose(fp);
 		}
 		fp = nullptr;
 	}
-	bool Exhausted() const noexcept {
-		return exhausted;
-	}
-	int NextByte() {
-		EnsureData();
-		if (pos >= valid) {
-			return 0;
-		}
-		return buffer[pos++];
-	}
+	// Only checks the first block like other editors to avoid reading all of a large file.
 	bool BufferContainsNull() {
-		EnsureData();
-		for (size_t i = 0;i < valid;i++) {
-			if (buffer[i] == '\0')
+		Fill();
+		return memchr(buffer.data(), '\0', valid) != nullptr;
+	}
+	bool Next(const char *&start, const char *&end) {
+		if (returned) {
+			std::copy(buffer.begin() + returned, buffer.begin() + valid, buffer.begin());
+			valid -= returned;
+			returned = 0;
+		}
+		for (;;) {
+			Fill();
+			if (atEnd) {
+				returned = valid;
+			} else {
+				// A final '\r' may be the start of a "\r\n" so leave it for the next block.
+				size_t lineEnd = valid - 1;
+				while ((lineEnd > 0) && !IsLineEndChar(buffer[lineEnd - 1])) {
+					lineEnd--;
+				}
+				if ((lineEnd > 0) && (buffer[lineEnd - 1] == '\r') && (buffer[lineEnd] == '\n')) {
+					lineEnd++;
+				}
+				returned = lineEnd;
+			}
+			if (returned) {
+				start = buffer.data();
+				end = start + returned;
 				return true;
+			}
+			if (atEnd) {
+				return false;
+			}
+			// No line end in whole buffer so make room for a longer line.
+			buffer.resize(buffer.size() * 2);
 		}
-		return false;
 	}
 };
 
-class FileReader {
-	std::unique_ptr<BufferedFile> bf;
-	int lineNum;
-	bool lastWasCR;
-	std::string lineToCompare;
-	std::string lineToShow;
-	bool caseSensitive;
+/**
+ * Horspool substring search over a whole buffer. When not matching case, the skip table and
+ * comparisons fold ASCII letters so the text does not need to be copied and lowercased.
+ */
+class GrepSearcher {
+	std::string needle;
+	bool matchCase;
+	size_t skip[256];
+	char Fold(char ch) const noexcept {
+		if (!matchCase && (ch >= 'A') && (ch <= 'Z'))
+			return static_cast<char>(ch - 'A' + 'a');
+		return ch;
+	}
 public:
-	FileReader(const FilePath &fPath, bool caseSensitive_) : bf(std::make_unique<BufferedFile>(fPath)) {
-		lineNum = 0;
-		lastWasCR = false;
-		caseSensitive = caseSensitive_;
-	}
-	// Deleted so FileReader objects can not be copied.
-	FileReader(const FileReader &) = delete;
-	~FileReader() {
-	}
-	const char *Next() {
-		if (bf->Exhausted()) {
-			return nullptr;
-		}
-		lineToShow.clear();
-		while (!bf->Exhausted()) {
-			const int ch = bf->NextByte();
-			if (lastWasCR && ch == '\n' && lineToShow.empty()) {
-				lastWasCR = false;
-			} else if (ch == '\r' || ch == '\n') {
-				lastWasCR = ch == '\r';
+	GrepSearcher(const char *searchString, bool matchCase_) : needle(searchString), matchCase(matchCase_) {
+		if (!matchCase) {
+			LowerCaseAZ(needle);
+		}
+		std::fill(std::begin(skip), std::end(skip), needle.length());
+		for (size_t i = 0; i + 1 < needle.length(); i++) {
+			skip[static_cast<unsigned char>(needle[i])] = needle.length() - 1 - i;
+		}
+		if (!matchCase) {
+			for (int ch = 'A'; ch <= 'Z'; ch++) {
+				skip[ch] = skip[ch - 'A' + 'a'];
+			}
+		}
+	}
+	size_t Length() const noexcept {
+		return needle.length();
+	}
+	bool SpansLines() const noexcept {
+		return std::find_if(needle.begin(), needle.end(), IsLineEndChar) != needle.end();
+	}
+	// Returns the first match in [start, end) or end if there is no match.
+	const char *Find(const char *start, const char *end) const noexcept {
+		const size_t length = needle.length();
+		if (length == 0)
+			return start;
+		const char last = needle[length - 1];
+		const char *pos = start;
+		while (static_cast<size_t>(end - pos) >= length) {
+			const char chLast = pos[length - 1];
+			if (Fold(chLast) == last) {
+				size_t i = 0;
+				while ((i < length - 1) && (Fold(pos[i]) == needle[i])) {
+					i++;
+				}
+				if (i == length - 1) {
+					return pos;
+				}
+			}
+			pos += skip[static_cast<unsigned char>(chLast)];
+		}
+		return end;
+	}
+};
+
+static bool IsWordCharacter(int ch) noexcept {
+	return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z')  || (ch >= '0' && ch <= '9')  || (ch == '_');
+}
+
+namespace {
+
+// Copy of the SciTEBase::GrepFlags that affect searching so worker code does not need access to SciTEBase.
+struct GrepOptions {
+	bool wholeWord = false;
+	bool matchCase = false;
+	bool binary = false;
+	bool dot = false;
+};
+
+// Search one file, appending "path:line:text" records for each matching line to os.
+// Returns false if the search was abandoned because cancelled was set.
+bool GrepFile(const FilePath &fPath, const GrepOptions &options, const GrepSearcher &searcher,
+	std::string &os, const std::atomic<bool> &cancelled) {
+	BlockReader reader(fPath);
+	if (searcher.SpansLines() || (!options.binary && reader.BufferContainsNull())) {
+		return true;
+	}
+	const size_t searchLength = searcher.Length();
+	size_t lineNumber = 1;
+	const char *start = nullptr;
+	const char *end = nullptr;
+	while (reader.Next(start, end)) {
+		if (cancelled.load(std::memory_order_relaxed))
+			return false;
+		// Line numbers and line text are only worked out around matches.
+		const char *counted = start;
+		const char *pos = start;
+		while (pos < end) {
+			const char *match = searcher.Find(pos, end);
+			if (match == end)
 				break;
+			if (options.wholeWord) {
+				if (((match != start) && IsWordCharacter(match[-1])) ||
+				        ((match + searchLength != end) && IsWordCharacter(match[searchLength]))) {
+					pos = match + 1;
+					continue;
+				}
+			}
+			const char *lineStart = match;
+			while ((lineStart > start) && !IsLineEndChar(lineStart[-1])) {
+				lineStart--;
+			}
+			const char *lineEnd = std::find_if(match, end, IsLineEndChar);
+			lineNumber += CountLineEnds(counted, lineStart);
+			counted = lineStart;
+			// Text is truncated at any NUL as the output pane receives C strings.
+			const char *lineShown = std::find(lineStart, lineEnd, '\0');
+			os.append(fPath.AsUTF8().c_str());
+			os.append(":");
+			os.append(StdStringFromSizeT(lineNumber));
+			os.append(":");
+			os.append(lineStart, lineShown);
+			os.append("\n");
+			pos = lineEnd;
+			if (pos < end) {
+				pos += ((pos[0] == '\r') && (pos + 1 < end) && (pos[1] == '\n')) ? 2 : 1;
+			}
+		}
+		lineNumber += CountLineEnds(counted, end);
+	}
+	return true;
+}
+
+// A directory in the tree being searched. Filled in by whichever worker lists it;
+// results are held per file so they can be reported in path order.
+struct GrepDirectory {
+	FilePath path;
+	bool listed = false;
+	FilePathSet files;
+	std::vector<std::string> results;
+	std::vector<bool> searched;
+	std::vector<std::unique_ptr<GrepDirectory>> subDirectories;
+	explicit GrepDirectory(const FilePath &path_) : path(path_) {
+	}
+};
+
+/**
+ * Work-stealing pool of threads that list directories and search files.
+ * Each worker pops tasks from the back of its own deque and, when that is empty,
+ * steals from the front of another worker's deque. Listing a directory queues
+ * tasks for its files and subdirectories so enumeration and searching overlap.
+ */
+class GrepPool {
+	struct Task {
+		GrepDirectory *directory = nullptr;
+		size_t file = 0;	// Index into directory->files or taskList to enumerate directory
+	};
+	static constexpr size_t taskList = SIZE_MAX;
+	struct TaskDeque {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	const GrepOptions options;
+	const GrepSearcher searcher;
+	const GUI::gui_string fileTypes;
+	const std::function<bool(const FilePath &)> intoDirectory;
+
+	std::vector<std::unique_ptr<TaskDeque>> deques;
+	std::vector<std::thread> threads;
+	// Protects the tree contents and the counters used to sleep and wake.
+	std::mutex mutexState;
+	std::condition_variable cvWork;
+	std::condition_variable cvProgress;
+	size_t queued = 0;
+	size_t pending = 0;
+	std::atomic<bool> cancelled;
+
+	void Push(size_t worker, Task task) {
+		{
+			std::lock_guard<std::mutex> guard(deques[worker]->mutex);
+			deques[worker]->tasks.push_back(task);
+		}
+		{
+			std::lock_guard<std::mutex> guard(mutexState);
+			queued++;
+			pending++;
+		}
+		cvWork.notify_one();
+	}
+
+	bool Pop(size_t worker, Task &task) {
+		TaskDeque &own = *deques[worker];
+		std::lock_guard<std::mutex> guard(own.mutex);
+		if (own.tasks.empty())
+			return false;
+		task = own.tasks.back();
+		own.tasks.pop_back();
+		return true;
+	}
+
+	bool Steal(size_t worker, Task &task) {
+		for (size_t offset = 1; offset < deques.size(); offset++) {
+			TaskDeque &victim = *deques[(worker + offset) % deques.size()];
+			std::lock_guard<std::mutex> guard(victim.mutex);
+			if (!victim.tasks.empty()) {
+				task = victim.tasks.front();
+				victim.tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void ListDirectory(size_t worker, GrepDirectory *directory) {
+		FilePathSet directories;
+		FilePathSet files;
+		directory->path.List(directories, files);
+		FilePathSet filesMatching;
+		for (const FilePath &fPath : files) {
+			if (fileTypes.empty() || fPath.Matches(fileTypes.c_str())) {
+				filesMatching.push_back(fPath);
+			}
+		}
+		std::vector<std::unique_ptr<GrepDirectory>> subDirectories;
+		for (const FilePath &fPath : directories) {
+			if (options.dot || intoDirectory(fPath.Name())) {
+				subDirectories.push_back(std::make_unique<GrepDirectory>(fPath));
+			}
+		}
+		const size_t fileCount = filesMatching.size();
+		std::vector<GrepDirectory *> children;
+		for (const std::unique_ptr<GrepDirectory> &sub : subDirectories) {
+			children.push_back(sub.get());
+		}
+		{
+			std::lock_guard<std::mutex> guard(mutexState);
+			directory->files = std::move(filesMatching);
+			directory->results.resize(fileCount);
+			directory->searched.resize(fileCount);
+			directory->subDirectories = std::move(subDirectories);
+			directory->listed = true;
+		}
+		cvProgress.notify_all();
+		// Pushed in reverse so this worker pops them in path order while other
+		// workers steal the subdirectories and enumerate ahead.
+		for (auto it = children.rbegin(); it != children.rend(); ++it) {
+			Push(worker, Task{*it, taskList});
+		}
+		for (size_t file = fileCount; file > 0; file--) {
+			Push(worker, Task{directory, file - 1});
+		}
+	}
+
+	void SearchFile(GrepDirectory *directory, size_t file) {
+		std::string os;
+		GrepFile(directory->files[file], options, searcher, os, cancelled);
+		{
+			std::lock_guard<std::mutex> guard(mutexState);
+			directory->results[file] = std::move(os);
+			directory->searched[file] = true;
+		}
+		cvProgress.notify_all();
+	}
+
+	void Run(size_t worker) {
+		for (;;) {
+			Task task;
+			if (Pop(worker, task) || Steal(worker, task)) {
+				{
+					std::lock_guard<std::mutex> guard(mutexState);
+					queued--;
+				}
+				if (!cancelled.load(std::memory_order_relaxed)) {
+					if (task.file == taskList) {
+						ListDirectory(worker, task.directory);
+					} else {
+						SearchFile(task.directory, task.file);
+					}
+				}
+				bool finished = false;
+				{
+					std::lock_guard<std::mutex> guard(mutexState);
+					pending--;
+					finished = pending == 0;
+				}
+				if (finished) {
+					cvWork.notify_all();
+					cvProgress.notify_all();
+				}
 			} else {
-				lineToShow.push_back(static_cast<char>(ch));
+				std::unique_lock<std::mutex> lock(mutexState);
+				cvWork.wait(lock, [this] { return queued > 0 || pending == 0; });
+				if (pending == 0)
+					return;
 			}
 		}
-		lineNum++;
-		lineToCompare = lineToShow;
-		if (!caseSensitive) {
-			LowerCaseAZ(lineToCompare);
+	}
+
+public:
+	GrepPool(const GrepOptions &options_, const char *searchString_, const GUI::gui_char *fileTypes_,
+		std::function<bool(const FilePath &)> intoDirectory_) :
+		options(options_), searcher(searchString_, options_.matchCase), fileTypes(fileTypes_), intoDirectory(std::move(intoDirectory_)),
+		cancelled(false) {
+	}
+	// Deleted so GrepPool objects can not be copied.
+	GrepPool(const GrepPool &) = delete;
+	GrepPool(GrepPool &&) = delete;
+	GrepPool &operator=(const GrepPool &) = delete;
+	GrepPool &operator=(GrepPool &&) = delete;
+	~GrepPool() {
+		Cancel();
+		for (std::thread &thread : threads) {
+			thread.join();
 		}
-		return lineToCompare.c_str();
 	}
-	int LineNumber() const noexcept {
-		return lineNum;
+
+	void Start(GrepDirectory *root) {
+		const size_t workers = std::max(std::thread::hardware_concurrency(), 1U);
+		for (size_t worker = 0; worker < workers; worker++) {
+			deques.push_back(std::make_unique<TaskDeque>());
+		}
+		Push(0, Task{root, taskList});
+		for (size_t worker = 0; worker < workers; worker++) {
+			threads.emplace_back(&GrepPool::Run, this, worker);
+		}
 	}
-	const char *Original() const noexcept {
-		return lineToShow.c_str();
+
+	void Cancel() noexcept {
+		cancelled.store(true);
 	}
-	bool BufferContainsNull() {
-		return bf->BufferContainsNull();
+
+	// Wait until predicate is true. Periodically calls checkCancel without holding the lock and
+	// returns false if that reports cancellation or if the workers finished without satisfying predicate.
+	template <typename Predicate, typename CheckCancel>
+	bool WaitFor(Predicate predicate, CheckCancel checkCancel) {
+		std::unique_lock<std::mutex> lock(mutexState);
+		while (!predicate()) {
+			if (pending == 0)
+				return false;
+			cvProgress.wait_for(lock, std::chrono::milliseconds(100));
+			if (!predicate()) {
+				lock.unlock();
+				if (checkCancel()) {
+					Cancel();
+					return false;
+				}
+				lock.lock();
+			}
+		}
+		return true;
+	}
+
+	// Retrieve the results of a searched file, releasing their memory.
+	std::string TakeResult(GrepDirectory *directory, size_t file) {
+		std::lock_guard<std::mutex> guard(mutexState);
+		return std::move(directory->results[file]);
 	}
 };
 
-static bool IsWordCharacter(int ch) noexcept {
-	return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z')  || (ch >= '0' && ch <= '9')  || (ch == '_');
 }
 
 bool SciTEBase::GrepIntoDirectory(const FilePath &directory) {
@@ -1466,59 +1855,51 @@ bool SciTEBase::GrepIntoDirectory(const FilePath &directory) {
 }
 
 void SciTEBase::GrepRecursive(GrepFlags gf, const FilePath &baseDir, const char *searchString, const GUI::gui_char *fileTypes) {
-	const int checkAfterLines = 10'000;
-	FilePathSet directories;
-	FilePathSet files;
-	baseDir.List(directories, files);
-	const size_t searchLength = strlen(searchString);
-	std::string os;
-	for (const FilePath &fPath : files) {
-		if (jobQueue.Cancelled())
-			return;
-		if (*fileTypes == '\0' || fPath.Matches(fileTypes)) {
-			//OutputAppendStringSynchronised(i->AsInternal());
-			//OutputAppendStringSynchronised("\n");
-			FileReader fr(fPath, gf & grepMatchCase);
-			if ((gf & grepBinary) || !fr.BufferContainsNull()) {
-				while (const char *line = fr.Next()) {
-					if (((fr.LineNumber() % checkAfterLines) == 0) && jobQueue.Cancelled())
-						return;
-					const char *match = strstr(line, searchString);
-					if (match) {
-						if (gf & grepWholeWord) {
-							const char *lineEnd = line + strlen(line);
-							while (match) {
-								if (((match == line) || !IsWordCharacter(match[-1])) &&
-								        ((match + searchLength == (lineEnd)) || !IsWordCharacter(match[searchLength]))) {
-									break;
-								}
-								match = strstr(match + 1, searchString);
-							}
-						}
-						if (match) {
-							os.append(fPath.AsUTF8().c_str());
-							os.append(":");
-							std::string lNumber = StdStringFromInteger(fr.LineNumber());
-							os.append(lNumber.c_str());
-							os.append(":");
-							os.append(fr.Original());
-							os.append("\n");
-						}
-					}
+	GrepOptions options;
+	options.wholeWord = gf & grepWholeWord;
+	options.matchCase = gf & grepMatchCase;
+	options.binary = gf & grepBinary;
+	options.dot = gf & grepDot;
+	GrepDirectory root(baseDir);
+	GrepPool pool(options, searchString, fileTypes, [this](const FilePath &directory) {
+		return GrepIntoDirectory(directory);
+	});
+	pool.Start(&root);
+	auto checkCancel = [this]() {
+		return jobQueue.Cancelled() != 0;
+	};
+	// Results are reported in the same order as a sequential depth-first search
+	// with all of a directory's files before its subdirectories.
+	std::vector<std::pair<GrepDirectory *, size_t>> stack;
+	stack.emplace_back(&root, 0);
+	while (!stack.empty()) {
+		GrepDirectory *directory = stack.back().first;
+		const size_t subDirectory = stack.back().second;
+		if (subDirectory == 0) {
+			if (!pool.WaitFor([directory] { return directory->listed; }, checkCancel))
+				return;
+			std::string os;
+			for (size_t file = 0; file < directory->files.size(); file++) {
+				if (!pool.WaitFor([directory, file] { return directory->searched[file]; }, checkCancel))
+					return;
+				os.append(pool.TakeResult(directory, file));
+			}
+			if (os.length()) {
+				if (gf & grepStdOut) {
+					fwrite(os.c_str(), os.length(), 1, stdout);
+				} else {
+					OutputAppendStringSynchronised(os.c_str());
 				}
 			}
-		}
-	}
-	if (os.length()) {
-		if (gf & grepStdOut) {
-			fwrite(os.c_str(), os.length(), 1, stdout);
 		} else {
-			OutputAppendStringSynchronised(os.c_str());
+			// Previous subdirectory fully reported so release it
+			directory->subDirectories[subDirectory - 1].reset();
 		}
-	}
-	for (const FilePath &fPath : directories) {
-		if ((gf & grepDot) || GrepIntoDirectory(fPath.Name())) {
-			GrepRecursive(gf, fPath, searchString, fileTypes);
+		if (subDirectory < directory->subDirectories.size()) {
+			stack.back().second++;
+			stack.emplace_back(directory->subDirectories[subDirectory].get(), 0);
+		} else {
+			stack.pop_back();
 		}
 	}
 }
@@ -1105,6 +1105,8 @@ void SciTEBase::ReadProperties() {
 
 	wEditor.Call(SCI_SETIDLESTYLING, props.GetInt("idle.styling", SC_IDLESTYLING_NONE));
 	wOutput.Call(SCI_SETIDLESTYLING, props.GetInt("output.idle.styling", SC_IDLESTYLING_NONE));
+	wEditor.Call(SCI_SETIDLESTYLINGTHREADED, props.GetInt("idle.styling.threaded"));
+	wEditor.Call(SCI_SETSTYLINGTHREADS, props.GetInt("styling.threads", 1));
 
 	if (props.GetInt("os.x.home.end.keys")) {
 		AssignKey(SCK_HOME, 0, SCI_SCROLLTOSTART);
@@ -1328,10 +1330,8 @@ void SciTEBase::ReadProperties() {
 	wEditor.Call(SCI_SETCARETSTICKY, props.GetInt("caret.sticky", 0));
 
 	// Clear all previous indicators.
-	wEditor.Call(SCI_SETINDICATORCURRENT, indicatorHighlightCurrentWord);
-	wEditor.Call(SCI_INDICATORCLEARRANGE, 0, wEditor.Call(SCI_GETLENGTH));
-	wOutput.Call(SCI_SETINDICATORCURRENT, indicatorHighlightCurrentWord);
-	wOutput.Call(SCI_INDICATORCLEARRANGE, 0, wOutput.Call(SCI_GETLENGTH));
+	wEditor.Call(SCI_HIGHLIGHTMATCHESCLEAR, indicatorHighlightCurrentWord);
+	wOutput.Call(SCI_HIGHLIGHTMATCHESCLEAR, indicatorHighlightCurrentWord);
 	currentWordHighlight.statesOfDelay = currentWordHighlight.noDelay;
 
 	currentWordHighlight.isEnabled = props.GetInt("highlight.current.word", 0) == 1;